@@ -102,6 +102,7 @@ namespace
 
         // Setup runner
         pipeline_holder.run_loop();
+        pipeline_holder.wait();
 
         return {};
     }
@@ -182,6 +183,7 @@ namespace
 
         // Setup runner
         pipeline_holder.run_loop();
+        pipeline_holder.wait();
 
         return {};
     }
@@ -246,6 +248,7 @@ namespace
 
         // Setup runner
         pipeline_holder.run_loop();
+        pipeline_holder.wait();
 
         return {};
     }
@@ -326,6 +329,7 @@ namespace
 
         // Setup runner
         pipeline_holder.run_loop();
+        pipeline_holder.wait();
 
         return {};
     }
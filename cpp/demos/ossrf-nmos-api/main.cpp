@@ -46,6 +46,8 @@ namespace
 
         BST_ASSIGN(nmos_client, nmos_client_t::create(node_id, node_configuration.dump()));
         BST_CHECK(nmos_client->add_device(device.dump()));
+        // Registers the device's senders and receivers in one go.
+        BST_CHECK(nmos_client->begin_batch());
 
         ossrf::gst::plugins::gst_sender_plugin_uptr gst_sender_uptr       = nullptr;
         ossrf::gst::plugins::gst_sender_plugin_uptr gst_sender_uptr_2     = nullptr;
@@ -127,6 +129,8 @@ namespace
             }
         }
 
+        BST_CHECK(nmos_client->commit_batch());
+
         fmt::print("\n >>> Press a key to stop sender <<< \n");
         char c;
         std::cin >> c;
@@ -0,0 +1,135 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Starts N live pipelines and reports how long they take to reach Playing and how many threads the process runs
+// meanwhile: first with one executor thread per pipeline, as pipelines used to have, then on a shared pool.
+
+#include "bisect/expected/macros.h"
+#include "bisect/expected.h"
+#include "bisect/executor.h"
+#include "bisect/pipeline.h"
+#include "bisect/initializer.h"
+#include <gst/gst.h>
+#include <fmt/core.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct result_t
+    {
+        std::chrono::microseconds startup;
+        size_t threads;
+    };
+
+    size_t process_thread_count()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.starts_with("Threads:")) return std::stoul(line.substr(8));
+        }
+        return 0;
+    }
+
+    bisect::expected<bisect::gst::pipeline> make_pipeline(const std::shared_ptr<bisect::gst::executor>& executor)
+    {
+        BST_ASSIGN_MUT(p, bisect::gst::pipeline::create(nullptr, executor));
+
+        auto* source = gst_element_factory_make("fakesrc", nullptr);
+        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element fakesrc");
+        g_object_set(G_OBJECT(source), "is-live", TRUE, "sizetype", 2, "sizemax", 1200, NULL);
+        BST_ENFORCE(gst_bin_add(GST_BIN(p.get()), source), "Failed adding fakesrc to the pipeline");
+
+        auto* sink = gst_element_factory_make("fakesink", nullptr);
+        BST_ENFORCE(sink != nullptr, "Failed creating GStreamer element fakesink");
+        BST_ENFORCE(gst_bin_add(GST_BIN(p.get()), sink), "Failed adding fakesink to the pipeline");
+
+        BST_ENFORCE(gst_element_link(source, sink), "Failed linking GStreamer pipeline");
+        return p;
+    }
+
+    bisect::expected<result_t> run(size_t pipeline_count, size_t executor_threads)
+    {
+        BST_ASSIGN(executor, bisect::gst::executor::create(executor_threads));
+
+        std::vector<bisect::gst::pipeline> pipelines;
+        pipelines.reserve(pipeline_count);
+
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < pipeline_count; ++i)
+        {
+            BST_ASSIGN_MUT(p, make_pipeline(executor));
+            p.run_loop();
+            pipelines.push_back(std::move(p));
+        }
+
+        for(auto& p : pipelines)
+        {
+            GstState state = GST_STATE_NULL;
+            BST_ENFORCE(gst_element_get_state(p.get(), &state, nullptr, 5 * GST_SECOND) != GST_STATE_CHANGE_FAILURE &&
+                            state == GST_STATE_PLAYING,
+                        "Pipeline did not reach Playing");
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto threads = process_thread_count();
+        for(auto& p : pipelines)
+        {
+            p.stop();
+        }
+
+        return result_t{std::chrono::duration_cast<std::chrono::microseconds>(elapsed), threads};
+    }
+
+    bisect::maybe_ok run_all(size_t pipeline_count, size_t pool_threads)
+    {
+        const auto baseline = process_thread_count();
+
+        BST_ASSIGN(dedicated, run(pipeline_count, pipeline_count));
+        BST_ASSIGN(pooled, run(pipeline_count, pool_threads));
+
+        fmt::print("{} pipelines, {} threads before starting\n", pipeline_count, baseline);
+        fmt::print("{:<24} {:>12} {:>10}\n", "executor", "startup us", "threads");
+        fmt::print("{:<24} {:>12} {:>10}\n", fmt::format("dedicated ({} threads)", pipeline_count),
+                   dedicated.startup.count(), dedicated.threads);
+        fmt::print("{:<24} {:>12} {:>10}\n", fmt::format("pooled ({} threads)", pool_threads), pooled.startup.count(),
+                   pooled.threads);
+        return {};
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bisect::gst::initializer initializer;
+
+    const size_t pipeline_count = argc > 1 ? std::stoul(argv[1]) : 64;
+    const size_t pool_threads   = argc > 2 ? std::stoul(argv[2]) : bisect::gst::executor::default_thread_count;
+    if(pipeline_count == 0 || pool_threads == 0)
+    {
+        fprintf(stderr, "usage: %s [pipelines] [pool threads]\n", argv[0]);
+        return -1;
+    }
+
+    auto result = run_all(pipeline_count, pool_threads);
+    if(!result.has_value())
+    {
+        fprintf(stderr, "error: %s", result.error().what());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reports the average time of a resource_map_t lookup as the map grows. The lookup should not depend on the number of
+// resources, where a scan over every resource would be about 100 times slower at 10000 resources than at 100.
+// Then reports how many activation lookups several threads make per second while resources are added and removed.
+
+#include "context/resource_map.h"
+#include <fmt/core.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ossrf;
+
+namespace
+{
+    class fake_resource_t : public nmos_resource_t
+    {
+      public:
+        fake_resource_t(std::string id, std::string device_id, nmos::type type)
+            : id_(std::move(id)), device_id_(std::move(device_id)), type_(std::move(type))
+        {
+        }
+
+        bisect::maybe_ok handle_patch(bool, const nlohmann::json&) override { return {}; }
+        bisect::maybe_ok handle_activation(bool, nlohmann::json&) override { return {}; }
+        bisect::expected<bisect::nmoscpp::sdp_info_t> handle_sdp_info_request() override
+        {
+            return bisect::nmoscpp::sdp_info_t{};
+        }
+
+        const std::string& get_id() const override { return id_; }
+        const std::string& get_device_id() const override { return device_id_; }
+        nmos::type get_resource_type() const override { return type_; }
+
+      private:
+        std::string id_;
+        std::string device_id_;
+        nmos::type type_;
+    };
+
+    void insert(resource_map_t& map, const std::string& device_id, const std::string& id, const nmos::type& type)
+    {
+        map.insert(device_id, std::make_shared<fake_resource_t>(id, device_id, type));
+    }
+
+    struct lookups_t
+    {
+        double average_ns;
+        size_t found;
+    };
+
+    // Fills a map with `count` senders and receivers spread over 10 devices and times `lookups` find_resource calls,
+    // going over all of them in turn.
+    lookups_t time_lookups(size_t count, size_t lookups)
+    {
+        resource_map_t map;
+        std::vector<std::string> ids;
+        for(size_t i = 0; i < count; ++i)
+        {
+            ids.push_back("resource-" + std::to_string(i));
+            insert(map, "device-" + std::to_string(i % 10), ids.back(),
+                   i % 2 == 0 ? nmos::types::sender : nmos::types::receiver);
+        }
+
+        size_t found     = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < lookups; ++i)
+        {
+            if(map.find_resource(ids[(i * 7919) % count]).has_value()) ++found;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        return {static_cast<double>(ns) / static_cast<double>(lookups), found};
+    }
+
+    struct throughput_t
+    {
+        double lookups_per_second;
+        size_t found;
+    };
+
+    // Activation lookups from `threads` HTTP threads while another thread adds and removes resources.
+    throughput_t time_concurrent_lookups(size_t threads, size_t lookups_by_thread)
+    {
+        constexpr size_t receivers = 1000;
+
+        resource_map_t map;
+        std::vector<std::string> ids;
+        for(size_t i = 0; i < receivers; ++i)
+        {
+            ids.push_back("receiver-" + std::to_string(i));
+            insert(map, "device-a", ids.back(), nmos::types::receiver);
+        }
+
+        std::atomic<bool> done = false;
+        std::thread writer([&]() {
+            for(size_t i = 0; !done; ++i)
+            {
+                const auto id = "sender-" + std::to_string(i % 100);
+                insert(map, "device-b", id, nmos::types::sender);
+                map.erase(id);
+            }
+        });
+
+        std::atomic<size_t> found = 0;
+        const auto start          = std::chrono::steady_clock::now();
+        std::vector<std::thread> readers;
+        for(size_t t = 0; t < threads; ++t)
+        {
+            readers.emplace_back([&, t]() {
+                size_t n = 0;
+                for(size_t i = 0; i < lookups_by_thread; ++i)
+                {
+                    if(map.find_resource(ids[(i * 31 + t) % receivers]).has_value()) ++n;
+                }
+                found += n;
+            });
+        }
+        for(auto& reader : readers)
+        {
+            reader.join();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        done               = true;
+        writer.join();
+
+        const auto seconds = std::chrono::duration<double>(elapsed).count();
+        return {static_cast<double>(threads * lookups_by_thread) / seconds, found};
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t lookups = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    if(lookups == 0 || threads == 0)
+    {
+        fprintf(stderr, "usage: %s [lookups] [threads]\n", argv[0]);
+        return -1;
+    }
+
+    constexpr size_t counts[] = {100, 1000, 10000};
+    fmt::print("{:>10} {:>12} {:>10}\n", "resources", "find ns", "found");
+    for(const auto count : counts)
+    {
+        const auto result = time_lookups(count, lookups);
+        fmt::print("{:>10} {:>12.1f} {:>10}\n", count, result.average_ns, result.found);
+    }
+
+    // Each thread makes 20 times as many lookups, so the run lasts long enough to overlap the writer.
+    const auto concurrent = time_concurrent_lookups(threads, lookups * 20);
+    fmt::print("\n{} threads with a concurrent writer: {:.0f} lookups/s, {} of {} found\n", threads,
+               concurrent.lookups_per_second, concurrent.found, threads * lookups * 20);
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <gst/gst.h>
+#include <memory>
+
+namespace bisect::gst
+{
+    /// A small pool of threads, each running its own GMainContext, over which the bus watches of many pipelines are
+    /// spread. A pipeline stays on the context it acquired until it is stopped.
+    class executor
+    {
+      public:
+        static constexpr size_t default_thread_count = 2;
+
+        static bisect::expected<std::shared_ptr<executor>> create(size_t thread_count) noexcept;
+
+        /// The process wide pool used by pipelines created without an explicit executor. It is started on first
+        /// use, with the size given to configure_shared or default_thread_count.
+        static std::shared_ptr<executor> shared();
+
+        /// Sets the size of the shared pool. Fails once the shared pool has been started.
+        static bisect::maybe_ok configure_shared(size_t thread_count) noexcept;
+
+        ~executor();
+        executor(const executor& other) noexcept          = delete;
+        executor& operator=(const executor& rhs) noexcept = delete;
+        executor(executor&& other) noexcept               = delete;
+        executor& operator=(executor&& rhs) noexcept      = delete;
+
+        /// The context serving the fewest pipelines. Each call must be matched by a call to release.
+        GMainContext* acquire() noexcept;
+        void release(GMainContext* context) noexcept;
+
+        size_t thread_count() const noexcept;
+
+      private:
+        explicit executor(size_t thread_count);
+
+        struct impl;
+        std::unique_ptr<impl> impl_;
+    };
+} // namespace bisect::gst
@@ -13,8 +13,9 @@
 // limitations under the License.
 
 #include "bisect/expected.h"
-#include <thread>
+#include "bisect/executor.h"
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <gst/gst.h>
@@ -24,7 +25,9 @@ namespace bisect::gst
     class pipeline
     {
       public:
+        /// The bus of the pipeline is watched from a thread of the shared executor.
         static bisect::expected<pipeline> create(const char* klass) noexcept;
+        static bisect::expected<pipeline> create(const char* klass, std::shared_ptr<executor> executor) noexcept;
 
         pipeline() noexcept;
         ~pipeline();
@@ -35,16 +38,20 @@ namespace bisect::gst
 
         GstElement* get() noexcept;
 
+        // Starts watching the bus on the executor and sets the pipeline to Playing from there.
         void run_loop();
         bisect::maybe_ok pause();
         bisect::maybe_ok play();
+        // Stops watching the bus and sets the pipeline to Null. Returns once the pipeline has stopped.
         void stop();
+        // Blocks until the pipeline is stopped, either by stop() or by an error.
+        void wait();
 
         // After calling release, the destructor will not unref the pipeline.
         void release() noexcept;
 
       private:
-        explicit pipeline(GstElement* bin) noexcept;
+        pipeline(GstElement* bin, std::shared_ptr<executor> executor) noexcept;
 
         struct impl;
         std::unique_ptr<impl> impl_;
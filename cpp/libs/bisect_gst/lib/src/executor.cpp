@@ -0,0 +1,130 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/executor.h"
+#include "bisect/expected/macros.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace bisect;
+using namespace bisect::gst;
+
+namespace
+{
+    struct worker_t
+    {
+        worker_t() : context(g_main_context_new()), loop(g_main_loop_new(context, FALSE))
+        {
+            thread = std::thread([this]() {
+                g_main_context_push_thread_default(context);
+                g_main_loop_run(loop);
+                g_main_context_pop_thread_default(context);
+            });
+        }
+
+        ~worker_t()
+        {
+            // Quitting from the context itself, so that a loop that has not started running yet still stops.
+            g_main_context_invoke(
+                context,
+                [](gpointer data) -> gboolean {
+                    g_main_loop_quit(static_cast<GMainLoop*>(data));
+                    return G_SOURCE_REMOVE;
+                },
+                loop);
+            thread.join();
+            g_main_loop_unref(loop);
+            g_main_context_unref(context);
+        }
+
+        GMainContext* context;
+        GMainLoop* loop;
+        std::thread thread;
+        size_t pipelines = 0;
+    };
+
+    std::mutex shared_mutex;
+    std::shared_ptr<executor> shared_executor;
+    size_t shared_thread_count = executor::default_thread_count;
+} // namespace
+
+struct executor::impl
+{
+    explicit impl(size_t thread_count)
+    {
+        workers_.reserve(thread_count);
+        for(size_t i = 0; i < thread_count; ++i)
+        {
+            workers_.push_back(std::make_unique<worker_t>());
+        }
+    }
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<worker_t>> workers_;
+};
+
+executor::executor(size_t thread_count) : impl_(std::make_unique<impl>(thread_count))
+{
+}
+
+executor::~executor() = default;
+
+bisect::expected<std::shared_ptr<executor>> executor::create(size_t thread_count) noexcept
+{
+    BST_ENFORCE(thread_count > 0, "An executor needs at least one thread");
+    return std::shared_ptr<executor>(new executor(thread_count));
+}
+
+std::shared_ptr<executor> executor::shared()
+{
+    std::unique_lock lock(shared_mutex);
+    if(shared_executor == nullptr)
+    {
+        shared_executor = std::shared_ptr<executor>(new executor(shared_thread_count));
+    }
+    return shared_executor;
+}
+
+maybe_ok executor::configure_shared(size_t thread_count) noexcept
+{
+    BST_ENFORCE(thread_count > 0, "An executor needs at least one thread");
+
+    std::unique_lock lock(shared_mutex);
+    BST_ENFORCE(shared_executor == nullptr || shared_executor->thread_count() == thread_count,
+                "The shared executor is already running with {} threads", shared_executor->thread_count());
+    shared_thread_count = thread_count;
+    return {};
+}
+
+GMainContext* executor::acquire() noexcept
+{
+    std::unique_lock lock(impl_->mutex_);
+    auto& worker = *std::ranges::min_element(impl_->workers_, {}, [](const auto& w) { return w->pipelines; });
+    ++worker->pipelines;
+    return worker->context;
+}
+
+void executor::release(GMainContext* context) noexcept
+{
+    std::unique_lock lock(impl_->mutex_);
+    const auto it = std::ranges::find(impl_->workers_, context, [](const auto& w) { return w->context; });
+    if(it != impl_->workers_.end() && (*it)->pipelines > 0) --(*it)->pipelines;
+}
+
+size_t executor::thread_count() const noexcept
+{
+    return impl_->workers_.size();
+}
@@ -16,59 +16,151 @@
 #include "bisect/expected/match.h"
 #include "bisect/expected/macros.h"
 #include "bisect/expected.h"
+#include <condition_variable>
+#include <mutex>
 
 using namespace bisect;
 using namespace bisect::gst;
 
+namespace
+{
+    // Runs a callable on the thread of a context and waits for it to finish.
+    struct call_t
+    {
+        explicit call_t(std::function<void()> f) : function(std::move(f)) {}
+
+        std::function<void()> function;
+        std::mutex mutex;
+        std::condition_variable done_condition;
+        bool done = false;
+
+        static gboolean dispatch(gpointer data)
+        {
+            auto self = static_cast<call_t*>(data);
+            self->function();
+
+            std::unique_lock lock(self->mutex);
+            self->done = true;
+            self->done_condition.notify_all();
+            return G_SOURCE_REMOVE;
+        }
+    };
+
+    void invoke_and_wait(GMainContext* context, std::function<void()> function)
+    {
+        if(g_main_context_is_owner(context))
+        {
+            function();
+            return;
+        }
+
+        call_t call(std::move(function));
+        g_main_context_invoke(context, &call_t::dispatch, &call);
+
+        std::unique_lock lock(call.mutex);
+        call.done_condition.wait(lock, [&call]() { return call.done; });
+    }
+} // namespace
+
 struct pipeline::impl
 {
-    impl(GstElement* pipeline) : pipeline_(pipeline) {}
+    impl(GstElement* pipeline, std::shared_ptr<executor> executor)
+        : pipeline_(pipeline), executor_(std::move(executor))
+    {
+    }
 
     ~impl()
     {
-        g_main_loop_quit(gst_loop_);
-        this->wait();
+        this->stop();
         gst_object_unref(GST_OBJECT(pipeline_));
-        g_main_loop_unref(gst_loop_);
     }
 
     void start()
     {
-        gst_loop_ = g_main_loop_new(nullptr, FALSE);
-        thread_   = std::thread([this]() {
-            auto result = this->run();
-            if(!result.has_value()) this->handle_error(result.error().what());
-        });
-    }
+        if(context_ != nullptr) return;
 
-    maybe_ok run()
-    {
         is_owned_ = false;
-        auto bus  = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
-        gst_bus_add_watch(bus, &impl::bus_callback, this);
+        context_  = executor_->acquire();
+        {
+            std::unique_lock lock(mutex_);
+            is_running_ = true;
+        }
+
+        // Both the bus watch and the state changes run on the executor thread that owns the context, as they did on
+        // the dedicated loop thread.
+        auto bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
+        watch_   = gst_bus_create_watch(bus);
         gst_object_unref(bus);
+        // A bus watch calls its callback as a GstBusFunc.
+        const auto callback = reinterpret_cast<void (*)()>(&impl::bus_callback);
+        g_source_set_callback(watch_, reinterpret_cast<GSourceFunc>(callback), this, nullptr);
+        g_source_attach(watch_, context_);
 
-        /* run */
+        g_main_context_invoke(
+            context_,
+            [](gpointer data) -> gboolean {
+                auto self   = static_cast<impl*>(data);
+                auto result = self->run();
+                if(!result.has_value()) self->handle_error(result.error().what());
+                return G_SOURCE_REMOVE;
+            },
+            this);
+    }
+
+    void stop()
+    {
+        if(context_ == nullptr) return;
+
+        // Ordered after the invocation queued by start, so `this` outlives it.
+        invoke_and_wait(context_, [this]() { this->halt(); });
+        // The state change queued by halt, or by an earlier error, still refers to `this`.
+        this->wait();
+        executor_->release(context_);
+        context_ = nullptr;
+    }
+
+    maybe_ok run()
+    {
         BST_ENFORCE(gst_element_set_state(pipeline_, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE,
                     "Failed changing GStreamer pipeline to Playing");
-        g_main_loop_run(gst_loop_);
+        return {};
+    }
 
-        /* cleanup */
-        BST_ENFORCE(gst_element_set_state(pipeline_, GST_STATE_NULL) != GST_STATE_CHANGE_FAILURE,
-                    "Failed changing GStreamer pipeline to Null");
+    // Called on the executor thread. Only the bus watch is removed here: setting the pipeline to Null blocks until
+    // its streaming threads have stopped, which would hold up every other pipeline served by the same thread, so it
+    // is left to a thread of GStreamer's pool.
+    void halt()
+    {
+        if(watch_ == nullptr) return;
 
-        return {};
+        g_source_destroy(watch_);
+        g_source_unref(watch_);
+        watch_ = nullptr;
+
+        gst_element_call_async(
+            pipeline_,
+            [](GstElement* element, gpointer data) {
+                auto self = static_cast<impl*>(data);
+                if(gst_element_set_state(element, GST_STATE_NULL) == GST_STATE_CHANGE_FAILURE)
+                {
+                    g_printerr("Failed changing GStreamer pipeline to Null\n");
+                }
+
+                // Nothing of `this` is used once the lock is released, as stop() may then destroy it.
+                std::unique_lock lock(self->mutex_);
+                self->is_running_ = false;
+                self->stopped_condition_.notify_all();
+            },
+            this, nullptr);
     }
 
     void wait()
     {
-        if(thread_.joinable())
-        {
-            thread_.join();
-        }
+        std::unique_lock lock(mutex_);
+        stopped_condition_.wait(lock, [this]() { return !is_running_; });
     }
 
-    void handle_error(const char* message) { g_main_loop_quit(gst_loop_); }
+    void handle_error(const char* /*message*/) { this->halt(); }
 
     static gboolean bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer data)
     {
@@ -110,13 +202,18 @@ struct pipeline::impl
         return TRUE;
     }
 
-    GMainLoop* gst_loop_;
     GstElement* pipeline_;
-    std::thread thread_;
-    bool is_owned_ = true;
+    std::shared_ptr<executor> executor_;
+    GMainContext* context_ = nullptr;
+    GSource* watch_        = nullptr;
+    std::mutex mutex_;
+    std::condition_variable stopped_condition_;
+    bool is_running_ = false;
+    bool is_owned_   = true;
 };
 
-pipeline::pipeline(GstElement* bin) noexcept : impl_(std::make_unique<impl>(bin))
+pipeline::pipeline(GstElement* bin, std::shared_ptr<executor> executor) noexcept
+    : impl_(std::make_unique<impl>(bin, std::move(executor)))
 {
 }
 
@@ -126,10 +223,16 @@ pipeline::pipeline() noexcept
 
 bisect::expected<pipeline> pipeline::create(const char* klass) noexcept
 {
+    return create(klass, executor::shared());
+}
+
+bisect::expected<pipeline> pipeline::create(const char* klass, std::shared_ptr<executor> executor) noexcept
+{
+    BST_ENFORCE(executor != nullptr, "A GStreamer pipeline needs an executor");
     auto bin = gst_pipeline_new(klass);
     BST_ENFORCE(bin != nullptr, "Failed to create GStreamer pipeline");
 
-    return pipeline(bin);
+    return pipeline(bin, std::move(executor));
 }
 
 pipeline::~pipeline()                           = default;
@@ -167,5 +270,10 @@ maybe_ok pipeline::pause()
 
 void pipeline::stop()
 {
-    g_main_loop_quit(impl_->gst_loop_);
+    impl_->stop();
+}
+
+void pipeline::wait()
+{
+    impl_->wait();
 }
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reports how long selecting the destination port of the second leg of an IS-05 PATCH takes with the selectors, which
+// resolve the path by reference, and with the type erased selectors they replaced, which copy every level of it.
+
+#include "bisect/json.h"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace bisect;
+using namespace bisect::selectors;
+using json = nlohmann::json;
+
+namespace
+{
+    // An IS-05 PATCH to the staged endpoint of a SMPTE 2022-7 receiver.
+    const auto patch = json::parse(R"({
+        "sender_id": "c72cca5b-01db-47ba-bb41-d43ba65d4c43",
+        "master_enable": true,
+        "activation": {"mode": "activate_immediate", "requested_time": null},
+        "transport_file": {"data": "v=0\r\no=- 1 1 IN IP4 192.168.1.10\r\n", "type": "application/sdp"},
+        "transport_params": [
+            {"source_ip": "192.168.1.10", "multicast_ip": "239.10.10.1", "interface_ip": "192.168.1.100",
+             "destination_port": 5004, "rtp_enabled": true},
+            {"source_ip": "192.168.2.10", "multicast_ip": "239.10.20.1", "interface_ip": "192.168.2.100",
+             "destination_port": 5006, "rtp_enabled": true}
+        ],
+        "tags": [{"name": "location", "value": ["studio 1"]}, {"name": "role", "value": ["program"]}]
+    })");
+
+    mapper_t copying_element(std::string name)
+    {
+        return [name](const json& j) -> expected<json> { return find<json>(j, name); };
+    }
+
+    mapper_t copying_index(json::size_type idx)
+    {
+        return [idx](const json& j) -> expected<json> {
+            BST_ENFORCE(idx < j.size(), "Index is greater than array length: {} {}", j.dump(), idx);
+            return expected<json>{j[idx]};
+        };
+    }
+
+    struct result_t
+    {
+        double average_ns;
+        size_t failed;
+    };
+
+    template <typename F> result_t time_selects(size_t iterations, F&& select_port)
+    {
+        size_t failed    = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            const auto port = select_port();
+            if(!port.has_value() || port.value() != 5006) ++failed;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        return {static_cast<double>(ns) / static_cast<double>(iterations), failed};
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 20000;
+    if(iterations == 0)
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return -1;
+    }
+
+    const auto copying = time_selects(iterations, [] {
+        return select<int>(patch, copying_element("transport_params"), copying_index(1),
+                           copying_element("destination_port"));
+    });
+    const auto referencing = time_selects(iterations, [] {
+        return select<int>(patch, element("transport_params"), index(1), element("destination_port"));
+    });
+
+    fmt::print("destination_port of the second leg, {} iterations\n", iterations);
+    fmt::print("{:<12} {:>10} {:>8}\n", "selectors", "ns", "failed");
+    fmt::print("{:<12} {:>10.0f} {:>8}\n", "copying", copying.average_ns, copying.failed);
+    fmt::print("{:<12} {:>10.0f} {:>8}\n", "referencing", referencing.average_ns, referencing.failed);
+    return 0;
+}
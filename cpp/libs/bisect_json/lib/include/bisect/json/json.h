@@ -18,6 +18,8 @@
 #include <nlohmann/json.hpp>
 #include <functional>
 #include <optional>
+#include <string_view>
+#include <type_traits>
 
 namespace bisect
 {
@@ -90,10 +92,20 @@ namespace bisect
         }
     } // namespace detail
 
+    // A JSON element found without copying it, e.g. with find<json_ref>. It refers into the document it was found in.
+    using json_ref = std::reference_wrapper<const nlohmann::json>;
+
     template <typename T> [[nodiscard]] inline expected<T> get_as(const nlohmann::json& j)
     {
-        BST_ENFORCE(detail::is_valid<T>(j), "JSON element does not have the right type: {}", j.dump());
-        return expected<T>(j.get<T>());
+        if constexpr(std::is_same_v<T, json_ref>)
+        {
+            return std::cref(j);
+        }
+        else
+        {
+            BST_ENFORCE(detail::is_valid<T>(j), "JSON element does not have the right type: {}", j.dump());
+            return expected<T>(j.get<T>());
+        }
     }
 
     template <typename R> expected<R> find(const nlohmann::json& j, std::string_view next)
@@ -218,62 +230,120 @@ namespace bisect
         return maybe_find<R>(*it, rest...);
     }
 
+    // Selectors resolve one level of a path into a JSON document. Those below return a reference into the document
+    // and are plain values, so that a whole path is resolved without copies or type erasure. A mapper_t can still be
+    // used for any other step; its result is held for the rest of the path.
     namespace selectors
     {
-        using json = nlohmann::json;
+        using json     = nlohmann::json;
+        using json_ref = bisect::json_ref;
 
         using mapper_t = std::function<expected<json>(const json&)>;
 
-        namespace detail
+        // The member `name` of an object. The name is not copied.
+        struct element_t
         {
-            template <typename R, typename T> expected<R> do_select(const json& j, T matcher)
-            {
-                BST_ASSIGN(level, matcher(j));
-                return get_as<R>(level);
-            }
+            std::string_view name;
 
-            template <typename R, typename T, typename... Ts>
-            expected<R> do_select(const json& j, T matcher, Ts... matchers)
+            expected<json_ref> operator()(const json& j) const
             {
-                BST_ASSIGN(level, matcher(j));
-                return do_select<R>(level, matchers...);
+                const auto it = j.find(name);
+                BST_ENFORCE(it != j.end(), "Value with key '{}' not found in {}", name, j.dump());
+                return std::cref(*it);
             }
-        } // namespace detail
+        };
 
-        inline auto element(std::string name) -> mapper_t
+        // The element at `idx` of an array.
+        struct index_t
         {
-            return [name](const json& j) -> expected<json> { return find<json>(j, name); };
-        }
+            json::size_type idx;
 
-        inline auto index(json::size_type idx) -> mapper_t
-        {
-            return [idx](const json& j) -> expected<json> {
-                BST_ENFORCE(idx < j.size(), "Index is greater than array length: {} {}", j.dump(), idx);
-                return expected<json>{j[idx]};
-            };
-        }
+            expected<json_ref> operator()(const json& j) const
+            {
+                BST_ENFORCE(j.is_array() && idx < j.size(), "Index is greater than array length: {} {}", j.dump(),
+                            idx);
+                return std::cref(j[idx]);
+            }
+        };
 
-        inline auto name_value(std::string name) -> mapper_t
+        // The "value" of the element of an array of {"name": ..., "value": ...} objects with the given name. The name
+        // is not copied.
+        struct name_value_t
         {
-            return [name](const json& j) -> expected<json> {
+            std::string_view name;
+
+            expected<json_ref> operator()(const json& j) const
+            {
                 BST_ENFORCE(j.is_array(), "JSON value is not an array.");
 
                 for(const auto& element : j)
                 {
-                    BST_ASSIGN(actual_name, find<std::string>(element, "name"));
-                    if(actual_name == name)
-                    {
-                        return find<json>(element, "value");
-                    }
+                    const auto actual_name = element.find("name");
+                    BST_ENFORCE(actual_name != element.end() && actual_name->is_string(),
+                                "Value with key 'name' not found in {}", element.dump());
+                    if(actual_name->get_ref<const std::string&>() != name) continue;
+
+                    const auto value = element.find("value");
+                    BST_ENFORCE(value != element.end(), "Value with key 'value' not found in {}", element.dump());
+                    return std::cref(*value);
                 }
 
                 BST_FAIL("JSON does not contain {}: {}", name, j.dump());
-            };
+            }
+        };
+
+        constexpr element_t element(std::string_view name)
+        {
+            return element_t{name};
         }
+
+        constexpr index_t index(json::size_type idx)
+        {
+            return index_t{idx};
+        }
+
+        constexpr name_value_t name_value(std::string_view name)
+        {
+            return name_value_t{name};
+        }
+
+        namespace detail
+        {
+            template <typename T>
+            constexpr bool returns_reference =
+                std::is_same_v<std::invoke_result_t<const T&, const json&>, expected<json_ref>>;
+
+            template <typename F, typename T, typename... Ts>
+            auto do_select(const json& j, const F& on_selected, const T& selector, const Ts&... rest)
+                -> decltype(on_selected(j))
+            {
+                BST_ASSIGN(level, selector(j));
+                const json& next = level;
+                if constexpr(sizeof...(Ts) == 0)
+                {
+                    return on_selected(next);
+                }
+                else
+                {
+                    return do_select(next, on_selected, rest...);
+                }
+            }
+        } // namespace detail
     } // namespace selectors
 
-    template <typename R, typename... Ts> expected<R> select(const nlohmann::json& j, Ts... matchers)
+    template <typename R, typename... Ts> expected<R> select(const nlohmann::json& j, const Ts&... path)
+    {
+        return selectors::detail::do_select(j, [](const nlohmann::json& v) { return get_as<R>(v); }, path...);
+    }
+
+    // The element at the end of the path, without copying it. Each selector must return a reference, so that the
+    // result refers into `j`.
+    template <typename... Ts>
+    expected<selectors::json_ref> select_ref(const nlohmann::json& j, const Ts&... path)
     {
-        return selectors::detail::do_select<R>(j, matchers...);
+        static_assert((selectors::detail::returns_reference<Ts> && ...),
+                      "select_ref needs selectors returning references into the document");
+        return selectors::detail::do_select(
+            j, [](const nlohmann::json& v) -> expected<selectors::json_ref> { return std::cref(v); }, path...);
     }
 } // namespace bisect
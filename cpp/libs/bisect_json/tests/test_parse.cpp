@@ -33,3 +33,16 @@ TEST(bisect_json, test_find_deep)
     const auto v  = find<std::string>(j, "a1", "a2", "a3").value();
     ASSERT_TRUE(v == "value");
 }
+
+TEST(bisect_json, test_find_ref_does_not_copy)
+{
+    const auto j = json::parse(R"({"network": {"primary": {"destination_port": 5004}}})");
+
+    const auto primary = find<json_ref>(j, "network", "primary");
+    ASSERT_TRUE(primary.has_value());
+    ASSERT_EQ(&primary->get(), &j["network"]["primary"]);
+    ASSERT_EQ(find<int>(*primary, "destination_port").value(), 5004);
+
+    ASSERT_FALSE(maybe_find<json_ref>(j, "network", "secondary").value().has_value());
+    ASSERT_FALSE(find<json_ref>(j, "media").has_value());
+}
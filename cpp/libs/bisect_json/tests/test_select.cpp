@@ -0,0 +1,72 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/json.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace bisect;
+using namespace bisect::selectors;
+using json = nlohmann::json;
+
+namespace
+{
+    // An IS-05 PATCH to the staged endpoint of a SMPTE 2022-7 receiver.
+    const auto patch = json::parse(R"({
+        "sender_id": "c72cca5b-01db-47ba-bb41-d43ba65d4c43",
+        "master_enable": true,
+        "activation": {"mode": "activate_immediate", "requested_time": null},
+        "transport_file": {"data": "v=0\r\no=- 1 1 IN IP4 192.168.1.10\r\n", "type": "application/sdp"},
+        "transport_params": [
+            {"source_ip": "192.168.1.10", "multicast_ip": "239.10.10.1", "interface_ip": "192.168.1.100",
+             "destination_port": 5004, "rtp_enabled": true},
+            {"source_ip": "192.168.2.10", "multicast_ip": "239.10.20.1", "interface_ip": "192.168.2.100",
+             "destination_port": 5006, "rtp_enabled": true}
+        ],
+        "tags": [{"name": "location", "value": ["studio 1"]}, {"name": "role", "value": ["program"]}]
+    })");
+
+    // The type erased selectors this library used to have, which copy every level of the path.
+    mapper_t copying_element(std::string name)
+    {
+        return [name](const json& j) -> expected<json> { return find<json>(j, name); };
+    }
+} // namespace
+
+TEST(bisect_json, select_path)
+{
+    ASSERT_EQ(select<int>(patch, element("transport_params"), index(1), element("destination_port")).value(), 5006);
+    ASSERT_EQ(select<std::string>(patch, element("tags"), name_value("role"), index(0)).value(), "program");
+    ASSERT_EQ(select<std::string>(patch, element("activation"), element("mode")).value(), "activate_immediate");
+
+    ASSERT_FALSE(select<int>(patch, element("transport_params"), index(2)).has_value());
+    ASSERT_FALSE(select<int>(patch, element("tags"), name_value("owner")).has_value());
+    ASSERT_FALSE(select<int>(patch, element("activation"), element("mode")).has_value());
+}
+
+TEST(bisect_json, select_ref_points_into_the_document)
+{
+    constexpr auto second_leg = index(1);
+
+    const auto leg = select_ref(patch, element("transport_params"), second_leg);
+    ASSERT_TRUE(leg.has_value()) << leg.error().what();
+    ASSERT_EQ(&leg->get(), &patch["transport_params"][1]);
+}
+
+TEST(bisect_json, select_with_type_erased_steps)
+{
+    ASSERT_EQ(select<std::string>(patch, copying_element("transport_params"), index(0), copying_element("source_ip"))
+                  .value(),
+              "192.168.1.10");
+}
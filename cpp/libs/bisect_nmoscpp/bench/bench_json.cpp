@@ -0,0 +1,74 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reports how long the transport parameters of an activation take to go from nlohmann::json to cpprest and back,
+// through serialized strings as before, and with to_web_json and from_web_json.
+
+#include "bisect/nmoscpp/json.h"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace bisect::nmoscpp;
+using json = nlohmann::json;
+
+namespace
+{
+    // Staged transport parameters of a SMPTE 2022-7 receiver, as handled on every activation.
+    const auto transport_params = json::parse(R"([
+        {"source_ip": "192.168.1.10", "multicast_ip": "239.10.10.1", "interface_ip": "192.168.1.100",
+         "destination_port": 5004, "rtp_enabled": true},
+        {"source_ip": "192.168.2.10", "multicast_ip": "239.10.20.1", "interface_ip": "192.168.2.100",
+         "destination_port": 5004, "rtp_enabled": true}
+    ])");
+
+    // The size of the converted value is summed up so that the work is not optimized away.
+    template <typename F> double average_ns(size_t iterations, size_t& sizes, F&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            sizes += f().size();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        return static_cast<double>(ns) / static_cast<double>(iterations);
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000;
+    if(iterations == 0)
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return -1;
+    }
+
+    const auto through_strings = [] {
+        const auto v = web::json::value::parse(utility::conversions::to_string_t(transport_params.dump()));
+        return json::parse(utility::conversions::to_utf8string(v.serialize()));
+    };
+    const auto converted = [] { return from_web_json(to_web_json(transport_params)); };
+
+    size_t sizes                 = 0;
+    const auto through_string_ns = average_ns(iterations, sizes, through_strings);
+    const auto converted_ns      = average_ns(iterations, sizes, converted);
+
+    fmt::print("transport params both ways, {} iterations ({} legs):\n", iterations, sizes / (2 * iterations));
+    fmt::print("{:<16} {:>10.0f} ns\n", "through strings", through_string_ns);
+    fmt::print("{:<16} {:>10.0f} ns\n", "converted", converted_ns);
+    return 0;
+}
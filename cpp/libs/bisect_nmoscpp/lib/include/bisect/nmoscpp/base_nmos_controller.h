@@ -24,9 +24,12 @@
 #include <nmos/node_server.h>
 #include <nmos/process_utils.h>
 #include <nmos/server.h>
+#include <memory>
 
 namespace bisect::nmoscpp
 {
+    class transport_file_cache_t;
+
     class nmos_base_controller_t
     {
       public:
@@ -36,12 +39,15 @@ namespace bisect::nmoscpp
         nmos::experimental::log_gate& gate_;
         nmos_event_handler_t* const event_handler_;
         nmos::node_model node_model_;
+        // Shared with the transport file setter of the node implementation.
+        std::shared_ptr<transport_file_cache_t> transport_files_;
         // Must be initialized after node_model and gate
         nmos::experimental::node_implementation node_implementation_;
 
       private:
         [[nodiscard]] static maybe_ok init(nmos::node_model& node_model_, nmos::experimental::log_gate& gate_,
                                            nmos::experimental::node_implementation& node_implementation_,
-                                           web::json::value configuration, nmos_event_handler_t* event_handler);
+                                           web::json::value configuration, nmos_event_handler_t* event_handler,
+                                           std::shared_ptr<transport_file_cache_t> transport_files);
     };
 } // namespace bisect::nmoscpp
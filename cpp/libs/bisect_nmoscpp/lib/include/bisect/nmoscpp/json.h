@@ -0,0 +1,26 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cpprest/json.h>
+#include <nlohmann/json.hpp>
+
+namespace bisect::nmoscpp
+{
+    // Convert between nlohmann::json and cpprestsdk's web::json::value by walking the tree, without going through a
+    // serialized string. Integers keep their signedness and floating point numbers their exact value.
+    web::json::value to_web_json(const nlohmann::json& j);
+    nlohmann::json from_web_json(const web::json::value& v);
+} // namespace bisect::nmoscpp
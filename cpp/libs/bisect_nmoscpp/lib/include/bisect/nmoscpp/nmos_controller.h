@@ -26,7 +26,10 @@
 #include <nmos/connection_resources.h>
 #include <nmos/connection_activation.h>
 #include <nmos/node_interfaces.h>
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace bisect::nmoscpp
 {
@@ -61,6 +64,19 @@ namespace bisect::nmoscpp
                                                          const flow_t& flow_config, std::string media_type,
                                                          const video_sender_info_t& media);
 
+        // Resource changes applied together by commit().
+        struct batch_t
+        {
+            std::vector<nmos::resource> resources;
+            std::vector<nmos::resource> connection_resources;
+            std::vector<std::pair<nmos::id, std::function<void(nmos::resource&)>>> modifications;
+        };
+
+        // Inserts the resources, then the connection resources, then applies the modifications, all under a single
+        // write lock of the node model and with a single notification of the node behaviour thread. Stops at the
+        // first failure, leaving the changes before it applied.
+        bisect::maybe_ok commit(batch_t&& batch);
+
         bisect::maybe_ok insert_resource(nmos::resource&& resource);
         bisect::maybe_ok insert_connection_resource(nmos::resource&& resource);
         bisect::maybe_ok modify_resource(const nmos::id& resource_id, std::function<void(nmos::resource&)> modifier);
@@ -29,13 +29,13 @@ namespace bisect::nmoscpp
       public:
         virtual ~nmos_event_handler_t() = default;
 
-        [[nodiscard]] virtual bisect::expected<std::string>
-        handle_active_state_changed(const nmos::resource& resource, const nmos::resource& connection_resource,
-                                    const std::string& transport_params) = 0;
+        [[nodiscard]] virtual maybe_ok handle_active_state_changed(const nmos::resource& resource,
+                                                                   const nmos::resource& connection_resource,
+                                                                   const web::json::value& transport_params) = 0;
 
         [[nodiscard]] virtual maybe_ok handle_patch_request(const nmos::resource& resource,
                                                             const nmos::resource& connection_resource,
-                                                            const std::string& endpoint_staged)               = 0;
+                                                            const web::json::value& endpoint_staged)          = 0;
         [[nodiscard]] virtual bisect::expected<sdp_info_t> handle_sdp_info_request(const nmos::id& sender_id) = 0;
     };
 
@@ -96,8 +96,7 @@ namespace
         // beyond what is expressed by the schemas and /constraints endpoint
         return [event_handler](const nmos::resource& resource, const nmos::resource& connection_resource,
                                const web::json::value& endpoint_staged, slog::base_gate& gate) {
-            auto result = event_handler->handle_patch_request(resource, connection_resource,
-                                                              utility::us2s(endpoint_staged.serialize()));
+            auto result = event_handler->handle_patch_request(resource, connection_resource, endpoint_staged);
 
             if(is_error(result))
             {
@@ -110,15 +109,17 @@ namespace
     // by reference!
     nmos::connection_sender_transportfile_setter
     make_node_implementation_transportfile_setter(const nmos::resources& node_resources, const nmos::settings& settings,
-                                                  nmos_event_handler_t* event_handler)
+                                                  nmos_event_handler_t* event_handler,
+                                                  std::shared_ptr<transport_file_cache_t> transport_files)
     {
         using web::json::value;
 
         // as part of activation, the sender /transportfile should be updated based on the active transport parameters
-        return [&node_resources, event_handler](const nmos::resource& sender, const nmos::resource& connection_sender,
-                                                value& endpoint_transportfile) {
-            auto result =
-                build_transport_file(node_resources, event_handler, sender, connection_sender, endpoint_transportfile);
+        return [&node_resources, event_handler, transport_files](const nmos::resource& sender,
+                                                                 const nmos::resource& connection_sender,
+                                                                 value& endpoint_transportfile) {
+            auto result = build_transport_file(node_resources, event_handler, *transport_files, sender,
+                                               connection_sender, endpoint_transportfile);
             if(is_error(result))
             {
                 throw std::logic_error(result.error().what());
@@ -214,8 +215,9 @@ namespace
 
     // This constructs all the callbacks used to integrate the example device-specific underlying implementation
     // into the server instance for the NMOS Node.
-    nmos::experimental::node_implementation make_node_implementation(nmos::node_model& model, slog::base_gate& gate,
-                                                                     nmos_event_handler_t* event_handler)
+    nmos::experimental::node_implementation
+    make_node_implementation(nmos::node_model& model, slog::base_gate& gate, nmos_event_handler_t* event_handler,
+                             std::shared_ptr<transport_file_cache_t> transport_files)
     {
         return nmos::experimental::node_implementation()
             .on_load_server_certificates(nmos::make_load_server_certificates_handler(model.settings, gate))
@@ -229,8 +231,8 @@ namespace
                 make_node_implementation_transport_file_parser()) // may be omitted if the default is sufficient
             .on_validate_connection_resource_patch(make_node_implementation_patch_validator(event_handler))
             .on_resolve_auto(make_node_implementation_auto_resolver(model.settings, event_handler))
-            .on_set_transportfile(
-                make_node_implementation_transportfile_setter(model.node_resources, model.settings, event_handler))
+            .on_set_transportfile(make_node_implementation_transportfile_setter(model.node_resources, model.settings,
+                                                                                event_handler, transport_files))
             .on_connection_activated(make_node_implementation_connection_activation_handler(model, gate))
             .on_validate_channelmapping_output_map(
                 make_node_implementation_map_validator()) // may be omitted if not required
@@ -240,14 +242,15 @@ namespace
 
 nmos_base_controller_t::nmos_base_controller_t(nmos::experimental::log_gate& gate, web::json::value configuration,
                                                nmos_event_handler_t* event_handler)
-    : gate_(gate), event_handler_(event_handler)
+    : gate_(gate), event_handler_(event_handler), transport_files_(std::make_shared<transport_file_cache_t>())
 {
-    (void)init(node_model_, gate_, node_implementation_, configuration, event_handler);
+    (void)init(node_model_, gate_, node_implementation_, configuration, event_handler, transport_files_);
 }
 
 maybe_ok nmos_base_controller_t::init(nmos::node_model& node_model, nmos::experimental::log_gate& gate,
                                       nmos::experimental::node_implementation& node_implementation,
-                                      web::json::value configuration, nmos_event_handler_t* event_handler)
+                                      web::json::value configuration, nmos_event_handler_t* event_handler,
+                                      std::shared_ptr<transport_file_cache_t> transport_files)
 {
     try
     {
@@ -271,7 +274,7 @@ maybe_ok nmos_base_controller_t::init(nmos::node_model& node_model, nmos::experi
 
         // Set up the callbacks between the node server and the underlying implementation
 
-        node_implementation = make_node_implementation(node_model, gate, event_handler);
+        node_implementation = make_node_implementation(node_model, gate, event_handler, std::move(transport_files));
 
         return {};
     }
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/nmoscpp/json.h"
+#include <utility>
+#include <vector>
+
+using namespace bisect::nmoscpp;
+
+web::json::value bisect::nmoscpp::to_web_json(const nlohmann::json& j)
+{
+    switch(j.type())
+    {
+    case nlohmann::json::value_t::object: {
+        std::vector<std::pair<utility::string_t, web::json::value>> fields;
+        fields.reserve(j.size());
+        for(const auto& [key, value] : j.items())
+        {
+            fields.emplace_back(utility::conversions::to_string_t(key), to_web_json(value));
+        }
+        // Sorted like the objects cpprestsdk parses, for the same lookups.
+        return web::json::value::object(std::move(fields));
+    }
+    case nlohmann::json::value_t::array: {
+        std::vector<web::json::value> elements;
+        elements.reserve(j.size());
+        for(const auto& element : j)
+        {
+            elements.push_back(to_web_json(element));
+        }
+        return web::json::value::array(std::move(elements));
+    }
+    case nlohmann::json::value_t::string:
+        return web::json::value::string(utility::conversions::to_string_t(j.get_ref<const std::string&>()));
+    case nlohmann::json::value_t::boolean: return web::json::value::boolean(j.get<bool>());
+    case nlohmann::json::value_t::number_integer: return web::json::value::number(j.get<int64_t>());
+    case nlohmann::json::value_t::number_unsigned: return web::json::value::number(j.get<uint64_t>());
+    case nlohmann::json::value_t::number_float: return web::json::value::number(j.get<double>());
+    // Binary and discarded values never come out of parsing text, which is all the configuration goes through.
+    case nlohmann::json::value_t::binary:
+    case nlohmann::json::value_t::discarded:
+    case nlohmann::json::value_t::null: return web::json::value::null();
+    }
+    return web::json::value::null();
+}
+
+nlohmann::json bisect::nmoscpp::from_web_json(const web::json::value& v)
+{
+    switch(v.type())
+    {
+    case web::json::value::Object: {
+        auto j = nlohmann::json::object();
+        for(const auto& [key, value] : v.as_object())
+        {
+            j.emplace(utility::conversions::to_utf8string(key), from_web_json(value));
+        }
+        return j;
+    }
+    case web::json::value::Array: {
+        auto j = nlohmann::json::array();
+        j.get_ref<nlohmann::json::array_t&>().reserve(v.size());
+        for(const auto& element : v.as_array())
+        {
+            j.push_back(from_web_json(element));
+        }
+        return j;
+    }
+    case web::json::value::String: return utility::conversions::to_utf8string(v.as_string());
+    case web::json::value::Boolean: return v.as_bool();
+    case web::json::value::Number: {
+        const auto& number = v.as_number();
+        if(number.is_int64()) return number.to_int64();
+        if(number.is_uint64()) return number.to_uint64();
+        return number.to_double();
+    }
+    case web::json::value::Null: return nullptr;
+    }
+    return nullptr;
+}
@@ -531,6 +531,65 @@ maybe_ok nmos_controller_t::insert_resource(nmos::resource&& resource)
     return {};
 }
 
+maybe_ok nmos_controller_t::commit(batch_t&& batch)
+{
+    auto& model = base_controller_.node_model_;
+    auto lock   = model.write_lock();
+    if(nmos::details::wait_for(model.shutdown_condition, lock, std::chrono::milliseconds(delay_millis),
+                               [&] { return model.shutdown; }))
+    {
+        BST_FAIL("Could not lock node model in order to write the new resources in it");
+    }
+
+    const auto insert = [this](nmos::resources& resources, nmos::resource&& resource) -> maybe_ok {
+        const std::pair<nmos::id, nmos::type> id_type{resource.id, resource.type};
+        if(!nmos::insert_resource(resources, std::move(resource)).second)
+        {
+            slog::log<slog::severities::severe>(base_controller_.gate_, SLOG_FLF) << "Model update error: " << id_type;
+            BST_FAIL("Error updating model with a {} resource with id {}.", utility::us2s(id_type.second.name),
+                     utility::us2s(id_type.first));
+        }
+        return {};
+    };
+
+    const auto apply = [&]() -> maybe_ok {
+        for(auto& resource : batch.resources)
+        {
+            BST_CHECK(insert(model.node_resources, std::move(resource)));
+        }
+
+        for(auto& resource : batch.connection_resources)
+        {
+            BST_CHECK(insert(model.connection_resources, std::move(resource)));
+        }
+
+        for(auto& [id, modifier] : batch.modifications)
+        {
+            const auto result = nmos::modify_resource(model.node_resources, id, [&](nmos::resource& resource) {
+                modifier(resource);
+                resource.data[nmos::fields::version] = web::json::value(nmos::make_version());
+            });
+            if(!result)
+            {
+                slog::log<slog::severities::severe>(base_controller_.gate_, SLOG_FLF) << "Model update error: " << id;
+                BST_FAIL("Error updating resource with id {}.", utility::us2s(id));
+            }
+        }
+
+        slog::log<slog::severities::info>(base_controller_.gate_, SLOG_FLF)
+            << "Updated model with " << batch.resources.size() << " resources, " << batch.connection_resources.size()
+            << " connection resources and " << batch.modifications.size() << " modifications";
+        return {};
+    };
+
+    // Whatever was applied before a failure must still reach the node behaviour thread.
+    auto result = apply();
+    slog::log<slog::severities::too_much_info>(base_controller_.gate_, SLOG_FLF)
+        << "Notifying node behaviour thread"; // and anyone else who cares...
+    model.notify();
+    return result;
+}
+
 maybe_ok nmos_controller_t::insert_connection_resource(nmos::resource&& resource)
 {
     auto id = resource.id;
@@ -594,6 +653,7 @@ maybe_ok nmos_controller_t::erase_resource(const nmos::id& resource_id)
 maybe_ok nmos_controller_t::erase_connection_resource(const nmos::id& resource_id)
 {
     BST_CHECK(erase_resource_after_(delay_millis, base_controller_.node_model_.connection_resources, resource_id));
+    base_controller_.transport_files_->erase(resource_id);
     auto resource = find_connection_resource(resource_id);
 
     if(!is_error(resource))
@@ -643,7 +703,8 @@ maybe_ok nmos_controller_t::update_transport_file(const nmos::id& sender_id)
     modify_connection_resource(sender_id, [this, &sender](nmos::resource& connection_sender) {
         web::json::value endpoint_transportfile;
         auto result = build_transport_file(base_controller_.node_model_.node_resources, base_controller_.event_handler_,
-                                           sender, connection_sender, endpoint_transportfile);
+                                           *base_controller_.transport_files_, sender, connection_sender,
+                                           endpoint_transportfile);
 
         if(is_error(result))
         {
@@ -40,8 +40,7 @@ bisect::nmoscpp::make_node_implementation_auto_resolver(const nmos::settings& se
                    utility::us2s(resource.data.at(U("transport")).as_string()),
                    utility::us2s(transport_params.serialize()));
 
-        auto result = event_handler->handle_active_state_changed(resource, connection_resource,
-                                                                 utility::us2s(transport_params.serialize()));
+        auto result = event_handler->handle_active_state_changed(resource, connection_resource, transport_params);
 
         if(is_error(result))
         {
@@ -181,10 +180,47 @@ nmos::interlace_mode bisect::get_interlace_mode(const nmos::settings& settings)
                : nmos::interlace_modes::progressive;
 }
 
+std::optional<value> transport_file_cache_t::find(const nmos::id& sender_id, const transport_file_key_t& key) const
+{
+    std::unique_lock lock(mutex_);
+    const auto it = entries_.find(sender_id);
+    if(it == entries_.end() || !(it->second.key == key)) return std::nullopt;
+    return it->second.transportfile;
+}
+
+void transport_file_cache_t::insert(const nmos::id& sender_id, transport_file_key_t key, value transportfile)
+{
+    std::unique_lock lock(mutex_);
+    entries_.insert_or_assign(sender_id, entry_t{std::move(key), std::move(transportfile)});
+}
+
+void transport_file_cache_t::erase(const nmos::id& sender_id)
+{
+    std::unique_lock lock(mutex_);
+    entries_.erase(sender_id);
+}
+
+namespace
+{
+    // The node clock the source is locked to, or null.
+    value find_clock(const nmos::resource& node, const nmos::resource& source)
+    {
+        if(!source.data.has_field(U("clock_name")) || !node.data.has_field(U("clocks"))) return value::null();
+
+        const auto& clock_name = source.data.at(U("clock_name"));
+        for(const auto& clock : node.data.at(U("clocks")).as_array())
+        {
+            if(clock.at(U("name")) == clock_name) return clock;
+        }
+        return value::null();
+    }
+} // namespace
+
 /******************************** Warning ********************************/ 
 /* before calling this function make sure that the model is locked in */
 bisect::maybe_ok bisect::nmoscpp::build_transport_file(const nmos::resources& node_resources,
                                                        nmos_event_handler_t* event_handler,
+                                                       transport_file_cache_t& transport_files,
                                                        const nmos::resource& sender,
                                                        const nmos::resource& connection_sender,
                                                        web::json::value& endpoint_transportfile)
@@ -222,6 +258,24 @@ bisect::maybe_ok bisect::nmoscpp::build_transport_file(const nmos::resources& no
         BST_FAIL("matching IS-04 source not found");
     }
 
+    const auto& endpoint_active  = nmos::fields::endpoint_active(connection_sender.data);
+    const auto& transport_params = nmos::fields::transport_params(endpoint_active);
+    const auto& node_data        = node->data;
+    const auto interfaces        = node_data.has_field(U("interfaces")) ? node_data.at(U("interfaces")) : value::null();
+
+    auto key = transport_file_key_t{.transport_params = transport_params,
+                                    .sender_version   = sender.data.at(U("version")).as_string(),
+                                    .flow_version     = flow->data.at(U("version")).as_string(),
+                                    .source_version   = source->data.at(U("version")).as_string(),
+                                    .clock            = find_clock(*node, *source),
+                                    .interfaces       = interfaces,
+                                    .payload_type     = info.payload_type};
+    if(auto cached = transport_files.find(sender.id, key); cached.has_value())
+    {
+        endpoint_transportfile = std::move(*cached);
+        return {};
+    }
+
     auto params = [&]() -> expected<nmos::sdp_parameters> {
         const std::vector<utility::string_t> mids{U("PRIMARY"), U("SECONDARY")};
         const nmos::format format{nmos::fields::format(flow->data)};
@@ -253,16 +307,17 @@ bisect::maybe_ok bisect::nmoscpp::build_transport_file(const nmos::resources& no
     }();
     BST_ASSIGN_MUT(sdp_params, std::move(params));
 
-    auto& transport_params   = nmos::fields::transport_params(nmos::fields::endpoint_active(connection_sender.data));
     auto session_description = nmos::make_session_description(sdp_params, transport_params);
     auto txt                 = conan_sdp::make_session_description(session_description);
 
     // TODO: this is to overcome a bug that causes the video parameters not to be terminated by "; "
-    txt = std::regex_replace(txt, std::regex("; TP=2110TPN"), "; TP=2110TPN; ");
+    static const auto unterminated_type_parameter = std::regex("; TP=2110TPN");
+    txt = std::regex_replace(txt, unterminated_type_parameter, "; TP=2110TPN; ");
 
     auto sdp = txt;
     fmt::print("transport file for {} set to: {}\n", utility::us2s(sender.id), sdp);
     endpoint_transportfile = nmos::make_connection_rtp_sender_transportfile(utility::s2us(sdp));
+    transport_files.insert(sender.id, std::move(key), endpoint_transportfile);
 
     return {};
 }
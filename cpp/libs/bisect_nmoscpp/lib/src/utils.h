@@ -35,6 +35,9 @@
 #include <boost/asio/ip/address_v4.hpp>
 #include <cpprest/host_utils.h>
 #include <cpprest/uri.h>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 namespace bisect
 {
@@ -130,8 +133,44 @@ namespace bisect::nmoscpp
     nmos::connection_resource_auto_resolver make_node_implementation_auto_resolver(const nmos::settings& settings,
                                                                                    nmos_event_handler_t* event_handler);
 
+    // What a sender's transport file is built from: its active transport parameters, the versions of its IS-04
+    // resources, and the reference clock and interfaces of the node it signals.
+    struct transport_file_key_t
+    {
+        web::json::value transport_params;
+        utility::string_t sender_version;
+        utility::string_t flow_version;
+        utility::string_t source_version;
+        web::json::value clock;
+        web::json::value interfaces;
+        uint8_t payload_type;
+
+        bool operator==(const transport_file_key_t& other) const = default;
+    };
+
+    // The transport file last built for each sender, so that it is only rendered again when what it was built from
+    // changed, e.g. for the senders locked to a reference clock which has just changed and not for all of them.
+    class transport_file_cache_t
+    {
+      public:
+        std::optional<web::json::value> find(const nmos::id& sender_id, const transport_file_key_t& key) const;
+        void insert(const nmos::id& sender_id, transport_file_key_t key, web::json::value transportfile);
+        void erase(const nmos::id& sender_id);
+
+      private:
+        struct entry_t
+        {
+            transport_file_key_t key;
+            web::json::value transportfile;
+        };
+
+        mutable std::mutex mutex_;
+        std::unordered_map<nmos::id, entry_t> entries_;
+    };
+
     [[nodiscard]] maybe_ok build_transport_file(const nmos::resources& node_resources,
-                                                nmos_event_handler_t* event_handler, const nmos::resource& sender,
+                                                nmos_event_handler_t* event_handler,
+                                                transport_file_cache_t& transport_files, const nmos::resource& sender,
                                                 const nmos::resource& connection_sender,
                                                 web::json::value& endpoint_transportfile);
 } // namespace bisect::nmoscpp
@@ -0,0 +1,49 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/nmoscpp/json.h"
+#include <gtest/gtest.h>
+
+using namespace bisect::nmoscpp;
+using json = nlohmann::json;
+
+namespace
+{
+    // Staged transport parameters of a SMPTE 2022-7 receiver, as handled on every activation.
+    const auto transport_params = json::parse(R"([
+        {"source_ip": "192.168.1.10", "multicast_ip": "239.10.10.1", "interface_ip": "192.168.1.100",
+         "destination_port": 5004, "rtp_enabled": true},
+        {"source_ip": "192.168.2.10", "multicast_ip": "239.10.20.1", "interface_ip": "192.168.2.100",
+         "destination_port": 5004, "rtp_enabled": true}
+    ])");
+} // namespace
+
+TEST(bisect_nmoscpp, cpprest_round_trip)
+{
+    const auto j = json::parse(R"({"a": [1, -2, 18446744073709551615, 0.5, "x", true, null, {}], "b": {"c": "d"}})");
+
+    const auto v = to_web_json(j);
+    ASSERT_TRUE(v.at(U("b")).at(U("c")).as_string() == U("d"));
+    ASSERT_EQ(v.at(U("a")).at(1).as_number().to_int64(), -2);
+    ASSERT_EQ(v.at(U("a")).at(2).as_number().to_uint64(), 18446744073709551615u);
+
+    ASSERT_EQ(from_web_json(v), j);
+}
+
+TEST(bisect_nmoscpp, cpprest_matches_parsing)
+{
+    const auto parsed = web::json::value::parse(utility::conversions::to_string_t(transport_params.dump()));
+    ASSERT_TRUE(to_web_json(transport_params) == parsed);
+    ASSERT_EQ(from_web_json(parsed), transport_params);
+}
@@ -0,0 +1,64 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bisect::rtp
+{
+    /// Reassembles ST 2110-20 4:2:2 10-bit packets into a frame in pgroup (UYVP) layout.
+    /// All bookkeeping is sized in the constructor, so feeding packets does not allocate.
+    class frame_assembler_t
+    {
+      public:
+        frame_assembler_t(uint32_t width, uint32_t height);
+
+        /// Starts a new frame written to `frame`, whose lines are `stride` octets apart.
+        void begin(uint8_t* frame, size_t stride) noexcept;
+
+        /// Copies the sample data of one RTP payload into the current frame.
+        /// Returns false if the payload is malformed or addresses data outside the frame; valid segments that
+        /// precede the error are still copied.
+        bool add_payload(const uint8_t* payload, size_t size) noexcept;
+
+        /// Number of lines for which every pgroup has been received since begin(). A pgroup received twice counts once.
+        uint32_t complete_lines() const noexcept { return complete_lines_; }
+        bool is_complete() const noexcept { return complete_lines_ == height_; }
+        bool is_line_complete(uint32_t line) const noexcept;
+
+        uint32_t width() const noexcept { return width_; }
+        uint32_t height() const noexcept { return height_; }
+        size_t line_octets() const noexcept { return line_octets_; }
+
+      private:
+        uint32_t width_;
+        uint32_t height_;
+        size_t line_octets_;
+        uint8_t* frame_          = nullptr;
+        size_t stride_           = 0;
+        uint32_t complete_lines_ = 0;
+        size_t line_pgroups_;
+        size_t line_words_;
+        // Pgroups received in each line, as a count and as a bitmap of line_words_ words per line.
+        std::vector<uint32_t> line_fill_;
+        std::vector<uint64_t> received_;
+        std::vector<uint64_t> line_done_;
+
+        // Marks `count` pgroups of `line` from `first` as received and returns how many were not already.
+        uint32_t mark_received(uint32_t line, size_t first, size_t count) noexcept;
+    };
+} // namespace bisect::rtp
@@ -0,0 +1,54 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gst/gst.h>
+#include <string_view>
+
+namespace bisect::rtp
+{
+    /// Factory name of the ST 2110-20 payloader (drop-in for rtpvrawpay).
+    constexpr auto st2110_20_pay_factory = "st2110vrawpay";
+
+    /// Factory name of the ST 2110-20 depayloader (drop-in for rtpvrawdepay, outputs UYVP).
+    constexpr auto st2110_20_depay_factory = "st2110vrawdepay";
+
+    /// Factory name of the batched UDP sink (sendmmsg and optional UDP GSO; drop-in for udpsink).
+    constexpr auto udp_batch_sink_factory = "st2110udpsink";
+
+    /// Factory name of the batched UDP source (recvmmsg with kernel timestamps; drop-in for udpsrc).
+    constexpr auto udp_batch_src_factory = "st2110udpsrc";
+
+    /// Factory name of the SMPTE 2022-7 merge (sink_0 and sink_1 legs in, de-duplicated RTP out).
+    constexpr auto st2022_7_merge_factory = "st2110merge";
+
+    /// Caps of the GstReferenceTimestampMeta holding the kernel receive time, in ns since the Unix epoch, that
+    /// st2110udpsrc adds to each packet and st2110vrawdepay carries over from the first packet of each frame.
+    constexpr auto arrival_timestamp_caps = "timestamp/x-unix";
+
+    /// Caps of the GstReferenceTimestampMeta st2110vrawdepay adds to each frame. Its timestamp is the RTP timestamp of
+    /// the frame, in 90 kHz ticks rather than nanoseconds.
+    constexpr auto rtp_timestamp_caps = "timestamp/x-rtp";
+
+    /// Registers the in-tree RTP elements with GStreamer.
+    /// `plugin` is the owning plugin when called from a plugin_init, or nullptr for static registration by an
+    /// application. Safe to call more than once, and from several plugins of the same process: elements already
+    /// registered by one of them are left as they are.
+    bool register_elements(GstPlugin* plugin = nullptr) noexcept;
+
+    /// Depayloader factory for raw video of the given ST 2110-20 sampling and bit depth: st2110vrawdepay for
+    /// YCbCr-4:2:2 10-bit, the only format it reassembles, and rtpvrawdepay for the others.
+    const char* raw_video_depay_factory(std::string_view sampling, int depth) noexcept;
+} // namespace bisect::rtp
@@ -0,0 +1,128 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include "bisect/rtp/pacing.h"
+#include "bisect/rtp/udp_sender.h"
+#include <time.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace bisect::rtp
+{
+    struct pacing_settings_t
+    {
+        video_timing_t timing;
+        pacing_type_t type = pacing_type_t::narrow;
+        /// Clock of the epoch-aligned frame grid. CLOCK_TAI matches the ST 2059 epoch when the host runs PTP.
+        clockid_t clock = CLOCK_TAI;
+        /// How long before a packet is due to stop sleeping and start polling the clock.
+        int64_t spin_ns = 20'000;
+        /// Frames accepted ahead of the one being sent before send_frame() blocks.
+        size_t max_queued_frames = 2;
+    };
+
+    /// All packets of one frame, in sending order. Packet i is gathered from `packet_parts[i]` consecutive entries
+    /// of `parts`. The memory must stay valid until `release` is called.
+    struct paced_frame_t
+    {
+        std::vector<iovec> parts;
+        std::vector<uint32_t> packet_parts;
+        /// Called from the pacing thread once the frame is sent or dropped.
+        std::function<void()> release;
+    };
+
+    /// Sends frames on a dedicated thread, each packet at its ST 2110-21 scheduled time. The thread sleeps with
+    /// clock_nanosleep until shortly before a packet is due, then polls the clock. Packets already due when the
+    /// thread wakes up go out in one sendmmsg call.
+    class paced_sender_t
+    {
+      public:
+        static expected<std::unique_ptr<paced_sender_t>> create(const udp_sender_settings_t& network,
+                                                                const pacing_settings_t& pacing) noexcept;
+
+        ~paced_sender_t();
+        paced_sender_t(const paced_sender_t&)            = delete;
+        paced_sender_t& operator=(const paced_sender_t&) = delete;
+
+        /// Queues a frame for sending, blocking while max_queued_frames are pending. Returns an error if a previous
+        /// send failed. While flushing, the frame is released immediately.
+        maybe_ok send_frame(paced_frame_t frame) noexcept;
+
+        /// Sends the frames queued from now on to the destination of `network`, through a socket opened from it. The
+        /// frames already queued, and the one being sent, still go to the previous destination. If the socket can't
+        /// be opened, returns an error and keeps the previous destination.
+        maybe_ok retarget(const udp_sender_settings_t& network) noexcept;
+
+        /// Releases the queued frames and makes send_frame() return without blocking until cleared.
+        void set_flushing(bool flushing) noexcept;
+
+        /// Blocks until every queued frame has been sent.
+        void drain() noexcept;
+
+        pacing_counters_t counters() const noexcept;
+        /// Schedule of the last frame sent, if any.
+        std::optional<pacing_schedule_t> schedule() const noexcept;
+
+      private:
+        struct retarget_t
+        {
+            // Frames taken before this one switches, counted as taken_frames_.
+            uint64_t at_frame;
+            udp_batch_sender_uptr sender;
+        };
+
+        paced_sender_t(udp_batch_sender_uptr sender, const pacing_settings_t& pacing);
+
+        void run() noexcept;
+        maybe_ok send_paced(paced_frame_t& frame) noexcept;
+        int64_t now() const noexcept;
+        void wait_until(int64_t t_ns) const noexcept;
+
+        udp_batch_sender_uptr sender_;
+        const pacing_settings_t pacing_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        std::deque<paced_frame_t> frames_;
+        // Frames queued and frames taken off the queue, sent or dropped, since the start.
+        uint64_t queued_frames_ = 0;
+        uint64_t taken_frames_  = 0;
+        std::deque<retarget_t> retargets_;
+        bool sending_ = false;
+        std::optional<std::runtime_error> error_;
+        pacing_counters_t counters_;
+        std::optional<pacing_schedule_t> schedule_;
+        // Written under mutex_, read without it by the pacing thread between packets.
+        std::atomic<bool> flushing_ = false;
+        std::atomic<bool> stopping_ = false;
+
+        // Pacing thread only.
+        std::optional<conformance_monitor_t> monitor_;
+        int64_t last_frame_index_ = -1;
+
+        std::thread thread_;
+    };
+
+    using paced_sender_uptr = std::unique_ptr<paced_sender_t>;
+} // namespace bisect::rtp
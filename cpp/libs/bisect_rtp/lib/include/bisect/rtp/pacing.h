@@ -0,0 +1,139 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <cstdint>
+
+namespace bisect::rtp
+{
+    /// ST 2110-21 sender types.
+    enum class pacing_type_t
+    {
+        /// Type N: gapped, packets spread over the active lines of each frame.
+        narrow,
+        /// Type NL: linear, packets spread over the whole frame period.
+        narrow_linear,
+        /// Type W: gapped, with the larger bursts and buffer allowed to software senders.
+        wide,
+    };
+
+    struct video_timing_t
+    {
+        uint32_t rate_num;
+        uint32_t rate_den;
+        uint32_t height;
+        /// Interlaced and PsF frames are sent as two fields, each paced over half the frame period.
+        bool interlaced = false;
+    };
+
+    /// The ST 2110-21 transmission schedule of one video flow: when each packet of a frame leaves the sender.
+    /// Frame starts sit on the epoch-aligned grid N × TFRAME. Times are computed exactly from the rational frame
+    /// rate, so they do not drift with fractional rates.
+    class pacing_schedule_t
+    {
+      public:
+        static expected<pacing_schedule_t> create(const video_timing_t& timing, uint32_t packets_per_frame,
+                                                  pacing_type_t type) noexcept;
+
+        /// Start of the frame period `index`, in ns since the epoch.
+        int64_t frame_start_ns(int64_t index) const noexcept;
+        /// Index of the first frame period starting at or after `t_ns`.
+        int64_t frame_index_at_or_after(int64_t t_ns) const noexcept;
+        /// Send time of `packet`, relative to the start of its frame period.
+        int64_t packet_offset_ns(uint32_t packet) const noexcept;
+
+        uint32_t packets_per_frame() const noexcept { return packets_; }
+        pacing_type_t type() const noexcept { return type_; }
+        /// Frame period (TFRAME), rounded to ns.
+        int64_t frame_ns() const noexcept { return frame_ns_; }
+        /// Packet spacing (TRS), rounded to ns.
+        int64_t trs_ns() const noexcept { return trs_ns_; }
+        /// Offset of the first packet from the start of its field (TRO), rounded to ns.
+        int64_t tro_ns() const noexcept { return tro_ns_; }
+        /// Largest burst allowed by the network compatibility model.
+        uint32_t cmax() const noexcept { return cmax_; }
+        /// Size of the virtual receiver buffer, in packets.
+        uint32_t vrx_full() const noexcept { return vrx_full_; }
+
+      private:
+        pacing_schedule_t() = default;
+
+        video_timing_t timing_{};
+        pacing_type_t type_ = pacing_type_t::narrow;
+        uint32_t packets_   = 0;
+        uint32_t fields_    = 1;
+        uint32_t per_field_ = 0;
+        // Active part of a field (RACTIVE) and TRO, in 1/1125 of the field and frame period.
+        uint32_t active_lines_ = 0;
+        uint32_t tro_lines_    = 0;
+
+        int64_t frame_ns_  = 0;
+        int64_t trs_ns_    = 0;
+        int64_t tro_ns_    = 0;
+        uint32_t cmax_     = 0;
+        uint32_t vrx_full_ = 0;
+    };
+
+    struct pacing_counters_t
+    {
+        uint64_t frames  = 0;
+        uint64_t packets = 0;
+        /// Frames that missed their grid slot and were sent in a later one.
+        uint64_t late_frames = 0;
+        /// Highest Cinst seen, to compare with CMAX.
+        uint32_t cinst_peak = 0;
+        /// Highest VRX occupancy seen, to compare with VRX_FULL.
+        uint32_t vrx_peak        = 0;
+        uint64_t cmax_violations = 0;
+        uint64_t vrx_overflows   = 0;
+        /// Packets the virtual receiver wanted to read before they had arrived.
+        uint64_t vrx_underflows = 0;
+    };
+
+    /// Checks packet send times against the ST 2110-21 network compatibility (CMAX) and virtual receiver buffer
+    /// (VRX) models. Deterministic: the result depends only on the times fed in.
+    class conformance_monitor_t
+    {
+      public:
+        explicit conformance_monitor_t(const pacing_schedule_t& schedule) noexcept;
+
+        /// Switches to a new schedule, e.g. when the number of packets per frame changes. Keeps the counters.
+        void set_schedule(const pacing_schedule_t& schedule) noexcept;
+
+        /// Starts a frame whose period begins at `frame_start_ns`.
+        void begin_frame(int64_t frame_start_ns) noexcept;
+        /// Records the next packet of the current frame leaving at `t_ns`. Times must not go backwards.
+        void packet_sent(int64_t t_ns) noexcept;
+
+        const pacing_schedule_t& schedule() const noexcept { return schedule_; }
+        const pacing_counters_t& counters() const noexcept { return counters_; }
+        pacing_counters_t& counters() noexcept { return counters_; }
+
+      private:
+        pacing_schedule_t schedule_;
+        // Leaky bucket draining one packet every TDRAIN = TFRAME / (NPACKETS × 1.1).
+        int64_t tdrain_ns_   = 0;
+        uint32_t bucket_     = 0;
+        int64_t drain_since_ = 0;
+
+        int64_t frame_start_ = 0;
+        int64_t read_start_  = 0;
+        uint32_t received_   = 0;
+        uint32_t read_       = 0;
+
+        pacing_counters_t counters_;
+    };
+} // namespace bisect::rtp
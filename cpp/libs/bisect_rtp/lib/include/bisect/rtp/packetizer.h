@@ -0,0 +1,73 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bisect::rtp
+{
+    /// ST 2110-20 packing modes.
+    enum class packing_mode_t
+    {
+        /// General Packing Mode: packets are filled up to the maximum payload size.
+        gpm,
+        /// Block Packing Mode: every packet but the last of a frame carries bpm_data_octets of sample data.
+        bpm,
+    };
+
+    constexpr size_t rtp_header_octets     = 12;
+    constexpr size_t payload_header_octets = 2; // Extended Sequence Number
+    constexpr size_t srd_header_octets     = 6; // Length, F + Line No, C + Offset
+    constexpr size_t bpm_data_octets       = 1260;
+    constexpr size_t max_srds_per_packet   = 4;
+
+    /// One Sample Row Data segment: `length` octets of `line`, starting at pixel `offset`.
+    struct srd_t
+    {
+        uint16_t line;
+        uint16_t offset;
+        uint16_t length;
+    };
+
+    struct packet_layout_t
+    {
+        std::array<srd_t, max_srds_per_packet> srds;
+        uint8_t srd_count;
+        /// Payload size, excluding the RTP header.
+        uint16_t payload_octets;
+    };
+
+    /// Packet layout of a whole frame. Computed once per caps and reused for every frame.
+    struct frame_layout_t
+    {
+        uint32_t width;
+        uint32_t height;
+        packing_mode_t mode;
+        std::vector<packet_layout_t> packets;
+    };
+
+    /// Lays out a 4:2:2 10-bit frame into packets whose payload does not exceed `max_payload_octets`.
+    bisect::expected<frame_layout_t> plan_frame(uint32_t width, uint32_t height, packing_mode_t mode,
+                                                size_t max_payload_octets) noexcept;
+
+    /// Writes the RFC 4175 payload header (extended sequence number and SRD headers) of `packet` to `dst`.
+    /// Returns the number of octets written.
+    size_t write_payload_header(const packet_layout_t& packet, uint16_t extended_sequence_number,
+                                uint8_t* dst) noexcept;
+} // namespace bisect::rtp
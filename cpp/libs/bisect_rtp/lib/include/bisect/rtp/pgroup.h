@@ -0,0 +1,63 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bisect::rtp
+{
+    /// Instruction set used by the pixel kernels.
+    enum class isa_t
+    {
+        scalar,
+        sse4,
+        avx2,
+    };
+
+    /// Best instruction set supported by the running CPU. Detected once and cached.
+    isa_t detect_isa() noexcept;
+
+    /// Source layouts accepted by the 4:2:2 10-bit pgroup packer.
+    enum class pixel_layout_t
+    {
+        /// GStreamer UYVP, which is already the ST 2110-20 pgroup layout.
+        uyvp,
+        /// 6 pixels in 4 little-endian 32-bit words.
+        v210,
+        /// Planar Y, Cb and Cr, one little-endian 16-bit word per sample.
+        i422_10le,
+    };
+
+    /// A 4:2:2 10-bit pgroup carries 2 pixels in 5 octets.
+    constexpr size_t pgroup_octets = 5;
+    constexpr size_t pgroup_pixels = 2;
+
+    /// Read-only view over one video frame in memory.
+    struct frame_view_t
+    {
+        pixel_layout_t layout;
+        const uint8_t* planes[3];
+        size_t strides[3];
+    };
+
+    /// Packs `count` pixels of `line`, starting at pixel `offset`, as ST 2110-20 pgroups into `dst`.
+    /// `offset` and `count` must be multiples of pgroup_pixels; `dst` must hold count / 2 * 5 octets.
+    void pack_pgroups(const frame_view_t& frame, size_t line, size_t offset, size_t count, uint8_t* dst,
+                      isa_t isa) noexcept;
+
+    /// As above, using detect_isa().
+    void pack_pgroups(const frame_view_t& frame, size_t line, size_t offset, size_t count, uint8_t* dst) noexcept;
+} // namespace bisect::rtp
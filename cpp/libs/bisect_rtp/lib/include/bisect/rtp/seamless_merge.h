@@ -0,0 +1,83 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace bisect::rtp
+{
+    struct merge_leg_counters_t
+    {
+        uint64_t received = 0;
+        /// Packets whose copy from this leg was the one forwarded.
+        uint64_t forwarded = 0;
+        /// Packets dropped because the other leg, or this one, had already delivered them.
+        uint64_t duplicates = 0;
+        /// Packets that arrived after their sequence number had left the window.
+        uint64_t late = 0;
+        /// Sequence numbers that left the window without arriving on this leg.
+        uint64_t lost = 0;
+    };
+
+    struct merge_counters_t
+    {
+        std::array<merge_leg_counters_t, 2> legs;
+        uint64_t forwarded = 0;
+        /// Sequence numbers that left the window without arriving on either leg.
+        uint64_t lost = 0;
+        /// Times the window restarted because a leg jumped far behind it, e.g. when the sender restarted.
+        uint64_t resyncs = 0;
+    };
+
+    /// SMPTE 2022-7 seamless protection: merges the packets of two legs carrying the same RTP stream into one,
+    /// keeping the first copy of each sequence number. State is a fixed window of the most recent sequence
+    /// numbers, so the legs may be skewed by up to the window size. Not thread safe.
+    class seamless_merge_t
+    {
+      public:
+        static constexpr size_t leg_count = 2;
+
+        /// `window` must be a power of two between 2 and 32768.
+        static expected<seamless_merge_t> create(uint32_t window) noexcept;
+
+        /// Records `seqnum` arriving on `leg`. Returns true if this is the copy to forward.
+        bool accept(size_t leg, uint16_t seqnum) noexcept;
+
+        /// Forgets the window, e.g. after a flush. Keeps the counters.
+        void reset() noexcept;
+
+        uint32_t window() const noexcept { return static_cast<uint32_t>(slots_.size()); }
+        const merge_counters_t& counters() const noexcept { return counters_; }
+
+      private:
+        explicit seamless_merge_t(uint32_t window);
+
+        void restart(uint16_t seqnum) noexcept;
+        void retire(uint8_t slot) noexcept;
+        void advance(uint16_t seqnum) noexcept;
+
+        // Per sequence number: one bit per leg that delivered it, and whether it is inside the window.
+        std::vector<uint8_t> slots_;
+        bool started_     = false;
+        uint16_t highest_ = 0;
+        // Consecutive packets behind the window: too many means the stream restarted.
+        uint32_t behind_ = 0;
+
+        merge_counters_t counters_;
+    };
+} // namespace bisect::rtp
@@ -0,0 +1,66 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace bisect::rtp
+{
+    /// Fixed-size queue handing values from one producer thread to one consumer thread without locks.
+    /// push() is only called by the producer and pop() only by the consumer; neither blocks nor allocates.
+    template <typename T, size_t Capacity> class spsc_queue_t
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+      public:
+        /// Returns false, dropping `value`, if the queue is full.
+        bool push(T value) noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            if(tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+
+            slots_[tail & (Capacity - 1)] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            if(head == tail_.load(std::memory_order_acquire)) return std::nullopt;
+
+            std::optional<T> value(std::move(slots_[head & (Capacity - 1)]));
+            head_.store(head + 1, std::memory_order_release);
+            return value;
+        }
+
+        /// Consumer only: whether a pop() would return nothing.
+        bool empty() const noexcept
+        {
+            return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+        }
+
+      private:
+        // On separate cache lines, so the two threads don't invalidate each other's index.
+        alignas(64) std::atomic<size_t> head_ = 0;
+        alignas(64) std::atomic<size_t> tail_ = 0;
+        std::array<T, Capacity> slots_{};
+    };
+} // namespace bisect::rtp
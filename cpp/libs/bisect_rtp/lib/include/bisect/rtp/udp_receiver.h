@@ -0,0 +1,89 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bisect::rtp
+{
+    struct udp_receiver_settings_t
+    {
+        /// Multicast group to join, or a local address to bind to. Empty or "0.0.0.0" binds to any address.
+        std::string address{};
+        uint16_t port = 0;
+        /// Only accept the group's datagrams from this source (source-specific multicast). Empty accepts any source.
+        std::string source_address{};
+        /// Interface to join the multicast group on, by name. Ignored if empty.
+        std::string interface_name{};
+        /// Interface to join the multicast group on, by address. Used if interface_name is empty or unknown.
+        std::string interface_address{};
+        /// Maximum number of datagrams read by one recvmmsg call.
+        size_t batch_size = 64;
+        /// SO_RCVBUF in octets. 0 keeps the system default.
+        int receive_buffer_size = 0;
+    };
+
+    struct datagram_info_t
+    {
+        uint32_t size;
+        bool truncated;
+        /// Kernel receive time (SO_TIMESTAMPNS, CLOCK_REALTIME) in ns, or 0 if not available.
+        int64_t timestamp_ns;
+    };
+
+    /// Receives UDP datagrams in batches with recvmmsg, recording the kernel receive timestamp of each one.
+    /// The receive slots are supplied by the caller, so datagrams can land directly in pooled buffers.
+    class udp_batch_receiver_t
+    {
+      public:
+        static expected<std::unique_ptr<udp_batch_receiver_t>>
+        create(const udp_receiver_settings_t& settings) noexcept;
+
+        ~udp_batch_receiver_t();
+        udp_batch_receiver_t(const udp_batch_receiver_t&)            = delete;
+        udp_batch_receiver_t& operator=(const udp_batch_receiver_t&) = delete;
+
+        /// Waits up to `timeout_ms` (-1 for no limit) for data, then reads up to min(slots, batch size) datagrams,
+        /// one per slot. Returns an empty span on timeout or after interrupt().
+        expected<std::span<const datagram_info_t>> receive(std::span<const iovec> slots, int timeout_ms) noexcept;
+
+        /// Wakes up a blocked receive() from another thread. Stays signalled until clear_interrupt().
+        void interrupt() noexcept;
+        void clear_interrupt() noexcept;
+
+        size_t batch_size() const noexcept { return messages_.size(); }
+        /// Local port, useful when binding to port 0.
+        uint16_t port() const noexcept;
+
+      private:
+        udp_batch_receiver_t(int fd, int wakeup_fd, size_t batch_size);
+
+        int fd_;
+        int wakeup_fd_;
+
+        std::vector<mmsghdr> messages_;
+        std::vector<uint64_t> control_; // one SCM_TIMESTAMPNS cmsg per message, 8-octet aligned
+        std::vector<datagram_info_t> received_;
+    };
+
+    using udp_batch_receiver_uptr = std::unique_ptr<udp_batch_receiver_t>;
+} // namespace bisect::rtp
@@ -0,0 +1,98 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bisect::rtp
+{
+    constexpr size_t default_batch_size = 64;
+
+    struct udp_sender_settings_t
+    {
+        std::string destination_address{};
+        uint16_t destination_port = 0;
+        /// Egress interface for multicast destinations. Ignored if empty.
+        std::string interface_name{};
+        /// Local address to bind to. Ignored if empty.
+        std::string source_address{};
+        int multicast_ttl = 64;
+        /// Maximum number of datagrams handed to the kernel by one sendmmsg call.
+        size_t batch_size = default_batch_size;
+        /// Coalesce runs of equal-sized datagrams with UDP_SEGMENT. Falls back to plain batching if the kernel
+        /// does not support it.
+        bool gso = false;
+    };
+
+    /// Sends UDP datagrams in batches with sendmmsg, optionally using UDP generic segmentation offload.
+    /// Datagrams are queued by reference: the memory passed to queue() must stay valid until flush() returns.
+    class udp_batch_sender_t
+    {
+      public:
+        static expected<std::unique_ptr<udp_batch_sender_t>> create(const udp_sender_settings_t& settings) noexcept;
+
+        ~udp_batch_sender_t();
+        udp_batch_sender_t(const udp_batch_sender_t&)            = delete;
+        udp_batch_sender_t& operator=(const udp_batch_sender_t&) = delete;
+
+        /// Queues one datagram gathered from `parts`. Sends the pending batch first if it is full.
+        maybe_ok queue(std::span<const iovec> parts) noexcept;
+
+        /// Sends every queued datagram.
+        maybe_ok flush() noexcept;
+
+        bool gso_enabled() const noexcept { return gso_; }
+        uint64_t datagrams_sent() const noexcept { return datagrams_sent_; }
+        uint64_t send_calls() const noexcept { return send_calls_; }
+
+      private:
+        udp_batch_sender_t(int fd, const sockaddr_storage& destination, socklen_t destination_size, size_t batch_size,
+                           bool gso);
+
+        struct datagram_t
+        {
+            uint32_t first_iov;
+            uint32_t iov_count;
+            uint32_t size;
+        };
+
+        /// Fills messages_ from the queued datagrams starting at `first`; returns the number of messages.
+        size_t build_messages(size_t first) noexcept;
+
+        int fd_;
+        sockaddr_storage destination_;
+        socklen_t destination_size_;
+        size_t batch_size_;
+        bool gso_;
+
+        std::vector<iovec> iovs_;
+        std::vector<datagram_t> datagrams_;
+        std::vector<mmsghdr> messages_;
+        std::vector<uint32_t> message_datagrams_; // datagrams carried by each message
+        std::vector<uint64_t> control_;           // one UDP_SEGMENT cmsg per message, 8-octet aligned
+
+        uint64_t datagrams_sent_ = 0;
+        uint64_t send_calls_     = 0;
+    };
+
+    using udp_batch_sender_uptr = std::unique_ptr<udp_batch_sender_t>;
+} // namespace bisect::rtp
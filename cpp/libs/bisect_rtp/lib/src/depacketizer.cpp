@@ -0,0 +1,103 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/depacketizer.h"
+#include "bisect/rtp/packetizer.h"
+#include "bisect/rtp/pgroup.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+using namespace bisect::rtp;
+
+frame_assembler_t::frame_assembler_t(uint32_t width, uint32_t height)
+    : width_(width), height_(height), line_octets_(width / pgroup_pixels * pgroup_octets),
+      line_pgroups_(width / pgroup_pixels), line_words_((line_pgroups_ + 63) / 64), line_fill_(height),
+      received_(height * line_words_), line_done_((height + 63) / 64)
+{
+}
+
+void frame_assembler_t::begin(uint8_t* frame, size_t stride) noexcept
+{
+    frame_          = frame;
+    stride_         = stride;
+    complete_lines_ = 0;
+    std::fill(line_fill_.begin(), line_fill_.end(), 0);
+    std::fill(received_.begin(), received_.end(), 0);
+    std::fill(line_done_.begin(), line_done_.end(), 0);
+}
+
+bool frame_assembler_t::is_line_complete(uint32_t line) const noexcept
+{
+    return line < height_ && (line_done_[line / 64] >> (line % 64)) & 1;
+}
+
+uint32_t frame_assembler_t::mark_received(uint32_t line, size_t first, size_t count) noexcept
+{
+    auto* words    = received_.data() + line * line_words_;
+    uint32_t added = 0;
+    for(auto pgroup = first; pgroup < first + count;)
+    {
+        const auto bit  = pgroup % 64;
+        const auto bits = std::min(64 - bit, first + count - pgroup);
+        const auto mask = (bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1) << bit;
+        auto& word      = words[pgroup / 64];
+        added += static_cast<uint32_t>(std::popcount(mask & ~word));
+        word |= mask;
+        pgroup += bits;
+    }
+    return added;
+}
+
+bool frame_assembler_t::add_payload(const uint8_t* payload, size_t size) noexcept
+{
+    if(frame_ == nullptr || size < payload_header_octets + srd_header_octets) return false;
+
+    // The SRD headers are all at the front of the payload; the sample data follows in the same order.
+    const auto* srd     = payload + payload_header_octets;
+    const auto* end     = payload + size;
+    const auto* headers = srd;
+    for(bool more = true; more; headers += srd_header_octets)
+    {
+        if(headers + srd_header_octets > end) return false;
+        more = (headers[4] & 0x80) != 0;
+    }
+
+    const auto* data = headers;
+    for(const auto* h = srd; h < headers; h += srd_header_octets)
+    {
+        const size_t length = (size_t(h[0]) << 8) | h[1];
+        const uint32_t line = (uint32_t(h[2] & 0x7f) << 8) | h[3];
+        const size_t offset = ((size_t(h[4] & 0x7f) << 8) | h[5]) / pgroup_pixels * pgroup_octets;
+
+        if(line >= height_ || offset + length > line_octets_ || data + length > end) return false;
+
+        std::memcpy(frame_ + line * stride_ + offset, data, length);
+        data += length;
+
+        // Retransmitted or duplicated segments only add the pgroups the line did not have yet.
+        auto& fill = line_fill_[line];
+        if(fill < line_pgroups_)
+        {
+            fill += mark_received(line, offset / pgroup_octets, length / pgroup_octets);
+            if(fill == line_pgroups_)
+            {
+                line_done_[line / 64] |= uint64_t{1} << (line % 64);
+                ++complete_lines_;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/elements.h"
+#include "st2022_7_merge.h"
+#include "st2110_20_depay.h"
+#include "st2110_20_pay.h"
+#include "udp_batch_sink.h"
+#include "udp_batch_src.h"
+
+namespace
+{
+    // Each of the nmos plugins links its own copy of this library, so a second copy loaded in the same process finds
+    // the factories, or at least the type names, registered by the first. Registering them again would fail.
+    bool register_once(GstPlugin* plugin, const char* factory_name, const char* type_name, GType (*get_type)())
+    {
+        if(auto* factory = gst_element_factory_find(factory_name); factory != nullptr)
+        {
+            gst_object_unref(factory);
+            return true;
+        }
+
+        const auto type = g_type_from_name(type_name);
+        return gst_element_register(plugin, factory_name, GST_RANK_NONE, type != 0 ? type : get_type());
+    }
+} // namespace
+
+bool bisect::rtp::register_elements(GstPlugin* plugin) noexcept
+{
+    return register_once(plugin, st2110_20_pay_factory, "GstSt2110_20Pay", &gst_st2110_20_pay_get_type) &&
+           register_once(plugin, st2110_20_depay_factory, "GstSt2110_20Depay", &gst_st2110_20_depay_get_type) &&
+           register_once(plugin, udp_batch_sink_factory, "GstUdpBatchSink", &gst_udp_batch_sink_get_type) &&
+           register_once(plugin, udp_batch_src_factory, "GstUdpBatchSrc", &gst_udp_batch_src_get_type) &&
+           register_once(plugin, st2022_7_merge_factory, "GstSt2022_7Merge", &gst_st2022_7_merge_get_type);
+}
+
+const char* bisect::rtp::raw_video_depay_factory(std::string_view sampling, int depth) noexcept
+{
+    return sampling == "YCbCr-4:2:2" && depth == 10 ? st2110_20_depay_factory : "rtpvrawdepay";
+}
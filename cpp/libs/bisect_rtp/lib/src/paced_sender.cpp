@@ -0,0 +1,257 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/paced_sender.h"
+#include "bisect/expected/macros.h"
+#include <algorithm>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr int64_t ns_per_second = 1'000'000'000;
+
+    void release(paced_frame_t& frame)
+    {
+        if(frame.release) frame.release();
+        frame.release = nullptr;
+    }
+} // namespace
+
+expected<paced_sender_uptr> paced_sender_t::create(const udp_sender_settings_t& network,
+                                                   const pacing_settings_t& pacing) noexcept
+{
+    BST_ENFORCE(pacing.max_queued_frames > 0, "at least one frame must be queueable");
+    BST_CHECK(pacing_schedule_t::create(pacing.timing, 1, pacing.type));
+
+    BST_ASSIGN_MUT(sender, udp_batch_sender_t::create(network));
+    return paced_sender_uptr(new paced_sender_t(std::move(sender), pacing));
+}
+
+paced_sender_t::paced_sender_t(udp_batch_sender_uptr sender, const pacing_settings_t& pacing)
+    : sender_(std::move(sender)), pacing_(pacing), thread_([this] { run(); })
+{
+}
+
+paced_sender_t::~paced_sender_t()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+
+    for(auto& frame : frames_)
+    {
+        release(frame);
+    }
+}
+
+maybe_ok paced_sender_t::send_frame(paced_frame_t frame) noexcept
+{
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [this] { return flushing_ || error_ || frames_.size() < pacing_.max_queued_frames; });
+
+    if(error_)
+    {
+        const auto error = std::move(*error_);
+        error_.reset();
+        lock.unlock();
+        release(frame);
+        return std::unexpected(error);
+    }
+
+    if(flushing_)
+    {
+        lock.unlock();
+        release(frame);
+        return {};
+    }
+
+    frames_.push_back(std::move(frame));
+    ++queued_frames_;
+    lock.unlock();
+    changed_.notify_all();
+    return {};
+}
+
+maybe_ok paced_sender_t::retarget(const udp_sender_settings_t& network) noexcept
+{
+    BST_ASSIGN_MUT(sender, udp_batch_sender_t::create(network));
+
+    // The pacing thread switches when it takes the first frame queued after this call, between two frames.
+    std::lock_guard lock(mutex_);
+    retargets_.push_back({queued_frames_, std::move(sender)});
+    return {};
+}
+
+void paced_sender_t::set_flushing(bool flushing) noexcept
+{
+    std::deque<paced_frame_t> dropped;
+    {
+        std::lock_guard lock(mutex_);
+        flushing_ = flushing;
+        if(flushing) dropped.swap(frames_);
+        taken_frames_ += dropped.size();
+    }
+    changed_.notify_all();
+
+    for(auto& frame : dropped)
+    {
+        release(frame);
+    }
+}
+
+void paced_sender_t::drain() noexcept
+{
+    std::unique_lock lock(mutex_);
+    changed_.wait(lock, [this] { return frames_.empty() && !sending_; });
+}
+
+pacing_counters_t paced_sender_t::counters() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return counters_;
+}
+
+std::optional<pacing_schedule_t> paced_sender_t::schedule() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return schedule_;
+}
+
+void paced_sender_t::run() noexcept
+{
+    for(;;)
+    {
+        paced_frame_t frame;
+        udp_batch_sender_uptr sender;
+        {
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [this] { return stopping_ || !frames_.empty(); });
+            if(stopping_) return;
+
+            while(!retargets_.empty() && retargets_.front().at_frame <= taken_frames_)
+            {
+                sender = std::move(retargets_.front().sender);
+                retargets_.pop_front();
+            }
+            frame = std::move(frames_.front());
+            frames_.pop_front();
+            ++taken_frames_;
+            sending_ = true;
+        }
+        changed_.notify_all();
+
+        if(sender) sender_ = std::move(sender);
+
+        auto result = send_paced(frame);
+        release(frame);
+
+        {
+            std::lock_guard lock(mutex_);
+            sending_ = false;
+            if(!result.has_value() && !error_) error_ = std::move(result.error());
+            if(monitor_)
+            {
+                counters_ = monitor_->counters();
+                schedule_ = monitor_->schedule();
+            }
+        }
+        changed_.notify_all();
+    }
+}
+
+maybe_ok paced_sender_t::send_paced(paced_frame_t& frame) noexcept
+{
+    const auto packets = static_cast<uint32_t>(frame.packet_parts.size());
+    if(packets == 0) return {};
+
+    if(!monitor_ || monitor_->schedule().packets_per_frame() != packets)
+    {
+        BST_ASSIGN(schedule, pacing_schedule_t::create(pacing_.timing, packets, pacing_.type));
+        if(monitor_)
+        {
+            monitor_->set_schedule(schedule);
+        }
+        else
+        {
+            monitor_.emplace(schedule);
+        }
+    }
+    const auto& schedule = monitor_->schedule();
+
+    // The first grid slot whose first packet is still ahead of us, and never the slot of the previous frame.
+    auto index = schedule.frame_index_at_or_after(now() - schedule.packet_offset_ns(0));
+    if(last_frame_index_ >= 0)
+    {
+        if(index > last_frame_index_ + 1)
+        {
+            monitor_->counters().late_frames += static_cast<uint64_t>(index - last_frame_index_ - 1);
+        }
+        index = std::max(index, last_frame_index_ + 1);
+    }
+    last_frame_index_ = index;
+
+    const auto start = schedule.frame_start_ns(index);
+    monitor_->begin_frame(start);
+
+    size_t part = 0;
+    uint32_t k  = 0;
+    while(k < packets)
+    {
+        if(flushing_ || stopping_) return {};
+
+        wait_until(start + schedule.packet_offset_ns(k));
+        const auto t = now();
+
+        // Everything due by now leaves in a single sendmmsg call.
+        do
+        {
+            BST_CHECK(sender_->queue({&frame.parts[part], frame.packet_parts[k]}));
+            part += frame.packet_parts[k];
+            monitor_->packet_sent(t);
+            ++k;
+        } while(k < packets && start + schedule.packet_offset_ns(k) <= t);
+
+        BST_CHECK(sender_->flush());
+    }
+
+    return {};
+}
+
+int64_t paced_sender_t::now() const noexcept
+{
+    timespec ts;
+    clock_gettime(pacing_.clock, &ts);
+    return int64_t{ts.tv_sec} * ns_per_second + ts.tv_nsec;
+}
+
+void paced_sender_t::wait_until(int64_t t_ns) const noexcept
+{
+    for(;;)
+    {
+        const auto remaining = t_ns - now();
+        if(remaining <= 0) return;
+
+        if(remaining > pacing_.spin_ns)
+        {
+            const auto wake = t_ns - pacing_.spin_ns;
+            const timespec ts{.tv_sec = wake / ns_per_second, .tv_nsec = wake % ns_per_second};
+            clock_nanosleep(pacing_.clock, TIMER_ABSTIME, &ts, nullptr);
+        }
+    }
+}
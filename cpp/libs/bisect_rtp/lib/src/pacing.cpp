@@ -0,0 +1,178 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/pacing.h"
+#include "bisect/expected/macros.h"
+#include <algorithm>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+namespace
+{
+    __extension__ typedef __int128 int128_t;
+
+    constexpr int64_t ns_per_second = 1'000'000'000;
+
+    // ST 2110-21 timing is expressed in lines of a 1125-line raster: 1080 of them are active.
+    constexpr uint32_t total_lines  = 1125;
+    constexpr uint32_t active_lines = 1080;
+
+    // TRO_DEFAULT, in 1/1125 of TFRAME (28/750 for formats below 1080 lines is 42/1125).
+    uint32_t default_tro_lines(const video_timing_t& timing)
+    {
+        if(timing.interlaced) return 22;
+        return timing.height >= 1080 ? 43 : 42;
+    }
+
+    // floor(packets / (k × TFRAME)), with TFRAME = rate_den / rate_num seconds.
+    uint32_t packets_per_second_bound(const video_timing_t& timing, uint32_t packets, uint64_t k_num, uint64_t k_den)
+    {
+        const auto n = int128_t{packets} * timing.rate_num * k_den;
+        const auto d = int128_t{timing.rate_den} * k_num;
+        return static_cast<uint32_t>(n / d);
+    }
+} // namespace
+
+expected<pacing_schedule_t> pacing_schedule_t::create(const video_timing_t& timing, uint32_t packets_per_frame,
+                                                      pacing_type_t type) noexcept
+{
+    BST_ENFORCE(timing.rate_num > 0 && timing.rate_den > 0, "invalid frame rate {}/{}", timing.rate_num,
+                timing.rate_den);
+    BST_ENFORCE(packets_per_frame > 0, "a frame must have at least one packet");
+
+    pacing_schedule_t s;
+    s.timing_       = timing;
+    s.type_         = type;
+    s.packets_      = packets_per_frame;
+    s.fields_       = timing.interlaced ? 2 : 1;
+    s.per_field_    = (packets_per_frame + s.fields_ - 1) / s.fields_;
+    s.active_lines_ = type == pacing_type_t::narrow_linear ? total_lines : active_lines;
+    s.tro_lines_    = type == pacing_type_t::narrow_linear ? 0 : default_tro_lines(timing);
+
+    s.frame_ns_ = s.frame_start_ns(1);
+    s.trs_ns_   = static_cast<int64_t>(int128_t{timing.rate_den} * ns_per_second * s.active_lines_ /
+                                     (int128_t{timing.rate_num} * total_lines * s.fields_ * s.per_field_));
+    s.tro_ns_   = static_cast<int64_t>(int128_t{timing.rate_den} * ns_per_second * s.tro_lines_ /
+                                     (int128_t{timing.rate_num} * total_lines));
+
+    switch(type)
+    {
+    case pacing_type_t::narrow:
+        // CMAX = max(4, NPACKETS / (43200 × RACTIVE × TFRAME)), VRX_FULL = max(8, NPACKETS / (27000 × TFRAME))
+        s.cmax_ = std::max(4u, packets_per_second_bound(timing, packets_per_frame, 43200 * active_lines, total_lines));
+        s.vrx_full_ = std::max(8u, packets_per_second_bound(timing, packets_per_frame, 27000, 1));
+        break;
+    case pacing_type_t::narrow_linear:
+        s.cmax_     = std::max(4u, packets_per_second_bound(timing, packets_per_frame, 43200, 1));
+        s.vrx_full_ = std::max(8u, packets_per_second_bound(timing, packets_per_frame, 27000, 1));
+        break;
+    case pacing_type_t::wide:
+        // CMAX = max(16, NPACKETS / (21600 × TFRAME)), VRX_FULL = max(720, NPACKETS / (300 × TFRAME))
+        s.cmax_     = std::max(16u, packets_per_second_bound(timing, packets_per_frame, 21600, 1));
+        s.vrx_full_ = std::max(720u, packets_per_second_bound(timing, packets_per_frame, 300, 1));
+        break;
+    }
+
+    return s;
+}
+
+int64_t pacing_schedule_t::frame_start_ns(int64_t index) const noexcept
+{
+    return static_cast<int64_t>(int128_t{index} * timing_.rate_den * ns_per_second / timing_.rate_num);
+}
+
+int64_t pacing_schedule_t::frame_index_at_or_after(int64_t t_ns) const noexcept
+{
+    const auto d = int128_t{timing_.rate_den} * ns_per_second;
+    const auto n = int128_t{t_ns} * timing_.rate_num;
+    return static_cast<int64_t>(n > 0 ? (n + d - 1) / d : n / d);
+}
+
+int64_t pacing_schedule_t::packet_offset_ns(uint32_t packet) const noexcept
+{
+    const auto field = std::min(packet / per_field_, fields_ - 1);
+    const auto index = packet - field * per_field_;
+
+    // field × TFIELD + TRO + index × TRS, over a common denominator so that nothing is rounded but the result.
+    const auto units = int128_t{field} * total_lines * per_field_ + int128_t{tro_lines_} * fields_ * per_field_ +
+                       int128_t{index} * active_lines_;
+    return static_cast<int64_t>(units * timing_.rate_den * ns_per_second /
+                                (int128_t{timing_.rate_num} * total_lines * fields_ * per_field_));
+}
+
+conformance_monitor_t::conformance_monitor_t(const pacing_schedule_t& schedule) noexcept : schedule_(schedule)
+{
+    set_schedule(schedule);
+}
+
+void conformance_monitor_t::set_schedule(const pacing_schedule_t& schedule) noexcept
+{
+    schedule_  = schedule;
+    tdrain_ns_ = std::max<int64_t>(1, schedule.frame_ns() * 10 / (int64_t{schedule.packets_per_frame()} * 11));
+    bucket_    = 0;
+}
+
+void conformance_monitor_t::begin_frame(int64_t frame_start_ns) noexcept
+{
+    frame_start_ = frame_start_ns;
+    received_    = 0;
+    read_        = 0;
+    ++counters_.frames;
+}
+
+void conformance_monitor_t::packet_sent(int64_t t_ns) noexcept
+{
+    ++counters_.packets;
+
+    // Network compatibility model: Cinst is the bucket level once this packet is in.
+    if(bucket_ > 0)
+    {
+        const auto drained = static_cast<uint64_t>((t_ns - drain_since_) / tdrain_ns_);
+        if(drained >= bucket_)
+        {
+            bucket_ = 0;
+        }
+        else
+        {
+            bucket_ -= static_cast<uint32_t>(drained);
+            drain_since_ += static_cast<int64_t>(drained) * tdrain_ns_;
+        }
+    }
+    if(bucket_ == 0) drain_since_ = t_ns;
+    ++bucket_;
+
+    counters_.cinst_peak = std::max(counters_.cinst_peak, bucket_);
+    if(bucket_ > schedule_.cmax()) ++counters_.cmax_violations;
+
+    // Virtual receiver: reads packet k at its scheduled offset from the first read, which happens at TRO or, if the
+    // first packet is late, as soon as it arrives. A read that finds no packet stalls the reader.
+    const auto first_offset = schedule_.packet_offset_ns(0);
+    if(received_ == 0) read_start_ = std::max(frame_start_ + first_offset, t_ns);
+
+    const auto read_time = [&](uint32_t k) { return read_start_ + schedule_.packet_offset_ns(k) - first_offset; };
+    while(read_ < received_ && read_time(read_) < t_ns)
+    {
+        ++read_;
+    }
+    if(read_ == received_ && read_ < schedule_.packets_per_frame() && read_time(read_) < t_ns)
+    {
+        ++counters_.vrx_underflows;
+    }
+
+    ++received_;
+    const auto vrx     = received_ - read_;
+    counters_.vrx_peak = std::max(counters_.vrx_peak, vrx);
+    if(vrx > schedule_.vrx_full()) ++counters_.vrx_overflows;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/packetizer.h"
+#include "bisect/rtp/pgroup.h"
+#include "bisect/expected/macros.h"
+#include <algorithm>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+expected<frame_layout_t> rtp::plan_frame(uint32_t width, uint32_t height, packing_mode_t mode,
+                                         size_t max_payload_octets) noexcept
+{
+    BST_ENFORCE(width > 0 && height > 0, "invalid frame size {}x{}", width, height);
+    BST_ENFORCE(width % pgroup_pixels == 0, "width {} is not a multiple of the pgroup size", width);
+    BST_ENFORCE(height <= 0x8000 && width <= 0x8000, "frame size {}x{} exceeds the SRD fields", width, height);
+
+    const auto min_payload = payload_header_octets + srd_header_octets +
+                             (mode == packing_mode_t::bpm ? bpm_data_octets : pgroup_octets);
+    BST_ENFORCE(max_payload_octets >= min_payload, "maximum payload of {} octets is too small, {} needed",
+                max_payload_octets, min_payload);
+
+    const size_t line_octets = width / pgroup_pixels * pgroup_octets;
+
+    frame_layout_t layout{.width = width, .height = height, .mode = mode, .packets = {}};
+    layout.packets.reserve(height * line_octets / (max_payload_octets - min_payload + pgroup_octets) + height);
+
+    uint32_t line  = 0;
+    size_t offset  = 0; // in octets within the line
+    auto available = [&](const packet_layout_t& p, size_t data_octets) -> size_t {
+        // Space left for sample data if one more SRD header is added.
+        const auto headers = payload_header_octets + (p.srd_count + 1) * srd_header_octets;
+        if(mode == packing_mode_t::bpm)
+        {
+            return headers + bpm_data_octets <= max_payload_octets ? bpm_data_octets - data_octets : 0;
+        }
+        return max_payload_octets > headers + data_octets ? max_payload_octets - headers - data_octets : 0;
+    };
+
+    while(line < height)
+    {
+        packet_layout_t p{};
+        size_t data_octets = 0;
+
+        while(line < height && p.srd_count < max_srds_per_packet)
+        {
+            const auto room   = available(p, data_octets) / pgroup_octets * pgroup_octets;
+            const auto length = std::min(room, line_octets - offset);
+            if(length == 0) break;
+
+            p.srds[p.srd_count++] = {.line   = static_cast<uint16_t>(line),
+                                     .offset = static_cast<uint16_t>(offset / pgroup_octets * pgroup_pixels),
+                                     .length = static_cast<uint16_t>(length)};
+            data_octets += length;
+            offset += length;
+            if(offset == line_octets)
+            {
+                offset = 0;
+                ++line;
+            }
+        }
+
+        p.payload_octets =
+            static_cast<uint16_t>(payload_header_octets + p.srd_count * srd_header_octets + data_octets);
+        layout.packets.push_back(p);
+    }
+
+    return layout;
+}
+
+size_t rtp::write_payload_header(const packet_layout_t& packet, uint16_t extended_sequence_number,
+                                 uint8_t* dst) noexcept
+{
+    auto* out = dst;
+    *out++    = uint8_t(extended_sequence_number >> 8);
+    *out++    = uint8_t(extended_sequence_number);
+
+    for(uint8_t i = 0; i < packet.srd_count; ++i)
+    {
+        const auto& srd         = packet.srds[i];
+        const bool continuation = i + 1 < packet.srd_count;
+        *out++                  = uint8_t(srd.length >> 8);
+        *out++                  = uint8_t(srd.length);
+        *out++                  = uint8_t((srd.line >> 8) & 0x7f);
+        *out++                  = uint8_t(srd.line);
+        *out++                  = uint8_t(((srd.offset >> 8) & 0x7f) | (continuation ? 0x80 : 0));
+        *out++                  = uint8_t(srd.offset);
+    }
+
+    return static_cast<size_t>(out - dst);
+}
@@ -0,0 +1,248 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/pgroup.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BISECT_RTP_X86 1
+#endif
+
+using namespace bisect::rtp;
+
+namespace
+{
+    // v210 packs 6 pixels (12 samples) into 16 octets.
+    constexpr size_t v210_block_pixels = 6;
+    constexpr size_t v210_block_octets = 16;
+
+    // Writes the 4 samples of one pgroup (Cb, Y0, Cr, Y1) as a 40-bit big-endian bitstream.
+    inline void write_pgroup(uint8_t* dst, uint32_t cb, uint32_t y0, uint32_t cr, uint32_t y1) noexcept
+    {
+        const uint64_t v = (uint64_t(cb & 0x3ff) << 30) | (uint64_t(y0 & 0x3ff) << 20) | (uint64_t(cr & 0x3ff) << 10) |
+                           uint64_t(y1 & 0x3ff);
+        dst[0] = uint8_t(v >> 32);
+        dst[1] = uint8_t(v >> 24);
+        dst[2] = uint8_t(v >> 16);
+        dst[3] = uint8_t(v >> 8);
+        dst[4] = uint8_t(v);
+    }
+
+    inline uint16_t load_le16(const uint8_t* p) noexcept
+    {
+        return uint16_t(p[0] | (p[1] << 8));
+    }
+
+    inline uint32_t load_le32(const uint8_t* p) noexcept
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    // Sample `k` of a v210 line, counting Cb, Y, Cr, Y, ... from the start of the line.
+    inline uint32_t v210_sample(const uint8_t* line, size_t k) noexcept
+    {
+        const auto block = k / 12;
+        const auto j     = k % 12;
+        const auto word  = load_le32(line + block * v210_block_octets + (j / 3) * 4);
+        return (word >> ((j % 3) * 10)) & 0x3ff;
+    }
+
+    void pack_uyvp(const frame_view_t& frame, size_t line, size_t offset, size_t count, uint8_t* dst) noexcept
+    {
+        const auto* src = frame.planes[0] + line * frame.strides[0] + offset / pgroup_pixels * pgroup_octets;
+        std::memcpy(dst, src, count / pgroup_pixels * pgroup_octets);
+    }
+
+    void pack_v210_scalar(const uint8_t* src, size_t offset, size_t count, uint8_t* dst) noexcept
+    {
+        for(auto k = offset * 2; k < (offset + count) * 2; k += 4, dst += pgroup_octets)
+        {
+            write_pgroup(dst, v210_sample(src, k), v210_sample(src, k + 1), v210_sample(src, k + 2),
+                         v210_sample(src, k + 3));
+        }
+    }
+
+    void pack_i422_10le_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, size_t offset, size_t count,
+                               uint8_t* dst) noexcept
+    {
+        for(auto px = offset; px < offset + count; px += pgroup_pixels, dst += pgroup_octets)
+        {
+            const auto c = px / 2;
+            write_pgroup(dst, load_le16(u + c * 2), load_le16(y + px * 2), load_le16(v + c * 2),
+                         load_le16(y + px * 2 + 2));
+        }
+    }
+
+#if BISECT_RTP_X86
+    // The vector kernels below work on 16-bit samples already in pgroup order (Cb, Y0, Cr, Y1), four per 64-bit
+    // lane. madd folds each sample pair into a 20-bit value, the two halves are then merged into the 40-bit pgroup
+    // and a byte shuffle emits it big-endian. Each 128-bit lane yields 10 valid octets but is stored as 16, so the
+    // callers only run the vector loop while the overhang still lands inside `dst`.
+
+    __attribute__((target("sse4.1"))) inline __m128i pgroups_from_samples_sse4(__m128i samples) noexcept
+    {
+        const auto s = _mm_and_si128(samples, _mm_set1_epi16(0x3ff));
+        const auto m = _mm_madd_epi16(s, _mm_set1_epi32(0x00010400));
+        const auto v = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(m, _mm_set1_epi64x(0xffffffff)), 20),
+                                    _mm_srli_epi64(m, 32));
+        return _mm_shuffle_epi8(v, _mm_setr_epi8(4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i pgroups_from_samples_avx2(__m256i samples) noexcept
+    {
+        const auto s = _mm256_and_si256(samples, _mm256_set1_epi16(0x3ff));
+        const auto m = _mm256_madd_epi16(s, _mm256_set1_epi32(0x00010400));
+        const auto v = _mm256_or_si256(_mm256_slli_epi64(_mm256_and_si256(m, _mm256_set1_epi64x(0xffffffff)), 20),
+                                       _mm256_srli_epi64(m, 32));
+        return _mm256_shuffle_epi8(v, _mm256_setr_epi8(4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1, 4, 3,
+                                                       2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1));
+    }
+
+    __attribute__((target("sse4.1"))) void pack_i422_10le_sse4(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                                               size_t offset, size_t count, uint8_t* dst) noexcept
+    {
+        // 8 pixels -> 4 pgroups -> 20 octets per iteration, with a 6 octet overhang on the last store.
+        constexpr size_t step = 8;
+        size_t px             = offset;
+        for(; px + step + 2 * pgroup_pixels <= offset + count; px += step, dst += 4 * pgroup_octets)
+        {
+            const auto yy   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + px * 2));
+            const auto uu   = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + px));
+            const auto vv   = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + px));
+            const auto cbcr = _mm_unpacklo_epi16(uu, vv);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                             pgroups_from_samples_sse4(_mm_unpacklo_epi16(cbcr, yy)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pgroup_octets),
+                             pgroups_from_samples_sse4(_mm_unpackhi_epi16(cbcr, yy)));
+        }
+        pack_i422_10le_scalar(y, u, v, px, offset + count - px, dst);
+    }
+
+    __attribute__((target("avx2"))) void pack_i422_10le_avx2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                                             size_t offset, size_t count, uint8_t* dst) noexcept
+    {
+        // 16 pixels -> 8 pgroups -> 40 octets per iteration, with a 6 octet overhang on the last store.
+        constexpr size_t step = 16;
+        size_t px             = offset;
+        for(; px + step + 2 * pgroup_pixels <= offset + count; px += step, dst += 8 * pgroup_octets)
+        {
+            const auto y0      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + px * 2));
+            const auto y1      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + px * 2 + 16));
+            const auto uu      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + px));
+            const auto vv      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + px));
+            const auto cbcr_lo = _mm_unpacklo_epi16(uu, vv);
+            const auto cbcr_hi = _mm_unpackhi_epi16(uu, vv);
+
+            const auto a = pgroups_from_samples_avx2(
+                _mm256_set_m128i(_mm_unpackhi_epi16(cbcr_lo, y0), _mm_unpacklo_epi16(cbcr_lo, y0)));
+            const auto b = pgroups_from_samples_avx2(
+                _mm256_set_m128i(_mm_unpackhi_epi16(cbcr_hi, y1), _mm_unpacklo_epi16(cbcr_hi, y1)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(a));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pgroup_octets), _mm256_extracti128_si256(a, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * pgroup_octets), _mm256_castsi256_si128(b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 6 * pgroup_octets), _mm256_extracti128_si256(b, 1));
+        }
+        pack_i422_10le_scalar(y, u, v, px, offset + count - px, dst);
+    }
+
+    __attribute__((target("sse4.1"))) void pack_v210_sse4(const uint8_t* src, size_t offset, size_t count,
+                                                          uint8_t* dst) noexcept
+    {
+        // Scalar head up to the next v210 block boundary.
+        auto head = (v210_block_pixels - offset % v210_block_pixels) % v210_block_pixels;
+        if(head > count) head = count;
+        pack_v210_scalar(src, offset, head, dst);
+        dst += head / pgroup_pixels * pgroup_octets;
+
+        // One v210 block -> 3 pgroups -> 15 octets per iteration, with a 11 octet overhang on the last store.
+        size_t px = offset + head;
+        for(; px + 2 * v210_block_pixels <= offset + count; px += v210_block_pixels, dst += 3 * pgroup_octets)
+        {
+            const auto w  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + px / v210_block_pixels * 16));
+            const auto m  = _mm_set1_epi32(0x3ff);
+            const auto a  = _mm_and_si128(w, m);
+            const auto b  = _mm_and_si128(_mm_srli_epi32(w, 10), m);
+            const auto c  = _mm_and_si128(_mm_srli_epi32(w, 20), m);
+            const auto ab = _mm_packus_epi32(a, b); // a0 a1 a2 a3 b0 b1 b2 b3
+            const auto cc = _mm_packus_epi32(c, c); // c0 c1 c2 c3 ...
+
+            // Samples in line order are a0 b0 c0 a1 b1 c1 a2 b2 | c2 a3 b3 c3.
+            const auto s0 = _mm_or_si128(
+                _mm_shuffle_epi8(ab, _mm_setr_epi8(0, 1, 8, 9, -1, -1, 2, 3, 10, 11, -1, -1, 4, 5, 12, 13)),
+                _mm_shuffle_epi8(cc, _mm_setr_epi8(-1, -1, -1, -1, 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1)));
+            const auto s1 = _mm_or_si128(
+                _mm_shuffle_epi8(ab, _mm_setr_epi8(-1, -1, 6, 7, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(cc, _mm_setr_epi8(4, 5, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pgroups_from_samples_sse4(s0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * pgroup_octets), pgroups_from_samples_sse4(s1));
+        }
+        pack_v210_scalar(src, px, offset + count - px, dst);
+    }
+
+    isa_t do_detect_isa() noexcept
+    {
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return isa_t::avx2;
+        if(__builtin_cpu_supports("sse4.1")) return isa_t::sse4;
+        return isa_t::scalar;
+    }
+#else
+    isa_t do_detect_isa() noexcept
+    {
+        return isa_t::scalar;
+    }
+#endif
+} // namespace
+
+isa_t bisect::rtp::detect_isa() noexcept
+{
+    static const auto isa = do_detect_isa();
+    return isa;
+}
+
+void bisect::rtp::pack_pgroups(const frame_view_t& frame, size_t line, size_t offset, size_t count, uint8_t* dst,
+                               isa_t isa) noexcept
+{
+    switch(frame.layout)
+    {
+    case pixel_layout_t::uyvp: pack_uyvp(frame, line, offset, count, dst); return;
+    case pixel_layout_t::v210: {
+        const auto* src = frame.planes[0] + line * frame.strides[0];
+#if BISECT_RTP_X86
+        // v210 is bound by the unpack shuffles rather than the pgroup stores, so AVX2 reuses the SSE4 kernel.
+        if(isa != isa_t::scalar) return pack_v210_sse4(src, offset, count, dst);
+#endif
+        return pack_v210_scalar(src, offset, count, dst);
+    }
+    case pixel_layout_t::i422_10le: {
+        const auto* y = frame.planes[0] + line * frame.strides[0];
+        const auto* u = frame.planes[1] + line * frame.strides[1];
+        const auto* v = frame.planes[2] + line * frame.strides[2];
+#if BISECT_RTP_X86
+        if(isa == isa_t::avx2) return pack_i422_10le_avx2(y, u, v, offset, count, dst);
+        if(isa == isa_t::sse4) return pack_i422_10le_sse4(y, u, v, offset, count, dst);
+#endif
+        return pack_i422_10le_scalar(y, u, v, offset, count, dst);
+    }
+    }
+}
+
+void bisect::rtp::pack_pgroups(const frame_view_t& frame, size_t line, size_t offset, size_t count,
+                               uint8_t* dst) noexcept
+{
+    pack_pgroups(frame, line, offset, count, dst, detect_isa());
+}
@@ -0,0 +1,138 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/seamless_merge.h"
+#include "bisect/expected/macros.h"
+#include <algorithm>
+#include <bit>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr uint8_t in_window = 0x80;
+
+    constexpr uint8_t leg_bit(size_t leg)
+    {
+        return static_cast<uint8_t>(1u << leg);
+    }
+} // namespace
+
+expected<seamless_merge_t> seamless_merge_t::create(uint32_t window) noexcept
+{
+    BST_ENFORCE(window >= 2 && window <= 32768 && std::has_single_bit(window),
+                "merge window must be a power of two between 2 and 32768, got {}", window);
+    return seamless_merge_t(window);
+}
+
+seamless_merge_t::seamless_merge_t(uint32_t window) : slots_(window, 0)
+{
+}
+
+bool seamless_merge_t::accept(size_t leg, uint16_t seqnum) noexcept
+{
+    auto& counters = counters_.legs[leg];
+    ++counters.received;
+
+    if(!started_)
+    {
+        restart(seqnum);
+    }
+    else if(const auto delta = static_cast<int16_t>(static_cast<uint16_t>(seqnum - highest_)); delta > 0)
+    {
+        advance(seqnum);
+    }
+    else if(-delta >= static_cast<int32_t>(slots_.size()))
+    {
+        // A whole window or more behind the newest sequence number, in RTP wrap-around arithmetic.
+        if(++behind_ <= slots_.size())
+        {
+            ++counters.late;
+            return false;
+        }
+
+        // A whole window of packets behind it: the stream restarted rather than a leg lagging.
+        ++counters_.resyncs;
+        restart(seqnum);
+    }
+    behind_ = 0;
+
+    auto& slot = slots_[size_t{seqnum} & (slots_.size() - 1)];
+    if((slot & ~in_window) != 0)
+    {
+        slot |= leg_bit(leg);
+        ++counters.duplicates;
+        return false;
+    }
+
+    slot |= leg_bit(leg);
+    ++counters.forwarded;
+    ++counters_.forwarded;
+    return true;
+}
+
+void seamless_merge_t::reset() noexcept
+{
+    std::fill(slots_.begin(), slots_.end(), uint8_t{0});
+    started_ = false;
+    behind_  = 0;
+}
+
+void seamless_merge_t::restart(uint16_t seqnum) noexcept
+{
+    std::fill(slots_.begin(), slots_.end(), uint8_t{0});
+    started_ = true;
+    highest_ = static_cast<uint16_t>(seqnum - 1);
+    advance(seqnum);
+}
+
+void seamless_merge_t::retire(uint8_t slot) noexcept
+{
+    if((slot & in_window) == 0) return;
+
+    for(size_t leg = 0; leg < leg_count; ++leg)
+    {
+        if((slot & leg_bit(leg)) == 0) ++counters_.legs[leg].lost;
+    }
+    if((slot & ~in_window) == 0) ++counters_.lost;
+}
+
+void seamless_merge_t::advance(uint16_t seqnum) noexcept
+{
+    const auto mask     = slots_.size() - 1;
+    const uint32_t step = static_cast<uint16_t>(seqnum - highest_);
+
+    // Sequence numbers skipped entirely past the window never arrived on either leg.
+    if(step > slots_.size())
+    {
+        const auto skipped = step - slots_.size();
+        for(auto& counters : counters_.legs)
+        {
+            counters.lost += skipped;
+        }
+        counters_.lost += skipped;
+    }
+
+    // Each slot entering the window at the front pushes out the one a window behind it.
+    const auto entering = std::min<size_t>(step, slots_.size());
+    for(size_t i = 0; i < entering; ++i)
+    {
+        auto& slot = slots_[(size_t{seqnum} - i) & mask];
+        retire(slot);
+        slot = in_window;
+    }
+
+    highest_ = seqnum;
+}
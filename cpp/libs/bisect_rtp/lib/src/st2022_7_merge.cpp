@@ -0,0 +1,334 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "st2022_7_merge.h"
+#include "bisect/rtp/seamless_merge.h"
+#include <array>
+#include <mutex>
+#include <optional>
+#include <string>
+
+using namespace bisect::rtp;
+
+GST_DEBUG_CATEGORY_STATIC(gst_st2022_7_merge_debug_category);
+#define GST_CAT_DEFAULT gst_st2022_7_merge_debug_category
+
+namespace
+{
+    // 4096 packets is about 16 ms of 1080p59.94 video, and more for anything smaller.
+    constexpr guint default_window = 4096;
+
+    struct merge_state_t
+    {
+        // Serialises the two legs, each pushed from its own source thread, onto the single source pad. Held while
+        // pushing, so it is never taken to read the properties.
+        std::mutex stream_mutex;
+        // Guards the merge and the counters. Never held while pushing, so reading the stats does not wait for a
+        // stalled downstream.
+        std::mutex mutex;
+        guint window = default_window;
+        std::optional<seamless_merge_t> merge;
+        std::array<bool, seamless_merge_t::leg_count> eos{};
+        guint64 packets_invalid = 0;
+    };
+
+    enum class PropertyId : uint32_t
+    {
+        Window = 1,
+        Stats  = 2,
+    };
+
+    std::optional<uint16_t> read_seqnum(GstBuffer* buffer)
+    {
+        std::array<uint8_t, 4> header;
+        if(gst_buffer_extract(buffer, 0, header.data(), header.size()) != header.size()) return std::nullopt;
+        if((header[0] >> 6) != 2) return std::nullopt;
+        return static_cast<uint16_t>(header[2] << 8 | header[3]);
+    }
+
+    bool accept(merge_state_t& s, size_t leg, GstBuffer* buffer)
+    {
+        const auto seqnum = read_seqnum(buffer);
+        if(!seqnum.has_value())
+        {
+            ++s.packets_invalid;
+            return false;
+        }
+        return s.merge->accept(leg, *seqnum);
+    }
+
+    void add_leg_counters(GstStructure* stats, const char* leg, const merge_leg_counters_t& c)
+    {
+        const auto field = [leg](const char* name) { return std::string(leg) + "-" + name; };
+        gst_structure_set(stats, field("received").c_str(), G_TYPE_UINT64, c.received, field("forwarded").c_str(),
+                          G_TYPE_UINT64, c.forwarded, field("duplicates").c_str(), G_TYPE_UINT64, c.duplicates,
+                          field("late").c_str(), G_TYPE_UINT64, c.late, field("lost").c_str(), G_TYPE_UINT64, c.lost,
+                          nullptr);
+    }
+
+    GstStructure* make_stats(const merge_state_t& s)
+    {
+        const auto c = s.merge.has_value() ? s.merge->counters() : merge_counters_t{};
+        auto* stats  = gst_structure_new("application/x-st2022-7-stats", "forwarded", G_TYPE_UINT64, c.forwarded,
+                                         "lost", G_TYPE_UINT64, c.lost, "resyncs", G_TYPE_UINT64, c.resyncs,
+                                         "packets-invalid", G_TYPE_UINT64, s.packets_invalid, nullptr);
+        add_leg_counters(stats, "primary", c.legs[0]);
+        add_leg_counters(stats, "secondary", c.legs[1]);
+        return stats;
+    }
+} // namespace
+
+struct _GstSt2022_7Merge
+{
+    GstElement parent;
+    std::array<GstPad*, seamless_merge_t::leg_count> sinkpads;
+    GstPad* srcpad;
+    merge_state_t* state;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GstSt2022_7Merge, gst_st2022_7_merge, GST_TYPE_ELEMENT,
+                        GST_DEBUG_CATEGORY_INIT(gst_st2022_7_merge_debug_category, "st2110merge", 0,
+                                                "SMPTE 2022-7 seamless protection merge"))
+
+static GstStaticPadTemplate primary_template =
+    GST_STATIC_PAD_TEMPLATE("sink_0", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS("application/x-rtp"));
+
+static GstStaticPadTemplate secondary_template =
+    GST_STATIC_PAD_TEMPLATE("sink_1", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS("application/x-rtp"));
+
+static GstStaticPadTemplate src_template =
+    GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS("application/x-rtp"));
+
+static size_t leg_of(GstSt2022_7Merge* self, GstPad* pad)
+{
+    return pad == self->sinkpads[0] ? 0 : 1;
+}
+
+static void gst_st2022_7_merge_set_property(GObject* object, guint property_id, const GValue* value,
+                                            GParamSpec* pspec)
+{
+    auto* self = GST_ST2022_7_MERGE(object);
+    auto& s    = *self->state;
+
+    std::lock_guard lock(s.mutex);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Window: s.window = g_value_get_uint(value); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+}
+
+static void gst_st2022_7_merge_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec)
+{
+    auto* self = GST_ST2022_7_MERGE(object);
+    auto& s    = *self->state;
+
+    std::lock_guard lock(s.mutex);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Window: g_value_set_uint(value, s.window); break;
+    case PropertyId::Stats: g_value_take_boxed(value, make_stats(s)); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+}
+
+static GstFlowReturn gst_st2022_7_merge_chain(GstPad* pad, GstObject* parent, GstBuffer* buffer)
+{
+    auto* self = GST_ST2022_7_MERGE(parent);
+    auto& s    = *self->state;
+
+    std::lock_guard stream_lock(s.stream_mutex);
+    std::unique_lock lock(s.mutex);
+    if(!accept(s, leg_of(self, pad), buffer))
+    {
+        lock.unlock();
+        gst_buffer_unref(buffer);
+        return GST_FLOW_OK;
+    }
+    lock.unlock();
+
+    return gst_pad_push(self->srcpad, buffer);
+}
+
+static GstFlowReturn gst_st2022_7_merge_chain_list(GstPad* pad, GstObject* parent, GstBufferList* list)
+{
+    auto* self      = GST_ST2022_7_MERGE(parent);
+    auto& s         = *self->state;
+    const auto leg  = leg_of(self, pad);
+    const auto size = gst_buffer_list_length(list);
+
+    std::lock_guard stream_lock(s.stream_mutex);
+
+    // The buffers forwarded are the ones received: only references move to the outgoing list.
+    auto* out = gst_buffer_list_new_sized(size);
+    {
+        std::lock_guard lock(s.mutex);
+        for(guint i = 0; i < size; ++i)
+        {
+            auto* buffer = gst_buffer_list_get(list, i);
+            if(accept(s, leg, buffer)) gst_buffer_list_add(out, gst_buffer_ref(buffer));
+        }
+    }
+    gst_buffer_list_unref(list);
+
+    if(gst_buffer_list_length(out) == 0)
+    {
+        gst_buffer_list_unref(out);
+        return GST_FLOW_OK;
+    }
+
+    return gst_pad_push_list(self->srcpad, out);
+}
+
+static gboolean gst_st2022_7_merge_sink_event(GstPad* pad, GstObject* parent, GstEvent* event)
+{
+    auto* self = GST_ST2022_7_MERGE(parent);
+    auto& s    = *self->state;
+
+    switch(GST_EVENT_TYPE(event))
+    {
+    case GST_EVENT_STREAM_START:
+    case GST_EVENT_CAPS:
+    case GST_EVENT_SEGMENT: {
+        // Both legs announce the same stream: only the first announcement, or a change of caps, goes downstream.
+        std::lock_guard stream_lock(s.stream_mutex);
+        auto* current = gst_pad_get_sticky_event(self->srcpad, GST_EVENT_TYPE(event), 0);
+        bool forward  = current == nullptr;
+        if(current != nullptr && GST_EVENT_TYPE(event) == GST_EVENT_CAPS)
+        {
+            GstCaps* old_caps = nullptr;
+            GstCaps* caps     = nullptr;
+            gst_event_parse_caps(current, &old_caps);
+            gst_event_parse_caps(event, &caps);
+            forward = !gst_caps_is_equal(old_caps, caps);
+        }
+        if(current != nullptr) gst_event_unref(current);
+
+        if(!forward)
+        {
+            gst_event_unref(event);
+            return TRUE;
+        }
+        return gst_pad_push_event(self->srcpad, event);
+    }
+    case GST_EVENT_EOS: {
+        // The stream has ended only when neither leg can still deliver it.
+        std::lock_guard stream_lock(s.stream_mutex);
+        std::unique_lock lock(s.mutex);
+        s.eos[leg_of(self, pad)] = true;
+        const auto ended = s.eos[0] && s.eos[1];
+        lock.unlock();
+
+        if(!ended)
+        {
+            gst_event_unref(event);
+            return TRUE;
+        }
+        return gst_pad_push_event(self->srcpad, event);
+    }
+    case GST_EVENT_FLUSH_STOP: {
+        std::lock_guard lock(s.mutex);
+        if(s.merge.has_value()) s.merge->reset();
+        s.eos = {};
+        break;
+    }
+    default: break;
+    }
+
+    return gst_pad_event_default(pad, parent, event);
+}
+
+static GstStateChangeReturn gst_st2022_7_merge_change_state(GstElement* element, GstStateChange transition)
+{
+    auto* self = GST_ST2022_7_MERGE(element);
+    auto& s    = *self->state;
+
+    if(transition == GST_STATE_CHANGE_READY_TO_PAUSED)
+    {
+        std::lock_guard lock(s.mutex);
+        auto merge = seamless_merge_t::create(s.window);
+        if(!merge.has_value())
+        {
+            GST_ELEMENT_ERROR(self, LIBRARY, SETTINGS, ("Invalid merge window"), ("%s", merge.error().what()));
+            return GST_STATE_CHANGE_FAILURE;
+        }
+        s.merge.emplace(std::move(merge.value()));
+        s.eos             = {};
+        s.packets_invalid = 0;
+    }
+
+    return GST_ELEMENT_CLASS(gst_st2022_7_merge_parent_class)->change_state(element, transition);
+}
+
+static void gst_st2022_7_merge_finalize(GObject* object)
+{
+    delete GST_ST2022_7_MERGE(object)->state;
+
+    G_OBJECT_CLASS(gst_st2022_7_merge_parent_class)->finalize(object);
+}
+
+static void gst_st2022_7_merge_class_init(GstSt2022_7MergeClass* klass)
+{
+    GObjectClass* object_class     = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+
+    object_class->set_property = gst_st2022_7_merge_set_property;
+    object_class->get_property = gst_st2022_7_merge_get_property;
+    object_class->finalize     = gst_st2022_7_merge_finalize;
+
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Window),
+        g_param_spec_uint("window", "Window",
+                          "Sequence numbers remembered to detect duplicates, a power of two. Bounds the skew between "
+                          "the legs",
+                          2, 32768, default_window,
+                          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Stats),
+        g_param_spec_boxed("stats", "Statistics", "Merged and per-leg packet counters", GST_TYPE_STRUCTURE,
+                           (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_add_static_pad_template(element_class, &primary_template);
+    gst_element_class_add_static_pad_template(element_class, &secondary_template);
+    gst_element_class_add_static_pad_template(element_class, &src_template);
+
+    gst_element_class_set_static_metadata(element_class, "SMPTE 2022-7 merge", "Filter/Network/RTP",
+                                          "Merges the two legs of a redundant RTP stream, dropping duplicate packets",
+                                          "Luis Ferreira <luis.ferreira@bisect.pt>");
+
+    element_class->change_state = gst_st2022_7_merge_change_state;
+}
+
+static void gst_st2022_7_merge_init(GstSt2022_7Merge* self)
+{
+    self->state = new merge_state_t{};
+
+    const std::array templates{&primary_template, &secondary_template};
+    for(size_t leg = 0; leg < templates.size(); ++leg)
+    {
+        auto* pad = gst_pad_new_from_static_template(templates[leg], templates[leg]->name_template);
+        gst_pad_set_chain_function(pad, gst_st2022_7_merge_chain);
+        gst_pad_set_chain_list_function(pad, gst_st2022_7_merge_chain_list);
+        gst_pad_set_event_function(pad, gst_st2022_7_merge_sink_event);
+        GST_PAD_SET_PROXY_CAPS(pad);
+        gst_element_add_pad(GST_ELEMENT(self), pad);
+        self->sinkpads[leg] = pad;
+    }
+
+    self->srcpad = gst_pad_new_from_static_template(&src_template, "src");
+    GST_PAD_SET_PROXY_CAPS(self->srcpad);
+    gst_element_add_pad(GST_ELEMENT(self), self->srcpad);
+}
@@ -0,0 +1,352 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "st2110_20_depay.h"
+#include "bisect/rtp/depacketizer.h"
+#include "bisect/rtp/elements.h"
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/video/video.h>
+#include <gst/video/gstvideopool.h>
+#include <optional>
+#include <string>
+
+using namespace bisect::rtp;
+
+GST_DEBUG_CATEGORY_STATIC(gst_st2110_20_depay_debug_category);
+#define GST_CAT_DEFAULT gst_st2110_20_depay_debug_category
+
+namespace
+{
+    // One frame being filled plus one travelling downstream.
+    constexpr guint pool_min_buffers = 2;
+
+    struct depay_state_t
+    {
+        GstVideoInfo info;
+        std::optional<frame_assembler_t> assembler;
+        GstBufferPool* pool = nullptr;
+
+        // Frame currently being reassembled, mapped for writing until it is pushed.
+        GstBuffer* frame = nullptr;
+        GstVideoFrame mapped;
+        uint32_t rtp_timestamp = 0;
+        GstClockTime pts       = GST_CLOCK_TIME_NONE;
+        // Kernel receive time of the first packet of the frame, when the source provides it.
+        GstClockTime arrival = GST_CLOCK_TIME_NONE;
+
+        GstCaps* rtp_timestamp_caps = nullptr;
+        GstCaps* arrival_caps       = nullptr;
+
+        guint64 frames_incomplete = 0;
+        guint64 packets_invalid   = 0;
+    };
+
+    enum class PropertyId : uint32_t
+    {
+        FramesIncomplete = 1,
+        PacketsInvalid   = 2,
+    };
+
+    // SDP derived caps carry width, height and depth as strings, as rtpvrawdepay expects.
+    bool get_int_field(const GstStructure* structure, const char* name, gint& value)
+    {
+        const GValue* v = gst_structure_get_value(structure, name);
+        if(v == nullptr) return false;
+        if(G_VALUE_HOLDS_INT(v))
+        {
+            value = g_value_get_int(v);
+            return true;
+        }
+        if(G_VALUE_HOLDS_STRING(v))
+        {
+            gchar* end = nullptr;
+            const auto* s = g_value_get_string(v);
+            value         = static_cast<gint>(g_ascii_strtoll(s, &end, 10));
+            return end != s;
+        }
+        return false;
+    }
+
+    void get_framerate(const GstStructure* structure, gint& num, gint& den)
+    {
+        num = 0;
+        den = 1;
+        if(gst_structure_get_fraction(structure, "framerate", &num, &den)) return;
+
+        const gchar* exact = gst_structure_get_string(structure, "exactframerate");
+        if(exact == nullptr) return;
+        gchar* end = nullptr;
+        num        = static_cast<gint>(g_ascii_strtoll(exact, &end, 10));
+        if(end != nullptr && *end == '/') den = static_cast<gint>(g_ascii_strtoll(end + 1, nullptr, 10));
+    }
+
+    void release_pool(depay_state_t& s)
+    {
+        if(s.pool == nullptr) return;
+        gst_buffer_pool_set_active(s.pool, FALSE);
+        gst_object_unref(s.pool);
+        s.pool = nullptr;
+    }
+
+    void drop_frame(depay_state_t& s)
+    {
+        if(s.frame == nullptr) return;
+        gst_video_frame_unmap(&s.mapped);
+        gst_buffer_unref(s.frame);
+        s.frame = nullptr;
+    }
+
+    bool start_frame(depay_state_t& s, uint32_t rtp_timestamp, GstBuffer* packet)
+    {
+        if(gst_buffer_pool_acquire_buffer(s.pool, &s.frame, nullptr) != GST_FLOW_OK) return false;
+        if(!gst_video_frame_map(&s.mapped, &s.info, s.frame, GST_MAP_WRITE))
+        {
+            gst_buffer_unref(s.frame);
+            s.frame = nullptr;
+            return false;
+        }
+
+        s.assembler->begin(static_cast<uint8_t*>(GST_VIDEO_FRAME_PLANE_DATA(&s.mapped, 0)),
+                           static_cast<size_t>(GST_VIDEO_FRAME_PLANE_STRIDE(&s.mapped, 0)));
+        s.rtp_timestamp = rtp_timestamp;
+        s.pts           = GST_BUFFER_PTS(packet);
+
+        const auto* arrival = gst_buffer_get_reference_timestamp_meta(packet, s.arrival_caps);
+        s.arrival           = arrival != nullptr ? arrival->timestamp : GST_CLOCK_TIME_NONE;
+        return true;
+    }
+
+    GstBuffer* finish_frame(depay_state_t& s)
+    {
+        gst_video_frame_unmap(&s.mapped);
+        auto* out = s.frame;
+        s.frame   = nullptr;
+
+        if(!s.assembler->is_complete())
+        {
+            ++s.frames_incomplete;
+            GST_BUFFER_FLAG_SET(out, GST_BUFFER_FLAG_CORRUPTED);
+        }
+        GST_BUFFER_PTS(out) = s.pts;
+
+        // Lets an application sink see the frame's RTP timestamp and arrival time without the RTP packets.
+        gst_buffer_add_reference_timestamp_meta(out, s.rtp_timestamp_caps, s.rtp_timestamp, GST_CLOCK_TIME_NONE);
+        if(s.arrival != GST_CLOCK_TIME_NONE)
+        {
+            gst_buffer_add_reference_timestamp_meta(out, s.arrival_caps, s.arrival, GST_CLOCK_TIME_NONE);
+        }
+        return out;
+    }
+} // namespace
+
+struct _GstSt2110_20Depay
+{
+    GstRTPBaseDepayload parent;
+    depay_state_t* state;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GstSt2110_20Depay, gst_st2110_20_depay, GST_TYPE_RTP_BASE_DEPAYLOAD,
+                        GST_DEBUG_CATEGORY_INIT(gst_st2110_20_depay_debug_category, "st2110vrawdepay", 0,
+                                                "ST 2110-20 RTP depayloader"))
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+                                                                    GST_STATIC_CAPS("application/x-rtp, "
+                                                                                    "media=(string)video, "
+                                                                                    "clock-rate=(int)90000, "
+                                                                                    "encoding-name=(string)RAW"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+                                                                   GST_STATIC_CAPS("video/x-raw, "
+                                                                                   "format=(string)UYVP"));
+
+static void gst_st2110_20_depay_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec)
+{
+    auto* s = GST_ST2110_20_DEPAY(object)->state;
+
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::FramesIncomplete: g_value_set_uint64(value, s->frames_incomplete); break;
+    case PropertyId::PacketsInvalid: g_value_set_uint64(value, s->packets_invalid); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+}
+
+static gboolean gst_st2110_20_depay_set_caps(GstRTPBaseDepayload* depayload, GstCaps* caps)
+{
+    auto* self = GST_ST2110_20_DEPAY(depayload);
+    auto* s    = self->state;
+
+    const GstStructure* structure = gst_caps_get_structure(caps, 0);
+
+    gint width = 0, height = 0, depth = 10;
+    if(!get_int_field(structure, "width", width) || !get_int_field(structure, "height", height))
+    {
+        GST_ERROR_OBJECT(self, "Caps without width and height: %" GST_PTR_FORMAT, caps);
+        return FALSE;
+    }
+    get_int_field(structure, "depth", depth);
+
+    const gchar* sampling = gst_structure_get_string(structure, "sampling");
+    if(depth != 10 || (sampling != nullptr && g_strcmp0(sampling, "YCbCr-4:2:2") != 0))
+    {
+        GST_ERROR_OBJECT(self, "Only YCbCr-4:2:2 10-bit is supported, got %s %d-bit", sampling, depth);
+        return FALSE;
+    }
+
+    if(width <= 0 || height <= 0 || width % 2 != 0)
+    {
+        GST_ERROR_OBJECT(self, "Invalid frame size %dx%d", width, height);
+        return FALSE;
+    }
+
+    gint fps_n, fps_d;
+    get_framerate(structure, fps_n, fps_d);
+
+    drop_frame(*s);
+    release_pool(*s);
+
+    gst_video_info_set_format(&s->info, GST_VIDEO_FORMAT_UYVP, width, height);
+    GST_VIDEO_INFO_FPS_N(&s->info) = fps_n;
+    GST_VIDEO_INFO_FPS_D(&s->info) = fps_d;
+    s->assembler.emplace(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    auto* outcaps = gst_video_info_to_caps(&s->info);
+
+    s->pool     = gst_video_buffer_pool_new();
+    auto config = gst_buffer_pool_get_config(s->pool);
+    gst_buffer_pool_config_set_params(config, outcaps, GST_VIDEO_INFO_SIZE(&s->info), pool_min_buffers, 0);
+    const bool pool_ok = gst_buffer_pool_set_config(s->pool, config) && gst_buffer_pool_set_active(s->pool, TRUE);
+
+    const bool caps_ok = gst_pad_set_caps(GST_RTP_BASE_DEPAYLOAD_SRCPAD(depayload), outcaps);
+    gst_caps_unref(outcaps);
+
+    if(!pool_ok)
+    {
+        GST_ERROR_OBJECT(self, "Failed configuring the frame pool");
+        return FALSE;
+    }
+
+    return caps_ok;
+}
+
+static GstBuffer* gst_st2110_20_depay_process_rtp_packet(GstRTPBaseDepayload* depayload, GstRTPBuffer* rtp)
+{
+    auto* self = GST_ST2110_20_DEPAY(depayload);
+    auto* s    = self->state;
+
+    if(!s->assembler.has_value()) return nullptr;
+
+    const auto timestamp = gst_rtp_buffer_get_timestamp(rtp);
+    if(s->frame != nullptr && timestamp != s->rtp_timestamp)
+    {
+        // The marker packet of the previous frame was lost.
+        GST_DEBUG_OBJECT(self, "Frame %u ended without marker", s->rtp_timestamp);
+        gst_rtp_base_depayload_push(depayload, finish_frame(*s));
+    }
+
+    if(s->frame == nullptr && !start_frame(*s, timestamp, rtp->buffer))
+    {
+        GST_WARNING_OBJECT(self, "Failed acquiring a frame buffer");
+        return nullptr;
+    }
+
+    const auto* payload = static_cast<const uint8_t*>(gst_rtp_buffer_get_payload(rtp));
+    const auto size     = gst_rtp_buffer_get_payload_len(rtp);
+    if(!s->assembler->add_payload(payload, size))
+    {
+        ++s->packets_invalid;
+        GST_LOG_OBJECT(self, "Invalid payload of %u octets", size);
+    }
+
+    if(gst_rtp_buffer_get_marker(rtp)) return finish_frame(*s);
+
+    return nullptr;
+}
+
+static gboolean gst_st2110_20_depay_handle_event(GstRTPBaseDepayload* depayload, GstEvent* event)
+{
+    if(GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP)
+    {
+        drop_frame(*GST_ST2110_20_DEPAY(depayload)->state);
+    }
+
+    return GST_RTP_BASE_DEPAYLOAD_CLASS(gst_st2110_20_depay_parent_class)->handle_event(depayload, event);
+}
+
+static GstStateChangeReturn gst_st2110_20_depay_change_state(GstElement* element, GstStateChange transition)
+{
+    auto ret = GST_ELEMENT_CLASS(gst_st2110_20_depay_parent_class)->change_state(element, transition);
+
+    if(transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    {
+        auto* s = GST_ST2110_20_DEPAY(element)->state;
+        drop_frame(*s);
+        release_pool(*s);
+        s->assembler.reset();
+    }
+
+    return ret;
+}
+
+static void gst_st2110_20_depay_finalize(GObject* object)
+{
+    auto* s = GST_ST2110_20_DEPAY(object)->state;
+    drop_frame(*s);
+    release_pool(*s);
+    gst_caps_replace(&s->rtp_timestamp_caps, nullptr);
+    gst_caps_replace(&s->arrival_caps, nullptr);
+    delete s;
+
+    G_OBJECT_CLASS(gst_st2110_20_depay_parent_class)->finalize(object);
+}
+
+static void gst_st2110_20_depay_class_init(GstSt2110_20DepayClass* klass)
+{
+    GObjectClass* object_class          = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class      = GST_ELEMENT_CLASS(klass);
+    GstRTPBaseDepayloadClass* rtp_class = GST_RTP_BASE_DEPAYLOAD_CLASS(klass);
+
+    object_class->get_property = gst_st2110_20_depay_get_property;
+    object_class->finalize     = gst_st2110_20_depay_finalize;
+
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::FramesIncomplete),
+        g_param_spec_uint64("frames-incomplete", "Frames Incomplete", "Frames pushed with missing lines", 0,
+                            G_MAXUINT64, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::PacketsInvalid),
+        g_param_spec_uint64("packets-invalid", "Packets Invalid", "Packets with malformed or out of range SRDs", 0,
+                            G_MAXUINT64, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_add_static_pad_template(element_class, &sink_template);
+    gst_element_class_add_static_pad_template(element_class, &src_template);
+
+    gst_element_class_set_static_metadata(element_class, "ST 2110-20 RTP depayloader", "Codec/Depayloader/Network/RTP",
+                                          "Reassembles ST 2110-20 4:2:2 10-bit RTP packets into pooled frames",
+                                          "Luis Ferreira <luis.ferreira@bisect.pt>");
+
+    element_class->change_state    = gst_st2110_20_depay_change_state;
+    rtp_class->set_caps            = gst_st2110_20_depay_set_caps;
+    rtp_class->process_rtp_packet  = gst_st2110_20_depay_process_rtp_packet;
+    rtp_class->handle_event        = gst_st2110_20_depay_handle_event;
+}
+
+static void gst_st2110_20_depay_init(GstSt2110_20Depay* self)
+{
+    self->state                     = new depay_state_t{};
+    self->state->rtp_timestamp_caps = gst_caps_new_simple(rtp_timestamp_caps, "clock-rate", G_TYPE_INT, 90000, NULL);
+    self->state->arrival_caps       = gst_caps_new_empty_simple(arrival_timestamp_caps);
+    gst_video_info_init(&self->state->info);
+}
@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gst/rtp/gstrtpbasedepayload.h>
+
+#define GST_TYPE_ST2110_20_DEPAY (gst_st2110_20_depay_get_type())
+#define GST_ST2110_20_DEPAY(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_ST2110_20_DEPAY, GstSt2110_20Depay))
+
+typedef struct _GstSt2110_20Depay GstSt2110_20Depay;
+
+typedef struct _GstSt2110_20DepayClass
+{
+    GstRTPBaseDepayloadClass parent_class;
+} GstSt2110_20DepayClass;
+
+GType gst_st2110_20_depay_get_type(void);
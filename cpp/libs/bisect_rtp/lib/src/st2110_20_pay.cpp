@@ -0,0 +1,366 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "st2110_20_pay.h"
+#include "bisect/rtp/packetizer.h"
+#include "bisect/rtp/pgroup.h"
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/video/video.h>
+#include <algorithm>
+#include <string>
+
+using namespace bisect::rtp;
+
+GST_DEBUG_CATEGORY_STATIC(gst_st2110_20_pay_debug_category);
+#define GST_CAT_DEFAULT gst_st2110_20_pay_debug_category
+
+namespace
+{
+    // Output packets are recycled through a pool sized for the largest packet of the frame layout.
+    constexpr guint pool_min_buffers = 64;
+
+    struct pay_state_t
+    {
+        GstVideoInfo info;
+        pixel_layout_t layout = pixel_layout_t::uyvp;
+        frame_layout_t frame_layout{};
+        GstBufferPool* pool        = nullptr;
+        uint32_t extended_seq_high = 0;
+        packing_mode_t mode        = packing_mode_t::gpm;
+        bool use_simd              = true;
+    };
+
+    enum class PropertyId : uint32_t
+    {
+        PackingMode = 1,
+        Simd        = 2,
+    };
+
+    GType packing_mode_get_type()
+    {
+        static gsize type = 0;
+        if(g_once_init_enter(&type))
+        {
+            static const GEnumValue values[] = {
+                {static_cast<gint>(packing_mode_t::gpm), "General Packing Mode", "gpm"},
+                {static_cast<gint>(packing_mode_t::bpm), "Block Packing Mode", "bpm"},
+                {0, nullptr, nullptr},
+            };
+            g_once_init_leave(&type, g_enum_register_static("GstSt2110PackingMode", values));
+        }
+        return static_cast<GType>(type);
+    }
+
+    bool to_pixel_layout(GstVideoFormat format, pixel_layout_t& layout)
+    {
+        switch(format)
+        {
+        case GST_VIDEO_FORMAT_UYVP: layout = pixel_layout_t::uyvp; return true;
+        case GST_VIDEO_FORMAT_v210: layout = pixel_layout_t::v210; return true;
+        case GST_VIDEO_FORMAT_I422_10LE: layout = pixel_layout_t::i422_10le; return true;
+        default: return false;
+        }
+    }
+
+    // The colorimetry value of ST 2110-20 section 7.5 for the negotiated colorimetry.
+    const char* to_sdp_colorimetry(const GstVideoColorimetry& colorimetry)
+    {
+        if(gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT601)) return "BT601";
+        if(gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT709)) return "BT709";
+        if(gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT2020) ||
+           gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT2020_10))
+        {
+            return "BT2020";
+        }
+        if(gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT2100_PQ) ||
+           gst_video_colorimetry_matches(&colorimetry, GST_VIDEO_COLORIMETRY_BT2100_HLG))
+        {
+            return "BT2100";
+        }
+        return "UNSPECIFIED";
+    }
+
+    void release_pool(pay_state_t& s)
+    {
+        if(s.pool == nullptr) return;
+        gst_buffer_pool_set_active(s.pool, FALSE);
+        gst_object_unref(s.pool);
+        s.pool = nullptr;
+    }
+
+    bool setup_pool(pay_state_t& s)
+    {
+        release_pool(s);
+
+        guint max_payload = 0;
+        for(const auto& p : s.frame_layout.packets)
+        {
+            max_payload = std::max<guint>(max_payload, p.payload_octets);
+        }
+
+        s.pool      = gst_buffer_pool_new();
+        auto config = gst_buffer_pool_get_config(s.pool);
+        gst_buffer_pool_config_set_params(config, nullptr, rtp_header_octets + max_payload, pool_min_buffers, 0);
+        return gst_buffer_pool_set_config(s.pool, config) && gst_buffer_pool_set_active(s.pool, TRUE);
+    }
+} // namespace
+
+struct _GstSt2110_20Pay
+{
+    GstRTPBasePayload parent;
+    pay_state_t* state;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GstSt2110_20Pay, gst_st2110_20_pay, GST_TYPE_RTP_BASE_PAYLOAD,
+                        GST_DEBUG_CATEGORY_INIT(gst_st2110_20_pay_debug_category, "st2110vrawpay", 0,
+                                                "ST 2110-20 RTP payloader"))
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+                            GST_STATIC_CAPS("video/x-raw, "
+                                            "format=(string){ UYVP, v210, I422_10LE }, "
+                                            "width=(int)[ 2, 32767 ], "
+                                            "height=(int)[ 1, 32767 ]"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+                                                                   GST_STATIC_CAPS("application/x-rtp, "
+                                                                                   "media=(string)video, "
+                                                                                   "payload=(int)[ 96, 127 ], "
+                                                                                   "clock-rate=(int)90000, "
+                                                                                   "encoding-name=(string)RAW"));
+
+static void gst_st2110_20_pay_set_property(GObject* object, guint property_id, const GValue* value,
+                                           GParamSpec* pspec)
+{
+    auto* s = GST_ST2110_20_PAY(object)->state;
+
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::PackingMode: s->mode = static_cast<packing_mode_t>(g_value_get_enum(value)); break;
+    case PropertyId::Simd: s->use_simd = g_value_get_boolean(value); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+}
+
+static void gst_st2110_20_pay_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec)
+{
+    auto* s = GST_ST2110_20_PAY(object)->state;
+
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::PackingMode: g_value_set_enum(value, static_cast<gint>(s->mode)); break;
+    case PropertyId::Simd: g_value_set_boolean(value, s->use_simd); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+}
+
+static gboolean gst_st2110_20_pay_set_caps(GstRTPBasePayload* payload, GstCaps* caps)
+{
+    auto* self = GST_ST2110_20_PAY(payload);
+    auto* s    = self->state;
+
+    if(!gst_video_info_from_caps(&s->info, caps))
+    {
+        GST_ERROR_OBJECT(self, "Failed parsing caps %" GST_PTR_FORMAT, caps);
+        return FALSE;
+    }
+
+    if(!to_pixel_layout(GST_VIDEO_INFO_FORMAT(&s->info), s->layout))
+    {
+        GST_ERROR_OBJECT(self, "Unsupported video format %s", GST_VIDEO_INFO_NAME(&s->info));
+        return FALSE;
+    }
+
+    if(GST_VIDEO_INFO_IS_INTERLACED(&s->info))
+    {
+        GST_WARNING_OBJECT(self, "Interlaced input is sent as progressive frames");
+    }
+
+    const auto width       = static_cast<uint32_t>(GST_VIDEO_INFO_WIDTH(&s->info));
+    const auto height      = static_cast<uint32_t>(GST_VIDEO_INFO_HEIGHT(&s->info));
+    const auto max_payload = gst_rtp_buffer_calc_payload_len(GST_RTP_BASE_PAYLOAD_MTU(payload), 0, 0);
+
+    auto frame_layout = plan_frame(width, height, s->mode, max_payload);
+    if(!frame_layout.has_value())
+    {
+        GST_ERROR_OBJECT(self, "Failed planning packets: %s", frame_layout.error().what());
+        return FALSE;
+    }
+    s->frame_layout = std::move(frame_layout.value());
+
+    if(!setup_pool(*s))
+    {
+        GST_ERROR_OBJECT(self, "Failed configuring the packet pool");
+        return FALSE;
+    }
+
+    GST_INFO_OBJECT(self, "%ux%u %s, %" G_GSIZE_FORMAT " packets per frame", width, height,
+                    GST_VIDEO_INFO_NAME(&s->info), static_cast<gsize>(s->frame_layout.packets.size()));
+
+    gst_rtp_base_payload_set_options(payload, "video", TRUE, "RAW", 90000);
+
+    const auto width_s     = std::to_string(width);
+    const auto height_s    = std::to_string(height);
+    const auto colorimetry = to_sdp_colorimetry(GST_VIDEO_INFO_COLORIMETRY(&s->info));
+    return gst_rtp_base_payload_set_outcaps(payload, "sampling", G_TYPE_STRING, "YCbCr-4:2:2", "depth", G_TYPE_STRING,
+                                            "10", "width", G_TYPE_STRING, width_s.c_str(), "height", G_TYPE_STRING,
+                                            height_s.c_str(), "colorimetry", G_TYPE_STRING, colorimetry, nullptr);
+}
+
+static GstFlowReturn gst_st2110_20_pay_handle_buffer(GstRTPBasePayload* payload, GstBuffer* buffer)
+{
+    auto* self = GST_ST2110_20_PAY(payload);
+    auto* s    = self->state;
+
+    GstVideoFrame frame;
+    if(!gst_video_frame_map(&frame, &s->info, buffer, GST_MAP_READ))
+    {
+        GST_ERROR_OBJECT(self, "Failed mapping video frame");
+        gst_buffer_unref(buffer);
+        return GST_FLOW_ERROR;
+    }
+
+    frame_view_t view{.layout = s->layout, .planes = {}, .strides = {}};
+    for(guint i = 0; i < GST_VIDEO_FRAME_N_PLANES(&frame) && i < 3; ++i)
+    {
+        view.planes[i]  = static_cast<const uint8_t*>(GST_VIDEO_FRAME_PLANE_DATA(&frame, i));
+        view.strides[i] = static_cast<size_t>(GST_VIDEO_FRAME_PLANE_STRIDE(&frame, i));
+    }
+
+    const auto isa      = s->use_simd ? detect_isa() : isa_t::scalar;
+    const auto& packets = s->frame_layout.packets;
+    auto* list          = gst_buffer_list_new_sized(packets.size());
+
+    // The base class numbers packets consecutively from its last sequence number, so the high 16 bits of the
+    // extended sequence number can be derived up front for the whole frame.
+    const uint32_t first_seq = ((s->extended_seq_high << 16) | payload->seqnum) + 1;
+
+    GstFlowReturn ret = GST_FLOW_OK;
+    for(size_t i = 0; i < packets.size(); ++i)
+    {
+        const auto& p = packets[i];
+
+        GstBuffer* out = nullptr;
+        ret            = gst_buffer_pool_acquire_buffer(s->pool, &out, nullptr);
+        if(ret != GST_FLOW_OK) break;
+
+        gst_buffer_set_size(out, rtp_header_octets + p.payload_octets);
+
+        GstMapInfo map;
+        if(!gst_buffer_map(out, &map, GST_MAP_WRITE))
+        {
+            GST_ERROR_OBJECT(self, "Failed mapping output packet");
+            gst_buffer_unref(out);
+            ret = GST_FLOW_ERROR;
+            break;
+        }
+
+        // Version 2, no padding, extension or CSRCs. Sequence number, timestamp, SSRC and payload type are
+        // filled in by the base class when the list is pushed.
+        std::fill_n(map.data, rtp_header_octets, uint8_t{0});
+        map.data[0] = 0x80;
+        map.data[1] = (i + 1 == packets.size()) ? 0x80 : 0x00;
+
+        auto* dst = map.data + rtp_header_octets;
+        dst += write_payload_header(p, static_cast<uint16_t>((first_seq + i) >> 16), dst);
+        for(uint8_t k = 0; k < p.srd_count; ++k)
+        {
+            const auto& srd = p.srds[k];
+            pack_pgroups(view, srd.line, srd.offset, srd.length / pgroup_octets * pgroup_pixels, dst, isa);
+            dst += srd.length;
+        }
+
+        gst_buffer_unmap(out, &map);
+
+        GST_BUFFER_PTS(out) = GST_BUFFER_PTS(buffer);
+        GST_BUFFER_DTS(out) = GST_BUFFER_DTS(buffer);
+        gst_buffer_list_add(list, out);
+    }
+
+    gst_video_frame_unmap(&frame);
+    gst_buffer_unref(buffer);
+
+    if(ret != GST_FLOW_OK)
+    {
+        gst_buffer_list_unref(list);
+        return ret;
+    }
+
+    s->extended_seq_high = static_cast<uint32_t>((first_seq + packets.size() - 1) >> 16);
+
+    return gst_rtp_base_payload_push_list(payload, list);
+}
+
+static GstStateChangeReturn gst_st2110_20_pay_change_state(GstElement* element, GstStateChange transition)
+{
+    auto ret = GST_ELEMENT_CLASS(gst_st2110_20_pay_parent_class)->change_state(element, transition);
+
+    if(transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    {
+        auto* s = GST_ST2110_20_PAY(element)->state;
+        release_pool(*s);
+        s->extended_seq_high = 0;
+    }
+
+    return ret;
+}
+
+static void gst_st2110_20_pay_finalize(GObject* object)
+{
+    auto* self = GST_ST2110_20_PAY(object);
+    release_pool(*self->state);
+    delete self->state;
+
+    G_OBJECT_CLASS(gst_st2110_20_pay_parent_class)->finalize(object);
+}
+
+static void gst_st2110_20_pay_class_init(GstSt2110_20PayClass* klass)
+{
+    GObjectClass* object_class        = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class    = GST_ELEMENT_CLASS(klass);
+    GstRTPBasePayloadClass* rtp_class = GST_RTP_BASE_PAYLOAD_CLASS(klass);
+
+    object_class->set_property = gst_st2110_20_pay_set_property;
+    object_class->get_property = gst_st2110_20_pay_get_property;
+    object_class->finalize     = gst_st2110_20_pay_finalize;
+
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::PackingMode),
+        g_param_spec_enum("packing-mode", "Packing Mode", "ST 2110-20 packing mode", packing_mode_get_type(),
+                          static_cast<gint>(packing_mode_t::gpm),
+                          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Simd),
+        g_param_spec_boolean("simd", "SIMD", "Use the SSE4/AVX2 pgroup kernels when the CPU supports them", TRUE,
+                             (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_add_static_pad_template(element_class, &sink_template);
+    gst_element_class_add_static_pad_template(element_class, &src_template);
+
+    gst_element_class_set_static_metadata(element_class, "ST 2110-20 RTP payloader", "Codec/Payloader/Network/RTP",
+                                          "Payloads 4:2:2 10-bit raw video as ST 2110-20 RTP packets",
+                                          "Luis Ferreira <luis.ferreira@bisect.pt>");
+
+    element_class->change_state = gst_st2110_20_pay_change_state;
+    rtp_class->set_caps         = gst_st2110_20_pay_set_caps;
+    rtp_class->handle_buffer    = gst_st2110_20_pay_handle_buffer;
+}
+
+static void gst_st2110_20_pay_init(GstSt2110_20Pay* self)
+{
+    self->state = new pay_state_t{};
+    gst_video_info_init(&self->state->info);
+}
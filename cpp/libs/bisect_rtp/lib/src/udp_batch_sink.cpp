@@ -0,0 +1,620 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "udp_batch_sink.h"
+#include "bisect/rtp/paced_sender.h"
+#include "bisect/rtp/udp_sender.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace bisect::rtp;
+
+GST_DEBUG_CATEGORY_STATIC(gst_udp_batch_sink_debug_category);
+#define GST_CAT_DEFAULT gst_udp_batch_sink_debug_category
+
+namespace
+{
+    // Buffers with more memories than this are mapped as a whole, which merges them.
+    constexpr guint max_parts_per_buffer = 4;
+
+    // Mapping of either a single memory or, when `memory` is null, the whole buffer.
+    struct mapping_t
+    {
+        GstBuffer* buffer;
+        GstMemory* memory;
+        GstMapInfo info;
+        // Set on the first mapping of a buffer referenced by a paced frame.
+        bool owns_ref = false;
+    };
+
+    struct sink_state_t
+    {
+        // Guarded by the object lock.
+        udp_sender_settings_t settings{.destination_address = "localhost", .destination_port = 5004};
+        std::optional<pacing_type_t> pacing;
+        video_timing_t timing{.rate_num = 25, .rate_den = 1, .height = 1080};
+        bool reconfigure = false;
+        // Only the destination changed. A paced sender is retargeted at the next frame instead of being reopened.
+        bool retarget = false;
+        // Set by the streaming thread under the object lock, so that unlock() can reach it.
+        std::shared_ptr<paced_sender_t> paced;
+
+        // Streaming thread only.
+        udp_batch_sender_uptr sender;
+        std::vector<mapping_t> mappings;
+        // Frame being collected for the paced sender, and what it keeps mapped and referenced.
+        paced_frame_t frame;
+        std::shared_ptr<std::vector<mapping_t>> frame_mappings;
+    };
+
+    enum class PropertyId : uint32_t
+    {
+        Host           = 1,
+        Port           = 2,
+        MulticastIface = 3,
+        BindAddress    = 4,
+        TtlMc          = 5,
+        BatchSize      = 6,
+        Gso            = 7,
+        Pacing         = 8,
+        Framerate      = 9,
+        Interlaced     = 10,
+        Height         = 11,
+        Stats          = 12,
+    };
+
+    const char* to_string(const std::optional<pacing_type_t>& pacing)
+    {
+        if(!pacing) return "none";
+        switch(*pacing)
+        {
+        case pacing_type_t::narrow: return "narrow";
+        case pacing_type_t::narrow_linear: return "narrow-linear";
+        case pacing_type_t::wide: return "wide";
+        }
+        return "none";
+    }
+
+    std::optional<pacing_type_t> pacing_from_string(const char* value)
+    {
+        const std::string v = value != nullptr ? value : "";
+        if(v == "narrow") return pacing_type_t::narrow;
+        if(v == "narrow-linear") return pacing_type_t::narrow_linear;
+        if(v == "wide") return pacing_type_t::wide;
+        return std::nullopt;
+    }
+
+    void unmap(mapping_t& m)
+    {
+        if(m.memory != nullptr)
+        {
+            gst_memory_unmap(m.memory, &m.info);
+        }
+        else
+        {
+            gst_buffer_unmap(m.buffer, &m.info);
+        }
+    }
+
+    paced_frame_t take_frame(sink_state_t& s)
+    {
+        auto frame = std::exchange(s.frame, {});
+        if(auto mappings = std::exchange(s.frame_mappings, nullptr))
+        {
+            frame.release = [mappings] {
+                for(auto& m : *mappings)
+                {
+                    unmap(m);
+                }
+                for(const auto& m : *mappings)
+                {
+                    if(m.owns_ref) gst_buffer_unref(m.buffer);
+                }
+            };
+        }
+        return frame;
+    }
+
+    void drop_frame(sink_state_t& s)
+    {
+        auto frame = take_frame(s);
+        if(frame.release) frame.release();
+    }
+
+    void set_paced(GstUdpBatchSink* self, sink_state_t& s, std::shared_ptr<paced_sender_t> paced)
+    {
+        GST_OBJECT_LOCK(self);
+        std::swap(s.paced, paced);
+        GST_OBJECT_UNLOCK(self);
+    }
+
+    bool open_paced_sender(GstUdpBatchSink* self, sink_state_t& s, const udp_sender_settings_t& settings,
+                           const pacing_settings_t& pacing)
+    {
+        auto paced = paced_sender_t::create(settings, pacing);
+        if(!paced.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, OPEN_WRITE, ("Failed opening paced UDP sender"),
+                              ("%s", paced.error().what()));
+            return false;
+        }
+        set_paced(self, s, std::move(paced.value()));
+
+        GST_INFO_OBJECT(self, "Sending to %s:%u, paced as ST 2110-21 type %s at %u/%u",
+                        settings.destination_address.c_str(), settings.destination_port, to_string(pacing.type),
+                        pacing.timing.rate_num, pacing.timing.rate_den);
+        return true;
+    }
+
+    bool open_sender(GstUdpBatchSink* self, sink_state_t& s)
+    {
+        GST_OBJECT_LOCK(self);
+        const auto settings = s.settings;
+        const auto pacing   = s.pacing;
+        const auto timing   = s.timing;
+        s.reconfigure       = false;
+        s.retarget          = false;
+        GST_OBJECT_UNLOCK(self);
+
+        // The frames already handed to the paced sender are sent before it is closed.
+        if(s.paced) s.paced->drain();
+        s.sender.reset();
+        set_paced(self, s, nullptr);
+        drop_frame(s);
+        if(pacing.has_value())
+        {
+            return open_paced_sender(self, s, settings, {.timing = timing, .type = *pacing});
+        }
+
+        auto sender = udp_batch_sender_t::create(settings);
+        if(!sender.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, OPEN_WRITE, ("Failed opening UDP socket"), ("%s", sender.error().what()));
+            return false;
+        }
+
+        s.sender = std::move(sender.value());
+        if(settings.gso && !s.sender->gso_enabled())
+        {
+            GST_WARNING_OBJECT(self, "UDP GSO not supported by the kernel, batching without it");
+        }
+
+        GST_INFO_OBJECT(self, "Sending to %s:%u, batches of %" G_GSIZE_FORMAT "%s",
+                        settings.destination_address.c_str(), settings.destination_port,
+                        static_cast<gsize>(settings.batch_size), s.sender->gso_enabled() ? " with GSO" : "");
+        return true;
+    }
+
+    // Sends the frames from the one being collected on to the new destination. Those already queued keep theirs.
+    bool retarget_paced_sender(GstUdpBatchSink* self, sink_state_t& s)
+    {
+        GST_OBJECT_LOCK(self);
+        const auto settings = s.settings;
+        s.retarget          = false;
+        GST_OBJECT_UNLOCK(self);
+
+        const auto result = s.paced->retarget(settings);
+        if(!result.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, OPEN_WRITE, ("Failed opening paced UDP sender"),
+                              ("%s", result.error().what()));
+            return false;
+        }
+
+        GST_INFO_OBJECT(self, "Sending to %s:%u from the next frame", settings.destination_address.c_str(),
+                        settings.destination_port);
+        return true;
+    }
+
+    bool ensure_sender(GstUdpBatchSink* self, sink_state_t& s)
+    {
+        GST_OBJECT_LOCK(self);
+        const auto reconfigure = s.reconfigure;
+        const auto retarget    = s.retarget;
+        GST_OBJECT_UNLOCK(self);
+
+        if((s.sender == nullptr && s.paced == nullptr) || reconfigure) return open_sender(self, s);
+        if(retarget) return s.paced != nullptr ? retarget_paced_sender(self, s) : open_sender(self, s);
+        return true;
+    }
+
+    void set_string(std::string& target, const GValue* value)
+    {
+        const auto* v = g_value_get_string(value);
+        target        = v != nullptr ? v : "";
+    }
+
+    void unmap_all(sink_state_t& s)
+    {
+        for(auto& m : s.mappings)
+        {
+            unmap(m);
+        }
+        s.mappings.clear();
+    }
+
+    // Maps `buffer` into `mappings` and returns its parts, or 0 parts on failure.
+    guint map_buffer(GstUdpBatchSink* self, std::vector<mapping_t>& mappings, GstBuffer* buffer,
+                     std::array<iovec, max_parts_per_buffer>& parts)
+    {
+        const auto n_memory = gst_buffer_n_memory(buffer);
+
+        if(n_memory <= max_parts_per_buffer)
+        {
+            for(guint i = 0; i < n_memory; ++i)
+            {
+                auto* memory = gst_buffer_peek_memory(buffer, i);
+                auto& m      = mappings.emplace_back(mapping_t{buffer, memory, {}});
+                if(!gst_memory_map(memory, &m.info, GST_MAP_READ))
+                {
+                    mappings.pop_back();
+                    GST_ELEMENT_ERROR(self, RESOURCE, READ, ("Failed mapping buffer memory"), (nullptr));
+                    return 0;
+                }
+                parts[i] = {m.info.data, m.info.size};
+            }
+            return n_memory;
+        }
+
+        auto& m = mappings.emplace_back(mapping_t{buffer, nullptr, {}});
+        if(!gst_buffer_map(buffer, &m.info, GST_MAP_READ))
+        {
+            mappings.pop_back();
+            GST_ELEMENT_ERROR(self, RESOURCE, READ, ("Failed mapping buffer"), (nullptr));
+            return 0;
+        }
+        parts[0] = {m.info.data, m.info.size};
+        return 1;
+    }
+
+    bool queue_buffer(GstUdpBatchSink* self, sink_state_t& s, GstBuffer* buffer)
+    {
+        std::array<iovec, max_parts_per_buffer> parts;
+        const auto n_parts = map_buffer(self, s.mappings, buffer, parts);
+        if(n_parts == 0) return false;
+
+        const auto result = s.sender->queue({parts.data(), n_parts});
+        if(!result.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, WRITE, ("Failed sending packets"), ("%s", result.error().what()));
+            return false;
+        }
+        return true;
+    }
+
+    // Sends whatever was queued, even after a failed queue_buffer, as the sender references the mapped memory.
+    GstFlowReturn flush(GstUdpBatchSink* self, sink_state_t& s, bool queued)
+    {
+        const auto result = s.sender->flush();
+        unmap_all(s);
+
+        if(!result.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, WRITE, ("Failed sending packets"), ("%s", result.error().what()));
+            return GST_FLOW_ERROR;
+        }
+        return queued ? GST_FLOW_OK : GST_FLOW_ERROR;
+    }
+
+    // Adds `buffer` to the frame being collected for the paced sender. The frame keeps a reference to it.
+    bool add_to_frame(GstUdpBatchSink* self, sink_state_t& s, GstBuffer* buffer)
+    {
+        if(!s.frame_mappings) s.frame_mappings = std::make_shared<std::vector<mapping_t>>();
+
+        // The frame outlives this call, so it takes a reference, dropped by release() after unmapping.
+        std::array<iovec, max_parts_per_buffer> parts;
+        const auto first   = s.frame_mappings->size();
+        const auto n_parts = map_buffer(self, *s.frame_mappings, buffer, parts);
+        if(s.frame_mappings->size() > first)
+        {
+            gst_buffer_ref(buffer);
+            (*s.frame_mappings)[first].owns_ref = true;
+        }
+        if(n_parts == 0) return false;
+
+        s.frame.parts.insert(s.frame.parts.end(), parts.begin(), parts.begin() + n_parts);
+        s.frame.packet_parts.push_back(n_parts);
+        return true;
+    }
+
+    GstFlowReturn send_frame(GstUdpBatchSink* self, sink_state_t& s)
+    {
+        auto frame        = take_frame(s);
+        const auto result = s.paced->send_frame(std::move(frame));
+        if(!result.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, WRITE, ("Failed sending packets"), ("%s", result.error().what()));
+            return GST_FLOW_ERROR;
+        }
+        return GST_FLOW_OK;
+    }
+
+    // RTP marker bit: the last packet of a video frame.
+    bool has_marker(const paced_frame_t& frame)
+    {
+        const auto& last = frame.parts[frame.parts.size() - frame.packet_parts.back()];
+        return last.iov_len > 1 && (static_cast<const uint8_t*>(last.iov_base)[1] & 0x80) != 0;
+    }
+
+    GstStructure* make_stats(const sink_state_t& s)
+    {
+        const auto c        = s.paced ? s.paced->counters() : pacing_counters_t{};
+        const auto schedule = s.paced ? s.paced->schedule() : std::nullopt;
+        return gst_structure_new("application/x-st2110-21-stats", "frames", G_TYPE_UINT64, c.frames, "packets",
+                                 G_TYPE_UINT64, c.packets, "late-frames", G_TYPE_UINT64, c.late_frames, "cinst-peak",
+                                 G_TYPE_UINT, c.cinst_peak, "cmax", G_TYPE_UINT, schedule ? schedule->cmax() : 0u,
+                                 "vrx-peak", G_TYPE_UINT, c.vrx_peak, "vrx-full", G_TYPE_UINT,
+                                 schedule ? schedule->vrx_full() : 0u, "cmax-violations", G_TYPE_UINT64,
+                                 c.cmax_violations, "vrx-overflows", G_TYPE_UINT64, c.vrx_overflows, "vrx-underflows",
+                                 G_TYPE_UINT64, c.vrx_underflows, nullptr);
+    }
+} // namespace
+
+struct _GstUdpBatchSink
+{
+    GstBaseSink parent;
+    sink_state_t* state;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GstUdpBatchSink, gst_udp_batch_sink, GST_TYPE_BASE_SINK,
+                        GST_DEBUG_CATEGORY_INIT(gst_udp_batch_sink_debug_category, "st2110udpsink", 0,
+                                                "Batched UDP sink"))
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static void gst_udp_batch_sink_set_property(GObject* object, guint property_id, const GValue* value,
+                                            GParamSpec* pspec)
+{
+    auto* self = GST_UDP_BATCH_SINK(object);
+    auto& s    = *self->state;
+
+    GST_OBJECT_LOCK(self);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Host: set_string(s.settings.destination_address, value); break;
+    case PropertyId::Port: s.settings.destination_port = static_cast<uint16_t>(g_value_get_int(value)); break;
+    case PropertyId::MulticastIface: set_string(s.settings.interface_name, value); break;
+    case PropertyId::BindAddress: set_string(s.settings.source_address, value); break;
+    case PropertyId::TtlMc: s.settings.multicast_ttl = g_value_get_int(value); break;
+    case PropertyId::BatchSize: s.settings.batch_size = g_value_get_uint(value); break;
+    case PropertyId::Gso: s.settings.gso = g_value_get_boolean(value); break;
+    case PropertyId::Pacing: s.pacing = pacing_from_string(g_value_get_string(value)); break;
+    case PropertyId::Framerate:
+        s.timing.rate_num = static_cast<uint32_t>(gst_value_get_fraction_numerator(value));
+        s.timing.rate_den = static_cast<uint32_t>(gst_value_get_fraction_denominator(value));
+        break;
+    case PropertyId::Interlaced: s.timing.interlaced = g_value_get_boolean(value); break;
+    case PropertyId::Height: s.timing.height = g_value_get_uint(value); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+    const auto id = static_cast<PropertyId>(property_id);
+    if(id == PropertyId::Host || id == PropertyId::Port)
+    {
+        s.retarget = true;
+    }
+    else
+    {
+        s.reconfigure = true;
+    }
+    GST_OBJECT_UNLOCK(self);
+}
+
+static void gst_udp_batch_sink_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec)
+{
+    auto* self = GST_UDP_BATCH_SINK(object);
+    auto& s    = *self->state;
+
+    GST_OBJECT_LOCK(self);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Host: g_value_set_string(value, s.settings.destination_address.c_str()); break;
+    case PropertyId::Port: g_value_set_int(value, s.settings.destination_port); break;
+    case PropertyId::MulticastIface: g_value_set_string(value, s.settings.interface_name.c_str()); break;
+    case PropertyId::BindAddress: g_value_set_string(value, s.settings.source_address.c_str()); break;
+    case PropertyId::TtlMc: g_value_set_int(value, s.settings.multicast_ttl); break;
+    case PropertyId::BatchSize: g_value_set_uint(value, static_cast<guint>(s.settings.batch_size)); break;
+    case PropertyId::Gso: g_value_set_boolean(value, s.settings.gso); break;
+    case PropertyId::Pacing: g_value_set_string(value, to_string(s.pacing)); break;
+    case PropertyId::Framerate:
+        gst_value_set_fraction(value, static_cast<gint>(s.timing.rate_num), static_cast<gint>(s.timing.rate_den));
+        break;
+    case PropertyId::Interlaced: g_value_set_boolean(value, s.timing.interlaced); break;
+    case PropertyId::Height: g_value_set_uint(value, s.timing.height); break;
+    case PropertyId::Stats: g_value_take_boxed(value, make_stats(s)); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+    GST_OBJECT_UNLOCK(self);
+}
+
+static gboolean gst_udp_batch_sink_start(GstBaseSink* sink)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    return open_sender(self, *self->state);
+}
+
+static gboolean gst_udp_batch_sink_stop(GstBaseSink* sink)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    auto& s    = *self->state;
+    unmap_all(s);
+    s.sender.reset();
+
+    // Releases a partly collected frame along with anything still queued for pacing.
+    drop_frame(s);
+    set_paced(self, s, nullptr);
+    return TRUE;
+}
+
+static gboolean gst_udp_batch_sink_unlock(GstBaseSink* sink)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    GST_OBJECT_LOCK(self);
+    auto paced = self->state->paced;
+    GST_OBJECT_UNLOCK(self);
+
+    if(paced) paced->set_flushing(true);
+    return TRUE;
+}
+
+static gboolean gst_udp_batch_sink_unlock_stop(GstBaseSink* sink)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    GST_OBJECT_LOCK(self);
+    auto paced = self->state->paced;
+    GST_OBJECT_UNLOCK(self);
+
+    if(paced) paced->set_flushing(false);
+    return TRUE;
+}
+
+static GstFlowReturn gst_udp_batch_sink_render(GstBaseSink* sink, GstBuffer* buffer)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    auto& s    = *self->state;
+
+    if(!ensure_sender(self, s)) return GST_FLOW_ERROR;
+
+    if(s.paced)
+    {
+        // Single buffers are collected up to the one carrying the RTP marker, so the whole frame is paced.
+        if(!add_to_frame(self, s, buffer))
+        {
+            drop_frame(s);
+            return GST_FLOW_ERROR;
+        }
+        return has_marker(s.frame) ? send_frame(self, s) : GST_FLOW_OK;
+    }
+
+    return flush(self, s, queue_buffer(self, s, buffer));
+}
+
+static GstFlowReturn gst_udp_batch_sink_render_list(GstBaseSink* sink, GstBufferList* list)
+{
+    auto* self = GST_UDP_BATCH_SINK(sink);
+    auto& s    = *self->state;
+
+    if(!ensure_sender(self, s)) return GST_FLOW_ERROR;
+
+    const auto length = gst_buffer_list_length(list);
+    if(s.paced)
+    {
+        // A list is a whole frame, as st2110vrawpay pushes them.
+        for(guint i = 0; i < length; ++i)
+        {
+            if(!add_to_frame(self, s, gst_buffer_list_get(list, i)))
+            {
+                drop_frame(s);
+                return GST_FLOW_ERROR;
+            }
+        }
+        return send_frame(self, s);
+    }
+
+    // The whole list stays mapped until it is sent; the sender splits it into batch-size syscalls.
+    bool queued = true;
+    for(guint i = 0; i < length && queued; ++i)
+    {
+        queued = queue_buffer(self, s, gst_buffer_list_get(list, i));
+    }
+
+    return flush(self, s, queued);
+}
+
+static void gst_udp_batch_sink_finalize(GObject* object)
+{
+    delete GST_UDP_BATCH_SINK(object)->state;
+
+    G_OBJECT_CLASS(gst_udp_batch_sink_parent_class)->finalize(object);
+}
+
+static void gst_udp_batch_sink_class_init(GstUdpBatchSinkClass* klass)
+{
+    GObjectClass* object_class       = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class   = GST_ELEMENT_CLASS(klass);
+    GstBaseSinkClass* basesink_class = GST_BASE_SINK_CLASS(klass);
+
+    object_class->set_property = gst_udp_batch_sink_set_property;
+    object_class->get_property = gst_udp_batch_sink_get_property;
+    object_class->finalize     = gst_udp_batch_sink_finalize;
+
+    const auto flags = (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Host),
+        g_param_spec_string("host", "Host", "The host or IP address to send packets to", "localhost", flags));
+    g_object_class_install_property(object_class, static_cast<guint>(PropertyId::Port),
+                                    g_param_spec_int("port", "Port", "The port to send packets to", 0, 65535, 5004,
+                                                     flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::MulticastIface),
+        g_param_spec_string("multicast-iface", "Multicast Interface", "Network interface for multicast packets",
+                            nullptr, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::BindAddress),
+        g_param_spec_string("bind-address", "Bind Address", "Local address to bind the socket to", nullptr, flags));
+    g_object_class_install_property(object_class, static_cast<guint>(PropertyId::TtlMc),
+                                    g_param_spec_int("ttl-mc", "Multicast TTL", "TTL of multicast packets", 0, 255,
+                                                     64, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::BatchSize),
+        g_param_spec_uint("batch-size", "Batch Size", "Maximum number of packets per sendmmsg call", 1, 1024,
+                          static_cast<guint>(default_batch_size), flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Gso),
+        g_param_spec_boolean("gso", "GSO", "Use UDP generic segmentation offload for equal-sized packets", FALSE,
+                             flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Pacing),
+        g_param_spec_string("pacing", "Pacing",
+                            "ST 2110-21 sender type to pace video frames as: none, narrow, narrow-linear or wide",
+                            "none", flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Framerate),
+        gst_param_spec_fraction("framerate", "Frame Rate", "Frame rate of the paced video", 1, 1, G_MAXINT, 1, 25, 1,
+                                flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Interlaced),
+        g_param_spec_boolean("interlaced", "Interlaced", "Pace each frame as two fields", FALSE, flags));
+    g_object_class_install_property(object_class, static_cast<guint>(PropertyId::Height),
+                                    g_param_spec_uint("height", "Height", "Height of the paced video, selects TRO", 1,
+                                                      G_MAXUINT16, 1080, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Stats),
+        g_param_spec_boxed("stats", "Statistics", "ST 2110-21 pacing and conformance counters", GST_TYPE_STRUCTURE,
+                           (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_add_static_pad_template(element_class, &sink_template);
+
+    gst_element_class_set_static_metadata(element_class, "Batched UDP sink", "Sink/Network",
+                                          "Sends buffer lists as UDP packets with sendmmsg and optional GSO",
+                                          "Luis Ferreira <luis.ferreira@bisect.pt>");
+
+    basesink_class->start       = gst_udp_batch_sink_start;
+    basesink_class->stop        = gst_udp_batch_sink_stop;
+    basesink_class->unlock      = gst_udp_batch_sink_unlock;
+    basesink_class->unlock_stop = gst_udp_batch_sink_unlock_stop;
+    basesink_class->render      = gst_udp_batch_sink_render;
+    basesink_class->render_list = gst_udp_batch_sink_render_list;
+}
+
+static void gst_udp_batch_sink_init(GstUdpBatchSink* self)
+{
+    self->state = new sink_state_t{};
+}
@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gst/base/gstbasesink.h>
+
+#define GST_TYPE_UDP_BATCH_SINK (gst_udp_batch_sink_get_type())
+#define GST_UDP_BATCH_SINK(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_UDP_BATCH_SINK, GstUdpBatchSink))
+
+typedef struct _GstUdpBatchSink GstUdpBatchSink;
+
+typedef struct _GstUdpBatchSinkClass
+{
+    GstBaseSinkClass parent_class;
+} GstUdpBatchSinkClass;
+
+GType gst_udp_batch_sink_get_type(void);
@@ -0,0 +1,485 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "udp_batch_src.h"
+#include "bisect/rtp/elements.h"
+#include "bisect/rtp/udp_receiver.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace bisect::rtp;
+
+GST_DEBUG_CATEGORY_STATIC(gst_udp_batch_src_debug_category);
+#define GST_CAT_DEFAULT gst_udp_batch_src_debug_category
+
+namespace
+{
+    constexpr guint default_mtu = 1500;
+
+    // A pool buffer mapped for writing, waiting for a datagram.
+    struct slot_t
+    {
+        GstBuffer* buffer = nullptr;
+        GstMapInfo map;
+    };
+
+    struct src_state_t
+    {
+        // Guarded by the object lock.
+        udp_receiver_settings_t settings{.address = "0.0.0.0", .port = 5004};
+        GstCaps* caps = nullptr;
+        guint mtu     = default_mtu;
+
+        // Replaced by the streaming thread only; other threads use it under the object lock.
+        udp_batch_receiver_uptr receiver;
+
+        // Streaming thread only.
+        GstBufferPool* pool = nullptr;
+        std::vector<slot_t> slots;
+        std::vector<iovec> iovs;
+        GstCaps* timestamp_caps = nullptr;
+
+        std::atomic<bool> flushing     = false;
+        // The address, port, source or interface changed while receiving.
+        std::atomic<bool> retarget     = false;
+        std::atomic<guint64> truncated = 0;
+    };
+
+    enum class PropertyId : uint32_t
+    {
+        Address            = 1,
+        Port               = 2,
+        MulticastIface     = 3,
+        Caps               = 4,
+        BufferSize         = 5,
+        BatchSize          = 6,
+        Mtu                = 7,
+        DatagramsTruncated = 8,
+        SourceAddress      = 9,
+    };
+
+    void release_slots(src_state_t& s)
+    {
+        for(auto& slot : s.slots)
+        {
+            if(slot.buffer == nullptr) continue;
+            gst_buffer_unmap(slot.buffer, &slot.map);
+            gst_buffer_unref(slot.buffer);
+            slot.buffer = nullptr;
+        }
+    }
+
+    // Gives every empty slot a pool buffer. Slots whose datagram was dropped keep their buffer.
+    bool fill_slots(GstUdpBatchSrc* self, src_state_t& s)
+    {
+        for(size_t i = 0; i < s.slots.size(); ++i)
+        {
+            auto& slot = s.slots[i];
+            if(slot.buffer != nullptr) continue;
+
+            if(gst_buffer_pool_acquire_buffer(s.pool, &slot.buffer, nullptr) != GST_FLOW_OK) return false;
+            if(!gst_buffer_map(slot.buffer, &slot.map, GST_MAP_WRITE))
+            {
+                gst_buffer_unref(slot.buffer);
+                slot.buffer = nullptr;
+                GST_ERROR_OBJECT(self, "Failed mapping pool buffer");
+                return false;
+            }
+            s.iovs[i] = {slot.map.data, slot.map.size};
+        }
+        return true;
+    }
+
+    // Joins the new target before leaving the old one, so the buffer pool, the slots and everything downstream carry
+    // on as they are and only the packets in flight on the old socket are lost.
+    bool retarget(GstUdpBatchSrc* self, src_state_t& s)
+    {
+        GST_OBJECT_LOCK(self);
+        auto settings = s.settings;
+        GST_OBJECT_UNLOCK(self);
+        settings.batch_size = s.slots.size();
+
+        auto receiver = udp_batch_receiver_t::create(settings);
+        if(!receiver.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, OPEN_READ, ("Failed opening UDP socket"),
+                              ("%s", receiver.error().what()));
+            return false;
+        }
+
+        GST_OBJECT_LOCK(self);
+        std::swap(s.receiver, receiver.value());
+        if(s.flushing) s.receiver->interrupt();
+        GST_OBJECT_UNLOCK(self);
+
+        GST_INFO_OBJECT(self, "Re-targeted to %s:%u", settings.address.c_str(), settings.port);
+        return true;
+    }
+
+    GstClockTime running_time(GstUdpBatchSrc* self)
+    {
+        auto* clock = gst_element_get_clock(GST_ELEMENT(self));
+        if(clock == nullptr) return GST_CLOCK_TIME_NONE;
+
+        const auto now  = gst_clock_get_time(clock);
+        const auto base = gst_element_get_base_time(GST_ELEMENT(self));
+        gst_object_unref(clock);
+        return now > base ? now - base : 0;
+    }
+} // namespace
+
+struct _GstUdpBatchSrc
+{
+    GstPushSrc parent;
+    src_state_t* state;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GstUdpBatchSrc, gst_udp_batch_src, GST_TYPE_PUSH_SRC,
+                        GST_DEBUG_CATEGORY_INIT(gst_udp_batch_src_debug_category, "st2110udpsrc", 0,
+                                                "Batched UDP source"))
+
+static GstStaticPadTemplate src_template =
+    GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static void gst_udp_batch_src_set_property(GObject* object, guint property_id, const GValue* value, GParamSpec* pspec)
+{
+    auto* self = GST_UDP_BATCH_SRC(object);
+    auto& s    = *self->state;
+
+    GST_OBJECT_LOCK(self);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Address: {
+        const auto* v      = g_value_get_string(value);
+        s.settings.address = v != nullptr ? v : "";
+        break;
+    }
+    case PropertyId::Port: s.settings.port = static_cast<uint16_t>(g_value_get_int(value)); break;
+    case PropertyId::MulticastIface: {
+        const auto* v             = g_value_get_string(value);
+        s.settings.interface_name = v != nullptr ? v : "";
+        break;
+    }
+    case PropertyId::Caps: gst_caps_replace(&s.caps, const_cast<GstCaps*>(gst_value_get_caps(value))); break;
+    case PropertyId::BufferSize: s.settings.receive_buffer_size = g_value_get_int(value); break;
+    case PropertyId::BatchSize: s.settings.batch_size = g_value_get_uint(value); break;
+    case PropertyId::Mtu: s.mtu = g_value_get_uint(value); break;
+    case PropertyId::SourceAddress: {
+        const auto* v             = g_value_get_string(value);
+        s.settings.source_address = v != nullptr ? v : "";
+        break;
+    }
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+
+    // While receiving, a new target is picked up by the streaming thread without stopping the element.
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Address:
+    case PropertyId::Port:
+    case PropertyId::MulticastIface:
+    case PropertyId::SourceAddress:
+        if(s.receiver)
+        {
+            s.retarget = true;
+            s.receiver->interrupt();
+        }
+        break;
+    default: break;
+    }
+    GST_OBJECT_UNLOCK(self);
+
+    if(static_cast<PropertyId>(property_id) == PropertyId::Caps)
+    {
+        gst_pad_mark_reconfigure(GST_BASE_SRC_PAD(self));
+    }
+}
+
+static void gst_udp_batch_src_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec)
+{
+    auto* self = GST_UDP_BATCH_SRC(object);
+    auto& s    = *self->state;
+
+    GST_OBJECT_LOCK(self);
+    switch(static_cast<PropertyId>(property_id))
+    {
+    case PropertyId::Address: g_value_set_string(value, s.settings.address.c_str()); break;
+    case PropertyId::Port: g_value_set_int(value, s.settings.port); break;
+    case PropertyId::MulticastIface: g_value_set_string(value, s.settings.interface_name.c_str()); break;
+    case PropertyId::Caps: gst_value_set_caps(value, s.caps); break;
+    case PropertyId::BufferSize: g_value_set_int(value, s.settings.receive_buffer_size); break;
+    case PropertyId::BatchSize: g_value_set_uint(value, static_cast<guint>(s.settings.batch_size)); break;
+    case PropertyId::Mtu: g_value_set_uint(value, s.mtu); break;
+    case PropertyId::DatagramsTruncated: g_value_set_uint64(value, s.truncated); break;
+    case PropertyId::SourceAddress: g_value_set_string(value, s.settings.source_address.c_str()); break;
+
+    default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
+    }
+    GST_OBJECT_UNLOCK(self);
+}
+
+static GstCaps* gst_udp_batch_src_get_caps(GstBaseSrc* src, GstCaps* filter)
+{
+    auto& s = *GST_UDP_BATCH_SRC(src)->state;
+
+    GST_OBJECT_LOCK(src);
+    auto* caps = s.caps != nullptr ? gst_caps_ref(s.caps) : gst_caps_new_any();
+    GST_OBJECT_UNLOCK(src);
+
+    if(filter != nullptr)
+    {
+        auto* intersection = gst_caps_intersect_full(filter, caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(caps);
+        caps = intersection;
+    }
+    return caps;
+}
+
+static gboolean gst_udp_batch_src_start(GstBaseSrc* src)
+{
+    auto* self = GST_UDP_BATCH_SRC(src);
+    auto& s    = *self->state;
+
+    GST_OBJECT_LOCK(self);
+    const auto settings = s.settings;
+    const auto mtu      = s.mtu;
+    GST_OBJECT_UNLOCK(self);
+
+    auto receiver = udp_batch_receiver_t::create(settings);
+    if(!receiver.has_value())
+    {
+        GST_ELEMENT_ERROR(self, RESOURCE, OPEN_READ, ("Failed opening UDP socket"), ("%s", receiver.error().what()));
+        return FALSE;
+    }
+    GST_OBJECT_LOCK(self);
+    s.receiver = std::move(receiver.value());
+    s.retarget = false;
+    GST_OBJECT_UNLOCK(self);
+
+    // Twice the batch, so a batch can be filled while the previous one is still travelling downstream.
+    const auto batch = static_cast<guint>(settings.batch_size);
+    s.pool           = gst_buffer_pool_new();
+    auto config      = gst_buffer_pool_get_config(s.pool);
+    gst_buffer_pool_config_set_params(config, nullptr, mtu, 2 * batch, 0);
+    if(!gst_buffer_pool_set_config(s.pool, config) || !gst_buffer_pool_set_active(s.pool, TRUE))
+    {
+        GST_ELEMENT_ERROR(self, RESOURCE, OPEN_READ, ("Failed configuring the buffer pool"), (nullptr));
+        return FALSE;
+    }
+
+    s.slots.assign(settings.batch_size, slot_t{});
+    s.iovs.assign(settings.batch_size, iovec{});
+    s.truncated = 0;
+
+    GST_INFO_OBJECT(self, "Receiving on %s:%u, batches of %u", settings.address.c_str(), settings.port, batch);
+    return TRUE;
+}
+
+static gboolean gst_udp_batch_src_stop(GstBaseSrc* src)
+{
+    auto* self = GST_UDP_BATCH_SRC(src);
+    auto& s    = *self->state;
+
+    release_slots(s);
+    if(s.pool != nullptr)
+    {
+        gst_buffer_pool_set_active(s.pool, FALSE);
+        gst_object_unref(s.pool);
+        s.pool = nullptr;
+    }
+    GST_OBJECT_LOCK(self);
+    s.receiver.reset();
+    GST_OBJECT_UNLOCK(self);
+    return TRUE;
+}
+
+static gboolean gst_udp_batch_src_unlock(GstBaseSrc* src)
+{
+    auto& s = *GST_UDP_BATCH_SRC(src)->state;
+
+    GST_OBJECT_LOCK(src);
+    s.flushing = true;
+    if(s.receiver) s.receiver->interrupt();
+    GST_OBJECT_UNLOCK(src);
+    return TRUE;
+}
+
+static gboolean gst_udp_batch_src_unlock_stop(GstBaseSrc* src)
+{
+    auto& s = *GST_UDP_BATCH_SRC(src)->state;
+
+    GST_OBJECT_LOCK(src);
+    s.flushing = false;
+    if(s.receiver) s.receiver->clear_interrupt();
+    GST_OBJECT_UNLOCK(src);
+    return TRUE;
+}
+
+static GstFlowReturn gst_udp_batch_src_create(GstPushSrc* push_src, GstBuffer** buffer)
+{
+    auto* self = GST_UDP_BATCH_SRC(push_src);
+    auto& s    = *self->state;
+
+    for(;;)
+    {
+        if(s.flushing) return GST_FLOW_FLUSHING;
+
+        // Checked again after each switch, in case the target changed while the new socket was being opened.
+        if(s.retarget.exchange(false))
+        {
+            if(!retarget(self, s)) return GST_FLOW_ERROR;
+            continue;
+        }
+
+        if(!fill_slots(self, s)) return s.flushing ? GST_FLOW_FLUSHING : GST_FLOW_ERROR;
+
+        auto datagrams = s.receiver->receive(s.iovs, -1);
+        if(!datagrams.has_value())
+        {
+            GST_ELEMENT_ERROR(self, RESOURCE, READ, ("Failed receiving packets"), ("%s", datagrams.error().what()));
+            return GST_FLOW_ERROR;
+        }
+        if(datagrams->empty()) continue;
+
+        // Spread the batch's running time back over the packets using their kernel receive times.
+        const auto batch_time = running_time(self);
+        const auto last_ns    = datagrams->back().timestamp_ns;
+
+        auto* list = gst_buffer_list_new_sized(static_cast<guint>(datagrams->size()));
+        for(size_t i = 0; i < datagrams->size(); ++i)
+        {
+            const auto& d = (*datagrams)[i];
+            if(d.truncated)
+            {
+                ++s.truncated;
+                GST_WARNING_OBJECT(self, "Dropped datagram larger than the %" G_GSIZE_FORMAT " octet MTU",
+                                   static_cast<gsize>(s.iovs[i].iov_len));
+                continue;
+            }
+
+            auto& slot = s.slots[i];
+            auto* out  = slot.buffer;
+            gst_buffer_unmap(out, &slot.map);
+            slot.buffer = nullptr;
+            gst_buffer_set_size(out, d.size);
+
+            if(d.timestamp_ns != 0)
+            {
+                const auto received = static_cast<GstClockTime>(d.timestamp_ns);
+                gst_buffer_add_reference_timestamp_meta(out, s.timestamp_caps, received, GST_CLOCK_TIME_NONE);
+            }
+
+            if(GST_CLOCK_TIME_IS_VALID(batch_time))
+            {
+                const auto age = last_ns > d.timestamp_ns ? static_cast<GstClockTime>(last_ns - d.timestamp_ns) : 0;
+                GST_BUFFER_PTS(out) = batch_time > age ? batch_time - age : 0;
+            }
+
+            gst_buffer_list_add(list, out);
+        }
+
+        if(gst_buffer_list_length(list) == 0)
+        {
+            gst_buffer_list_unref(list);
+            continue;
+        }
+
+        gst_base_src_submit_buffer_list(GST_BASE_SRC(push_src), list);
+        *buffer = nullptr;
+        return GST_FLOW_OK;
+    }
+}
+
+static void gst_udp_batch_src_finalize(GObject* object)
+{
+    auto* s = GST_UDP_BATCH_SRC(object)->state;
+    gst_caps_replace(&s->caps, nullptr);
+    gst_caps_replace(&s->timestamp_caps, nullptr);
+    delete s;
+
+    G_OBJECT_CLASS(gst_udp_batch_src_parent_class)->finalize(object);
+}
+
+static void gst_udp_batch_src_class_init(GstUdpBatchSrcClass* klass)
+{
+    GObjectClass* object_class     = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+    GstBaseSrcClass* basesrc_class = GST_BASE_SRC_CLASS(klass);
+    GstPushSrcClass* pushsrc_class = GST_PUSH_SRC_CLASS(klass);
+
+    object_class->set_property = gst_udp_batch_src_set_property;
+    object_class->get_property = gst_udp_batch_src_get_property;
+    object_class->finalize     = gst_udp_batch_src_finalize;
+
+    const auto flags = (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Address),
+        g_param_spec_string("address", "Address", "Multicast group to join or local address to bind to", "0.0.0.0",
+                            flags));
+    g_object_class_install_property(object_class, static_cast<guint>(PropertyId::Port),
+                                    g_param_spec_int("port", "Port", "The port to receive packets from", 0, 65535,
+                                                     5004, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::MulticastIface),
+        g_param_spec_string("multicast-iface", "Multicast Interface", "Network interface to join the group on",
+                            nullptr, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Caps),
+        g_param_spec_boxed("caps", "Caps", "The caps of the source pad", GST_TYPE_CAPS, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::BufferSize),
+        g_param_spec_int("buffer-size", "Buffer Size", "Size of the kernel receive buffer in bytes, 0 = default", 0,
+                         G_MAXINT, 0, flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::BatchSize),
+        g_param_spec_uint("batch-size", "Batch Size", "Maximum number of packets per recvmmsg call", 1, 1024, 64,
+                          flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Mtu),
+        g_param_spec_uint("mtu", "MTU", "Largest datagram accepted; larger ones are dropped", 64, 65535, default_mtu,
+                          flags));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::DatagramsTruncated),
+        g_param_spec_uint64("datagrams-truncated", "Datagrams Truncated", "Datagrams dropped for exceeding the MTU",
+                            0, G_MAXUINT64, 0, (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::SourceAddress),
+        g_param_spec_string("source-address", "Source Address",
+                            "Only receive the group from this source (source-specific multicast), empty for any",
+                            nullptr, flags));
+
+    gst_element_class_add_static_pad_template(element_class, &src_template);
+
+    gst_element_class_set_static_metadata(element_class, "Batched UDP source", "Source/Network",
+                                          "Receives UDP packets in recvmmsg batches with kernel timestamps",
+                                          "Luis Ferreira <luis.ferreira@bisect.pt>");
+
+    basesrc_class->start       = gst_udp_batch_src_start;
+    basesrc_class->stop        = gst_udp_batch_src_stop;
+    basesrc_class->unlock      = gst_udp_batch_src_unlock;
+    basesrc_class->unlock_stop = gst_udp_batch_src_unlock_stop;
+    basesrc_class->get_caps    = gst_udp_batch_src_get_caps;
+    pushsrc_class->create      = gst_udp_batch_src_create;
+}
+
+static void gst_udp_batch_src_init(GstUdpBatchSrc* self)
+{
+    self->state                 = new src_state_t{};
+    self->state->timestamp_caps = gst_caps_new_empty_simple(arrival_timestamp_caps);
+
+    gst_base_src_set_live(GST_BASE_SRC(self), TRUE);
+    gst_base_src_set_format(GST_BASE_SRC(self), GST_FORMAT_TIME);
+}
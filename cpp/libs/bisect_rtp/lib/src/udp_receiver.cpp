@@ -0,0 +1,218 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/udp_receiver.h"
+#include "bisect/expected/macros.h"
+#include "udp_socket.h"
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr size_t control_words = (CMSG_SPACE(sizeof(timespec)) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    maybe_ok join_group(int fd, const sockaddr* group, const udp_receiver_settings_t& settings)
+    {
+        const auto ifindex = settings.interface_name.empty() ? 0u : if_nametoindex(settings.interface_name.c_str());
+
+        if(!settings.source_address.empty())
+        {
+            // The protocol-independent join picks the interface by index, so interface_address is not used here.
+            BST_ASSIGN(source, detail::resolve(settings.source_address, nullptr, group->sa_family, AI_NUMERICHOST));
+            const auto group_size = group->sa_family == AF_INET ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
+            group_source_req req{};
+            req.gsr_interface = ifindex;
+            std::memcpy(&req.gsr_group, group, group_size);
+            std::memcpy(&req.gsr_source, source->ai_addr, source->ai_addrlen);
+            const auto level = group->sa_family == AF_INET ? IPPROTO_IP : IPPROTO_IPV6;
+            BST_ENFORCE(setsockopt(fd, level, MCAST_JOIN_SOURCE_GROUP, &req, sizeof(req)) == 0,
+                        "failed joining multicast group {} from source {}: {}", settings.address,
+                        settings.source_address, std::strerror(errno));
+            return {};
+        }
+
+        if(group->sa_family == AF_INET)
+        {
+            ip_mreqn mreq{};
+            mreq.imr_multiaddr = reinterpret_cast<const sockaddr_in*>(group)->sin_addr;
+            mreq.imr_ifindex   = static_cast<int>(ifindex);
+            if(ifindex == 0 && !settings.interface_address.empty())
+            {
+                BST_ENFORCE(inet_pton(AF_INET, settings.interface_address.c_str(), &mreq.imr_address) == 1,
+                            "invalid interface address {}", settings.interface_address);
+            }
+            BST_ENFORCE(setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0,
+                        "failed joining multicast group: {}", std::strerror(errno));
+            return {};
+        }
+
+        ipv6_mreq mreq{};
+        mreq.ipv6mr_multiaddr = reinterpret_cast<const sockaddr_in6*>(group)->sin6_addr;
+        mreq.ipv6mr_interface = ifindex;
+        BST_ENFORCE(setsockopt(fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq, sizeof(mreq)) == 0,
+                    "failed joining multicast group: {}", std::strerror(errno));
+        return {};
+    }
+
+    int64_t kernel_timestamp(msghdr& hdr)
+    {
+        for(auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+        {
+            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                return int64_t{ts.tv_sec} * 1'000'000'000 + ts.tv_nsec;
+            }
+        }
+        return 0;
+    }
+} // namespace
+
+expected<udp_batch_receiver_uptr> udp_batch_receiver_t::create(const udp_receiver_settings_t& settings) noexcept
+{
+    BST_ENFORCE(settings.batch_size > 0, "batch size must be greater than 0");
+
+    const auto host = settings.address.empty() ? std::string("0.0.0.0") : settings.address;
+    const auto port = std::to_string(settings.port);
+    BST_ASSIGN(local, detail::resolve(host, port.c_str(), AF_UNSPEC, AI_NUMERICSERV | AI_PASSIVE));
+
+    const auto fd = socket(local->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    BST_ENFORCE(fd >= 0, "failed creating UDP socket: {}", std::strerror(errno));
+
+    const auto wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(wakeup_fd < 0)
+    {
+        close(fd);
+        BST_FAIL("failed creating eventfd: {}", std::strerror(errno));
+    }
+
+    // Owns both descriptors from here on.
+    auto receiver = udp_batch_receiver_uptr(new udp_batch_receiver_t(fd, wakeup_fd, settings.batch_size));
+
+    // Several receivers may listen to the same group and port, as with udpsrc.
+    const int on = 1;
+    BST_ENFORCE(setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) == 0, "failed setting SO_REUSEADDR: {}",
+                std::strerror(errno));
+    BST_ENFORCE(setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0,
+                "failed enabling SO_TIMESTAMPNS: {}", std::strerror(errno));
+
+    if(settings.receive_buffer_size > 0)
+    {
+        BST_ENFORCE(setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &settings.receive_buffer_size,
+                               sizeof(settings.receive_buffer_size)) == 0,
+                    "failed setting the receive buffer size: {}", std::strerror(errno));
+    }
+
+    // Binding to the group address keeps other groups on the same port out of this socket.
+    BST_ENFORCE(bind(fd, local->ai_addr, local->ai_addrlen) == 0, "failed binding to {}:{}: {}", host, settings.port,
+                std::strerror(errno));
+
+    if(detail::is_multicast(local->ai_addr))
+    {
+        BST_CHECK(join_group(fd, local->ai_addr, settings));
+    }
+
+    return receiver;
+}
+
+udp_batch_receiver_t::udp_batch_receiver_t(int fd, int wakeup_fd, size_t batch_size)
+    : fd_(fd), wakeup_fd_(wakeup_fd), messages_(batch_size), control_(batch_size * control_words),
+      received_(batch_size)
+{
+}
+
+udp_batch_receiver_t::~udp_batch_receiver_t()
+{
+    close(wakeup_fd_);
+    close(fd_);
+}
+
+expected<std::span<const datagram_info_t>> udp_batch_receiver_t::receive(std::span<const iovec> slots,
+                                                                         int timeout_ms) noexcept
+{
+    const auto count = std::min(slots.size(), messages_.size());
+    if(count == 0) return std::span<const datagram_info_t>{};
+
+    pollfd fds[2] = {{.fd = fd_, .events = POLLIN, .revents = 0}, {.fd = wakeup_fd_, .events = POLLIN, .revents = 0}};
+    const auto ready = poll(fds, 2, timeout_ms);
+    if(ready < 0 && errno != EINTR)
+    {
+        BST_FAIL("poll failed: {}", std::strerror(errno));
+    }
+    if(ready <= 0 || (fds[1].revents & POLLIN) != 0 || (fds[0].revents & POLLIN) == 0)
+    {
+        return std::span<const datagram_info_t>{};
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto& hdr          = messages_[i].msg_hdr;
+        hdr                = {};
+        hdr.msg_iov        = const_cast<iovec*>(&slots[i]);
+        hdr.msg_iovlen     = 1;
+        hdr.msg_control    = &control_[i * control_words];
+        hdr.msg_controllen = control_words * sizeof(uint64_t);
+    }
+
+    const auto received = recvmmsg(fd_, messages_.data(), static_cast<unsigned int>(count), MSG_DONTWAIT, nullptr);
+    if(received < 0)
+    {
+        if(errno == EAGAIN || errno == EINTR) return std::span<const datagram_info_t>{};
+        BST_FAIL("recvmmsg failed: {}", std::strerror(errno));
+    }
+
+    for(size_t i = 0; i < static_cast<size_t>(received); ++i)
+    {
+        auto& m      = messages_[i];
+        received_[i] = {.size         = m.msg_len,
+                        .truncated    = (m.msg_hdr.msg_flags & MSG_TRUNC) != 0,
+                        .timestamp_ns = kernel_timestamp(m.msg_hdr)};
+    }
+
+    return std::span<const datagram_info_t>(received_.data(), static_cast<size_t>(received));
+}
+
+void udp_batch_receiver_t::interrupt() noexcept
+{
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(wakeup_fd_, &one, sizeof(one));
+}
+
+void udp_batch_receiver_t::clear_interrupt() noexcept
+{
+    uint64_t value;
+    [[maybe_unused]] const auto read_size = read(wakeup_fd_, &value, sizeof(value));
+}
+
+uint16_t udp_batch_receiver_t::port() const noexcept
+{
+    sockaddr_storage address{};
+    socklen_t size = sizeof(address);
+    if(getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &size) != 0) return 0;
+
+    return ntohs(address.ss_family == AF_INET ? reinterpret_cast<const sockaddr_in&>(address).sin_port
+                                              : reinterpret_cast<const sockaddr_in6&>(address).sin6_port);
+}
@@ -0,0 +1,226 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/udp_sender.h"
+#include "bisect/expected/macros.h"
+#include "udp_socket.h"
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+namespace
+{
+    // Kernel limits for one UDP_SEGMENT send.
+    constexpr size_t max_gso_segments = 64;
+    constexpr size_t max_gso_octets   = 65507;
+
+    constexpr size_t control_words = (CMSG_SPACE(sizeof(uint16_t)) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    maybe_ok set_multicast_options(int fd, int family, const udp_sender_settings_t& settings)
+    {
+        const auto ifindex = settings.interface_name.empty() ? 0u : if_nametoindex(settings.interface_name.c_str());
+
+        if(family == AF_INET)
+        {
+            BST_ENFORCE(setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &settings.multicast_ttl,
+                                   sizeof(settings.multicast_ttl)) == 0,
+                        "failed setting multicast TTL: {}", std::strerror(errno));
+            if(ifindex != 0)
+            {
+                ip_mreqn mreq{};
+                mreq.imr_ifindex = static_cast<int>(ifindex);
+                BST_ENFORCE(setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq)) == 0,
+                            "failed selecting multicast interface {}: {}", settings.interface_name,
+                            std::strerror(errno));
+            }
+            return {};
+        }
+
+        BST_ENFORCE(setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &settings.multicast_ttl,
+                               sizeof(settings.multicast_ttl)) == 0,
+                    "failed setting multicast hops: {}", std::strerror(errno));
+        if(ifindex != 0)
+        {
+            const int index = static_cast<int>(ifindex);
+            BST_ENFORCE(setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index)) == 0,
+                        "failed selecting multicast interface {}: {}", settings.interface_name, std::strerror(errno));
+        }
+        return {};
+    }
+} // namespace
+
+expected<udp_batch_sender_uptr> udp_batch_sender_t::create(const udp_sender_settings_t& settings) noexcept
+{
+    BST_ENFORCE(settings.batch_size > 0, "batch size must be greater than 0");
+
+    const auto port = std::to_string(settings.destination_port);
+    BST_ASSIGN(destination, detail::resolve(settings.destination_address, port.c_str(), AF_UNSPEC, AI_NUMERICSERV));
+
+    sockaddr_storage address{};
+    const auto address_size = destination->ai_addrlen;
+    const auto family       = destination->ai_family;
+    std::memcpy(&address, destination->ai_addr, address_size);
+
+    const auto fd = socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    BST_ENFORCE(fd >= 0, "failed creating UDP socket: {}", std::strerror(errno));
+
+    // Bound to fd from here on, so every early return below closes the socket.
+    auto sender = udp_batch_sender_uptr(new udp_batch_sender_t(fd, address, address_size, settings.batch_size, false));
+
+    if(!settings.source_address.empty())
+    {
+        BST_ASSIGN(source, detail::resolve(settings.source_address, nullptr, family, AI_NUMERICHOST | AI_PASSIVE));
+        BST_ENFORCE(bind(fd, source->ai_addr, source->ai_addrlen) == 0, "failed binding to {}: {}",
+                    settings.source_address, std::strerror(errno));
+    }
+
+    if(detail::is_multicast(reinterpret_cast<const sockaddr*>(&address)))
+    {
+        BST_CHECK(set_multicast_options(fd, family, settings));
+    }
+
+    if(settings.gso)
+    {
+        // Probing with a segment size of 0 leaves segmentation per call but fails on kernels without GSO.
+        const int probe = 0;
+        sender->gso_    = setsockopt(fd, SOL_UDP, UDP_SEGMENT, &probe, sizeof(probe)) == 0;
+    }
+
+    return sender;
+}
+
+udp_batch_sender_t::udp_batch_sender_t(int fd, const sockaddr_storage& destination, socklen_t destination_size,
+                                       size_t batch_size, bool gso)
+    : fd_(fd), destination_(destination), destination_size_(destination_size), batch_size_(batch_size), gso_(gso),
+      messages_(batch_size), message_datagrams_(batch_size), control_(batch_size * control_words)
+{
+    // RTP payloaders produce at most a header and a payload memory per buffer; more parts only cost a reallocation.
+    iovs_.reserve(batch_size * 2);
+    datagrams_.reserve(batch_size);
+}
+
+udp_batch_sender_t::~udp_batch_sender_t()
+{
+    close(fd_);
+}
+
+maybe_ok udp_batch_sender_t::queue(std::span<const iovec> parts) noexcept
+{
+    if(datagrams_.size() == batch_size_)
+    {
+        BST_CHECK(flush());
+    }
+
+    size_t size = 0;
+    for(const auto& part : parts)
+    {
+        size += part.iov_len;
+    }
+
+    datagrams_.push_back({.first_iov = static_cast<uint32_t>(iovs_.size()),
+                          .iov_count = static_cast<uint32_t>(parts.size()),
+                          .size      = static_cast<uint32_t>(size)});
+    iovs_.insert(iovs_.end(), parts.begin(), parts.end());
+    return {};
+}
+
+size_t udp_batch_sender_t::build_messages(size_t first) noexcept
+{
+    size_t count = 0;
+    for(auto i = first; i < datagrams_.size() && count < messages_.size(); ++count)
+    {
+        const auto& d   = datagrams_[i];
+        auto& hdr       = messages_[count].msg_hdr;
+        hdr             = {};
+        hdr.msg_name    = &destination_;
+        hdr.msg_namelen = destination_size_;
+        hdr.msg_iov     = &iovs_[d.first_iov];
+        hdr.msg_iovlen  = d.iov_count;
+
+        // A GSO run is equal-sized datagrams, optionally ending with a shorter one. Their iovecs are contiguous.
+        auto j = i + 1;
+        if(gso_ && d.size > 0)
+        {
+            const auto max_segments = std::min(max_gso_segments, max_gso_octets / d.size);
+            while(j < datagrams_.size() && j - i < max_segments && datagrams_[j - 1].size == d.size &&
+                  datagrams_[j].size <= d.size)
+            {
+                hdr.msg_iovlen += datagrams_[j].iov_count;
+                ++j;
+            }
+        }
+
+        if(j - i > 1)
+        {
+            hdr.msg_control    = &control_[count * control_words];
+            hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+            auto* cmsg         = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level   = SOL_UDP;
+            cmsg->cmsg_type    = UDP_SEGMENT;
+            cmsg->cmsg_len     = CMSG_LEN(sizeof(uint16_t));
+            const auto segment = static_cast<uint16_t>(d.size);
+            std::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+        }
+
+        message_datagrams_[count] = static_cast<uint32_t>(j - i);
+        i                         = j;
+    }
+
+    return count;
+}
+
+maybe_ok udp_batch_sender_t::flush() noexcept
+{
+    size_t next = 0;
+    while(next < datagrams_.size())
+    {
+        const auto count = build_messages(next);
+        const auto sent  = sendmmsg(fd_, messages_.data(), static_cast<unsigned int>(count), 0);
+        ++send_calls_;
+
+        if(sent < 0)
+        {
+            if(errno == EINTR) continue;
+            if(gso_ && errno == EIO)
+            {
+                // The egress device cannot segment; retry the same datagrams one by one.
+                gso_ = false;
+                continue;
+            }
+
+            const auto error = errno;
+            iovs_.clear();
+            datagrams_.clear();
+            BST_FAIL("sendmmsg failed: {}", std::strerror(error));
+        }
+
+        for(int m = 0; m < sent; ++m)
+        {
+            next += message_datagrams_[static_cast<size_t>(m)];
+        }
+    }
+
+    datagrams_sent_ += datagrams_.size();
+    iovs_.clear();
+    datagrams_.clear();
+    return {};
+}
@@ -0,0 +1,45 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "udp_socket.h"
+#include "bisect/expected/macros.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+using namespace bisect;
+using namespace bisect::rtp;
+
+expected<detail::addrinfo_uptr> detail::resolve(const std::string& host, const char* service, int family,
+                                                int flags) noexcept
+{
+    addrinfo hints{};
+    hints.ai_family   = family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = flags;
+
+    addrinfo* result = nullptr;
+    const auto error = getaddrinfo(host.c_str(), service, &hints, &result);
+    BST_ENFORCE(error == 0 && result != nullptr, "failed resolving '{}': {}", host, gai_strerror(error));
+    return addrinfo_uptr(result, &freeaddrinfo);
+}
+
+bool detail::is_multicast(const sockaddr* address) noexcept
+{
+    if(address->sa_family == AF_INET)
+    {
+        return IN_MULTICAST(ntohl(reinterpret_cast<const sockaddr_in*>(address)->sin_addr.s_addr));
+    }
+    return address->sa_family == AF_INET6 &&
+           IN6_IS_ADDR_MULTICAST(&reinterpret_cast<const sockaddr_in6*>(address)->sin6_addr);
+}
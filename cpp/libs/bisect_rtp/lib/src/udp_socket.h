@@ -0,0 +1,31 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/expected.h"
+#include <netdb.h>
+#include <sys/socket.h>
+#include <memory>
+#include <string>
+
+// Socket helpers shared by the UDP sender and receiver.
+namespace bisect::rtp::detail
+{
+    using addrinfo_uptr = std::unique_ptr<addrinfo, decltype(&freeaddrinfo)>;
+
+    expected<addrinfo_uptr> resolve(const std::string& host, const char* service, int family, int flags) noexcept;
+
+    bool is_multicast(const sockaddr* address) noexcept;
+} // namespace bisect::rtp::detail
@@ -0,0 +1,168 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/depacketizer.h"
+#include "bisect/rtp/packetizer.h"
+#include "bisect/rtp/pgroup.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <vector>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr size_t max_payload = 1428;
+
+    // Builds the RTP payloads of a frame whose pgroup octets follow a counter.
+    std::vector<std::vector<uint8_t>> packetize(const frame_layout_t& layout, const std::vector<uint8_t>& frame)
+    {
+        const size_t line_octets = layout.width / pgroup_pixels * pgroup_octets;
+
+        std::vector<std::vector<uint8_t>> payloads;
+        uint16_t esn = 0;
+        for(const auto& p : layout.packets)
+        {
+            std::vector<uint8_t> payload(p.payload_octets);
+            auto* out = payload.data() + write_payload_header(p, esn++, payload.data());
+            for(uint8_t i = 0; i < p.srd_count; ++i)
+            {
+                const auto& srd  = p.srds[i];
+                const auto* line = frame.data() + srd.line * line_octets;
+                std::copy_n(line + srd.offset / pgroup_pixels * pgroup_octets, srd.length, out);
+                out += srd.length;
+            }
+            payloads.push_back(std::move(payload));
+        }
+        return payloads;
+    }
+
+    std::vector<uint8_t> make_frame(uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> frame(width / pgroup_pixels * pgroup_octets * height);
+        for(size_t i = 0; i < frame.size(); ++i)
+            frame[i] = uint8_t(i * 31 + 7);
+        return frame;
+    }
+} // namespace
+
+TEST(bisect_rtp, depacketizer_round_trip)
+{
+    for(const auto mode : {packing_mode_t::gpm, packing_mode_t::bpm})
+    {
+        const auto layout = plan_frame(1280, 720, mode, max_payload).value();
+        const auto frame  = make_frame(1280, 720);
+
+        // Use a padded stride, as GstVideoInfo may round it up.
+        frame_assembler_t assembler(1280, 720);
+        const size_t stride = assembler.line_octets() + 4;
+        std::vector<uint8_t> out(stride * 720);
+        assembler.begin(out.data(), stride);
+
+        for(const auto& payload : packetize(layout, frame))
+            ASSERT_TRUE(assembler.add_payload(payload.data(), payload.size()));
+
+        ASSERT_TRUE(assembler.is_complete());
+        for(uint32_t line = 0; line < 720; ++line)
+        {
+            const auto first = static_cast<std::ptrdiff_t>(line * assembler.line_octets());
+            const auto last  = static_cast<std::ptrdiff_t>((line + 1) * assembler.line_octets());
+            ASSERT_TRUE(std::equal(frame.begin() + first, frame.begin() + last,
+                                   out.begin() + static_cast<std::ptrdiff_t>(line * stride)));
+        }
+    }
+}
+
+TEST(bisect_rtp, depacketizer_reports_missing_lines)
+{
+    const auto layout   = plan_frame(1920, 1080, packing_mode_t::gpm, max_payload).value();
+    const auto payloads = packetize(layout, make_frame(1920, 1080));
+
+    frame_assembler_t assembler(1920, 1080);
+    std::vector<uint8_t> out(assembler.line_octets() * 1080);
+    assembler.begin(out.data(), assembler.line_octets());
+
+    for(size_t i = 0; i < payloads.size(); ++i)
+    {
+        if(i == payloads.size() / 2) continue;
+        ASSERT_TRUE(assembler.add_payload(payloads[i].data(), payloads[i].size()));
+    }
+
+    ASSERT_FALSE(assembler.is_complete());
+    ASSERT_LT(assembler.complete_lines(), 1080u);
+    ASSERT_GE(assembler.complete_lines(), 1078u);
+    ASSERT_TRUE(assembler.is_line_complete(0));
+    ASSERT_TRUE(assembler.is_line_complete(1079));
+
+    // begin() resets the bookkeeping for the next frame.
+    assembler.begin(out.data(), assembler.line_octets());
+    ASSERT_EQ(assembler.complete_lines(), 0u);
+    ASSERT_FALSE(assembler.is_line_complete(0));
+}
+
+TEST(bisect_rtp, depacketizer_counts_duplicate_segments_once)
+{
+    const auto layout   = plan_frame(1920, 1080, packing_mode_t::gpm, max_payload).value();
+    const auto payloads = packetize(layout, make_frame(1920, 1080));
+    const auto lost     = payloads.size() / 2;
+
+    // The same packets with one lost, received once, then with the packet after the lost one received twice.
+    frame_assembler_t reference(1920, 1080);
+    frame_assembler_t assembler(1920, 1080);
+    std::vector<uint8_t> out(assembler.line_octets() * 1080);
+    reference.begin(out.data(), reference.line_octets());
+    assembler.begin(out.data(), assembler.line_octets());
+
+    for(size_t i = 0; i < payloads.size(); ++i)
+    {
+        if(i == lost) continue;
+        ASSERT_TRUE(reference.add_payload(payloads[i].data(), payloads[i].size()));
+        ASSERT_TRUE(assembler.add_payload(payloads[i].data(), payloads[i].size()));
+        if(i == lost + 1)
+        {
+            ASSERT_TRUE(assembler.add_payload(payloads[i].data(), payloads[i].size()));
+        }
+    }
+
+    ASSERT_FALSE(assembler.is_complete());
+    ASSERT_EQ(assembler.complete_lines(), reference.complete_lines());
+    for(uint32_t line = 0; line < 1080; ++line)
+        ASSERT_EQ(assembler.is_line_complete(line), reference.is_line_complete(line)) << "line " << line;
+}
+
+TEST(bisect_rtp, depacketizer_rejects_out_of_range)
+{
+    frame_assembler_t assembler(64, 4);
+    std::vector<uint8_t> out(assembler.line_octets() * 4);
+    assembler.begin(out.data(), assembler.line_octets());
+
+    packet_layout_t p{};
+    p.srds[0]        = {.line = 4, .offset = 0, .length = 10};
+    p.srd_count      = 1;
+    p.payload_octets = payload_header_octets + srd_header_octets + 10;
+
+    std::vector<uint8_t> payload(p.payload_octets);
+    write_payload_header(p, 0, payload.data());
+    ASSERT_FALSE(assembler.add_payload(payload.data(), payload.size()));
+
+    p.srds[0] = {.line = 0, .offset = 62, .length = 10};
+    write_payload_header(p, 0, payload.data());
+    ASSERT_FALSE(assembler.add_payload(payload.data(), payload.size()));
+
+    // Truncated sample data.
+    p.srds[0] = {.line = 0, .offset = 0, .length = 10};
+    write_payload_header(p, 0, payload.data());
+    ASSERT_FALSE(assembler.add_payload(payload.data(), payload.size() - 1));
+    ASSERT_EQ(assembler.complete_lines(), 0u);
+}
@@ -0,0 +1,265 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/paced_sender.h"
+#include "bisect/rtp/pacing.h"
+#include "bisect/rtp/udp_receiver.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr video_timing_t p1080_5994{.rate_num = 60000, .rate_den = 1001, .height = 1080};
+    constexpr video_timing_t i1080_2997{.rate_num = 30000, .rate_den = 1001, .height = 1080, .interlaced = true};
+
+    // Reads datagrams on its own thread, keeping the first octet of each, until `expected` arrived or none came for
+    // a second.
+    struct tag_reader_t
+    {
+        std::unique_ptr<udp_batch_receiver_t> receiver;
+        std::vector<uint8_t> tags;
+        std::atomic<size_t> received = 0;
+        std::atomic<bool> done       = false;
+        std::thread thread;
+
+        explicit tag_reader_t(size_t expected)
+        {
+            udp_receiver_settings_t settings;
+            settings.address = "127.0.0.1";
+            receiver         = udp_batch_receiver_t::create(settings).value();
+
+            thread = std::thread([this, expected] {
+                std::vector<std::array<uint8_t, 1500>> buffers(64);
+                std::vector<iovec> slots;
+                for(auto& b : buffers)
+                    slots.push_back({b.data(), b.size()});
+
+                while(tags.size() < expected)
+                {
+                    const auto datagrams = receiver->receive(slots, 1000);
+                    if(!datagrams.has_value() || datagrams->empty()) break;
+                    for(size_t i = 0; i < datagrams->size(); ++i)
+                        tags.push_back(buffers[i][0]);
+                    received = tags.size();
+                }
+                done = true;
+            });
+        }
+
+        ~tag_reader_t()
+        {
+            if(thread.joinable()) thread.join();
+        }
+    };
+
+    paced_frame_t make_frame(std::array<uint8_t, 1200>& payload, uint32_t packets)
+    {
+        paced_frame_t frame;
+        frame.parts.assign(packets, iovec{payload.data(), payload.size()});
+        frame.packet_parts.assign(packets, 1);
+        return frame;
+    }
+} // namespace
+
+TEST(bisect_rtp, pacing_schedule_narrow_gapped)
+{
+    const auto s = pacing_schedule_t::create(p1080_5994, 4320, pacing_type_t::narrow).value();
+
+    ASSERT_EQ(s.frame_ns(), 16683333);
+    ASSERT_EQ(s.trs_ns(), 3707);
+    ASSERT_EQ(s.tro_ns(), 637674);
+    ASSERT_EQ(s.cmax(), 6u);
+    ASSERT_EQ(s.vrx_full(), 9u);
+
+    ASSERT_EQ(s.packet_offset_ns(0), s.tro_ns());
+    ASSERT_EQ(s.packet_offset_ns(4319), 16649966);
+
+    // 60000 frames at 59.94 Hz take exactly 1001 s.
+    ASSERT_EQ(s.frame_start_ns(60000), 1001'000'000'000);
+    ASSERT_EQ(s.frame_index_at_or_after(1001'000'000'000), 60000);
+    ASSERT_EQ(s.frame_index_at_or_after(1001'000'000'001), 60001);
+}
+
+TEST(bisect_rtp, pacing_schedule_types)
+{
+    const auto wide = pacing_schedule_t::create(p1080_5994, 4320, pacing_type_t::wide).value();
+    ASSERT_EQ(wide.cmax(), 16u);
+    ASSERT_EQ(wide.vrx_full(), 863u);
+
+    const auto linear = pacing_schedule_t::create(p1080_5994, 4320, pacing_type_t::narrow_linear).value();
+    ASSERT_EQ(linear.tro_ns(), 0);
+    ASSERT_EQ(linear.trs_ns(), 3861);
+
+    // The second field starts half a frame later, at its own TRO.
+    const auto interlaced = pacing_schedule_t::create(i1080_2997, 4320, pacing_type_t::narrow).value();
+    ASSERT_EQ(interlaced.packet_offset_ns(2160), 17335837);
+    ASSERT_LT(interlaced.packet_offset_ns(2159), interlaced.frame_ns() / 2);
+
+    ASSERT_FALSE(pacing_schedule_t::create({.rate_num = 0, .rate_den = 1, .height = 1080}, 10, pacing_type_t::narrow)
+                     .has_value());
+    ASSERT_FALSE(pacing_schedule_t::create(p1080_5994, 0, pacing_type_t::narrow).has_value());
+}
+
+TEST(bisect_rtp, conformance_of_ideal_schedule)
+{
+    const auto s = pacing_schedule_t::create(p1080_5994, 4320, pacing_type_t::narrow).value();
+    conformance_monitor_t monitor(s);
+
+    for(int64_t frame = 100; frame < 103; ++frame)
+    {
+        const auto start = s.frame_start_ns(frame);
+        monitor.begin_frame(start);
+        for(uint32_t k = 0; k < s.packets_per_frame(); ++k)
+        {
+            monitor.packet_sent(start + s.packet_offset_ns(k));
+        }
+    }
+
+    const auto& c = monitor.counters();
+    ASSERT_EQ(c.frames, 3u);
+    ASSERT_EQ(c.packets, 3u * 4320);
+    ASSERT_EQ(c.cinst_peak, 1u);
+    ASSERT_EQ(c.vrx_peak, 1u);
+    ASSERT_EQ(c.cmax_violations, 0u);
+    ASSERT_EQ(c.vrx_overflows, 0u);
+    ASSERT_EQ(c.vrx_underflows, 0u);
+}
+
+TEST(bisect_rtp, conformance_of_burst_and_late_packets)
+{
+    const auto s = pacing_schedule_t::create(p1080_5994, 4320, pacing_type_t::narrow).value();
+
+    // The whole frame at once, as rtpvrawpay and udpsink do.
+    conformance_monitor_t burst(s);
+    burst.begin_frame(s.frame_start_ns(0));
+    for(uint32_t k = 0; k < s.packets_per_frame(); ++k)
+    {
+        burst.packet_sent(s.tro_ns());
+    }
+    ASSERT_EQ(burst.counters().cinst_peak, 4320u);
+    ASSERT_EQ(burst.counters().cmax_violations, 4320u - s.cmax());
+    ASSERT_GT(burst.counters().vrx_overflows, 0u);
+
+    // Every other packet one TRS late.
+    conformance_monitor_t late(s);
+    late.begin_frame(s.frame_start_ns(0));
+    for(uint32_t k = 0; k < 100; ++k)
+    {
+        late.packet_sent(s.packet_offset_ns(k) + (k % 2 == 1 ? s.trs_ns() : 0));
+    }
+    ASSERT_EQ(late.counters().vrx_underflows, 50u);
+    ASSERT_EQ(late.counters().vrx_overflows, 0u);
+}
+
+TEST(bisect_rtp, paced_sender_spreads_frames)
+{
+    auto receiver = udp_batch_receiver_t::create({.address = "127.0.0.1", .port = 0, .batch_size = 64}).value();
+
+    constexpr uint32_t packets = 50;
+    constexpr uint32_t frames  = 3;
+    const video_timing_t timing{.rate_num = 50, .rate_den = 1, .height = 1080};
+    auto sender = paced_sender_t::create({.destination_address = "127.0.0.1", .destination_port = receiver->port()},
+                                         {.timing = timing, .type = pacing_type_t::wide})
+                      .value();
+
+    // Read while sending, so the socket buffer never has to hold more than a few packets.
+    std::vector<int64_t> arrivals;
+    std::thread reader([&] {
+        std::vector<std::array<uint8_t, 1500>> buffers(64);
+        std::vector<iovec> slots;
+        for(auto& b : buffers)
+            slots.push_back({b.data(), b.size()});
+
+        while(arrivals.size() < packets * frames)
+        {
+            const auto datagrams = receiver->receive(slots, 1000);
+            if(!datagrams.has_value() || datagrams->empty()) return;
+            for(const auto& d : *datagrams)
+                arrivals.push_back(d.timestamp_ns);
+        }
+    });
+
+    std::array<uint8_t, 1200> payload{};
+    uint32_t released = 0;
+    for(uint32_t f = 0; f < frames; ++f)
+    {
+        paced_frame_t frame;
+        frame.parts.assign(packets, iovec{payload.data(), payload.size()});
+        frame.packet_parts.assign(packets, 1);
+        frame.release = [&released] { ++released; };
+        ASSERT_TRUE(sender->send_frame(std::move(frame)).has_value());
+    }
+    sender->drain();
+    reader.join();
+    ASSERT_EQ(released, frames);
+    ASSERT_EQ(arrivals.size(), size_t{packets * frames});
+
+    // Each frame is spread over its active period (19.2 ms at 50 Hz) instead of leaving in a burst.
+    const auto schedule = sender->schedule().value();
+    const auto spread   = schedule.packet_offset_ns(packets - 1) - schedule.packet_offset_ns(0);
+    for(uint32_t f = 0; f < frames; ++f)
+    {
+        ASSERT_GT(arrivals[(f + 1) * packets - 1] - arrivals[f * packets], spread * 9 / 10);
+    }
+
+    const auto c = sender->counters();
+    ASSERT_EQ(c.frames, static_cast<uint64_t>(frames));
+    ASSERT_EQ(c.packets, static_cast<uint64_t>(packets * frames));
+    ASSERT_EQ(c.cmax_violations, 0u);
+    ASSERT_EQ(c.vrx_overflows, 0u);
+}
+
+TEST(bisect_rtp, paced_sender_retargets_between_frames)
+{
+    constexpr uint32_t packets = 50;
+    tag_reader_t old_destination(2 * packets);
+    tag_reader_t new_destination(packets);
+
+    udp_sender_settings_t network;
+    network.destination_address = "127.0.0.1";
+    network.destination_port    = old_destination.receiver->port();
+    pacing_settings_t pacing;
+    pacing.timing.rate_num = 50;
+    pacing.timing.rate_den = 1;
+    pacing.timing.height   = 1080;
+    pacing.type            = pacing_type_t::wide;
+    auto sender            = paced_sender_t::create(network, pacing).value();
+
+    std::array<uint8_t, 1200> old_payload;
+    std::array<uint8_t, 1200> new_payload;
+    old_payload.fill(1);
+    new_payload.fill(2);
+
+    ASSERT_TRUE(sender->send_frame(make_frame(old_payload, packets)).has_value());
+    ASSERT_TRUE(sender->send_frame(make_frame(old_payload, packets)).has_value());
+
+    // Switches while the first frame is being sent and the second one is queued.
+    while(old_destination.received == 0 && !old_destination.done)
+        std::this_thread::yield();
+    network.destination_port = new_destination.receiver->port();
+    ASSERT_TRUE(sender->retarget(network).has_value());
+    ASSERT_TRUE(sender->send_frame(make_frame(new_payload, packets)).has_value());
+    sender->drain();
+
+    old_destination.thread.join();
+    new_destination.thread.join();
+    ASSERT_EQ(old_destination.tags, std::vector<uint8_t>(2 * packets, 1));
+    ASSERT_EQ(new_destination.tags, std::vector<uint8_t>(packets, 2));
+    ASSERT_EQ(sender->counters().packets, uint64_t{3 * packets});
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/packetizer.h"
+#include "bisect/rtp/pgroup.h"
+#include <gtest/gtest.h>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr size_t max_payload = 1428;
+
+    size_t total_data(const frame_layout_t& layout)
+    {
+        size_t total = 0;
+        for(const auto& p : layout.packets)
+            for(uint8_t i = 0; i < p.srd_count; ++i)
+                total += p.srds[i].length;
+        return total;
+    }
+} // namespace
+
+TEST(bisect_rtp, gpm_covers_frame)
+{
+    const auto layout = plan_frame(1920, 1080, packing_mode_t::gpm, max_payload).value();
+
+    ASSERT_EQ(total_data(layout), 1920u / 2 * 5 * 1080);
+    for(const auto& p : layout.packets)
+    {
+        ASSERT_LE(p.payload_octets, max_payload);
+        ASSERT_GT(p.srd_count, 0);
+        for(uint8_t i = 0; i < p.srd_count; ++i)
+            ASSERT_EQ(p.srds[i].length % pgroup_octets, 0u);
+    }
+
+    const auto& last = layout.packets.back();
+    ASSERT_EQ(last.srds[last.srd_count - 1].line, 1079);
+}
+
+TEST(bisect_rtp, bpm_packets_are_fixed_size)
+{
+    const auto layout = plan_frame(1920, 1080, packing_mode_t::bpm, max_payload).value();
+
+    ASSERT_EQ(total_data(layout), 1920u / 2 * 5 * 1080);
+    for(size_t i = 0; i + 1 < layout.packets.size(); ++i)
+    {
+        const auto& p = layout.packets[i];
+        ASSERT_EQ(p.payload_octets - payload_header_octets - p.srd_count * srd_header_octets, bpm_data_octets);
+    }
+}
+
+TEST(bisect_rtp, rejects_odd_width)
+{
+    ASSERT_FALSE(plan_frame(1919, 1080, packing_mode_t::gpm, max_payload).has_value());
+}
+
+TEST(bisect_rtp, payload_header_layout)
+{
+    packet_layout_t p{};
+    p.srds[0]   = {.line = 5, .offset = 1916, .length = 20};
+    p.srds[1]   = {.line = 6, .offset = 0, .length = 100};
+    p.srd_count = 2;
+
+    uint8_t out[payload_header_octets + 2 * srd_header_octets];
+    ASSERT_EQ(write_payload_header(p, 0x1234, out), sizeof(out));
+
+    const uint8_t expected[] = {0x12, 0x34,                         // ESN
+                                0x00, 20, 0x00, 5, 0x80 | 0x07, 0x7c, // continuation set
+                                0x00, 100, 0x00, 6, 0x00, 0x00};
+    for(size_t i = 0; i < sizeof(out); ++i)
+        ASSERT_EQ(out[i], expected[i]) << "at " << i;
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/pgroup.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr size_t width = 1920;
+
+    struct planar_line_t
+    {
+        std::vector<uint16_t> y  = std::vector<uint16_t>(width);
+        std::vector<uint16_t> cb = std::vector<uint16_t>(width / 2);
+        std::vector<uint16_t> cr = std::vector<uint16_t>(width / 2);
+
+        frame_view_t view() const
+        {
+            return {.layout  = pixel_layout_t::i422_10le,
+                    .planes  = {reinterpret_cast<const uint8_t*>(y.data()), reinterpret_cast<const uint8_t*>(cb.data()),
+                                reinterpret_cast<const uint8_t*>(cr.data())},
+                    .strides = {width * 2, width, width}};
+        }
+    };
+
+    planar_line_t random_line()
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<uint16_t> dist(0, 1023);
+        planar_line_t l;
+        for(auto& s : l.y)
+            s = dist(gen);
+        for(auto& s : l.cb)
+            s = dist(gen);
+        for(auto& s : l.cr)
+            s = dist(gen);
+        return l;
+    }
+
+    std::vector<uint8_t> to_v210(const planar_line_t& l)
+    {
+        std::vector<uint8_t> out(width / 6 * 16);
+        for(size_t b = 0; b < width / 6; ++b)
+        {
+            uint16_t s[12];
+            for(size_t i = 0; i < 3; ++i)
+            {
+                s[i * 4 + 0] = l.cb[b * 3 + i];
+                s[i * 4 + 1] = l.y[b * 6 + i * 2];
+                s[i * 4 + 2] = l.cr[b * 3 + i];
+                s[i * 4 + 3] = l.y[b * 6 + i * 2 + 1];
+            }
+            for(size_t w = 0; w < 4; ++w)
+            {
+                const uint32_t word = s[w * 3] | (s[w * 3 + 1] << 10) | (uint32_t(s[w * 3 + 2]) << 20);
+                for(size_t k = 0; k < 4; ++k)
+                    out[b * 16 + w * 4 + k] = uint8_t(word >> (8 * k));
+            }
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> pack(const frame_view_t& view, size_t offset, size_t count, isa_t isa)
+    {
+        // Guard zone after the output to catch vector stores overrunning `dst`.
+        std::vector<uint8_t> out(count / pgroup_pixels * pgroup_octets + 32, 0xa5);
+        pack_pgroups(view, 0, offset, count, out.data(), isa);
+        for(size_t i = count / pgroup_pixels * pgroup_octets; i < out.size(); ++i)
+            EXPECT_EQ(out[i], 0xa5) << "overrun at " << i;
+        out.resize(count / pgroup_pixels * pgroup_octets);
+        return out;
+    }
+} // namespace
+
+TEST(bisect_rtp, pgroup_bit_layout)
+{
+    planar_line_t l;
+    l.cb[0] = 0x3ff;
+    l.y[0]  = 0x000;
+    l.cr[0] = 0x155;
+    l.y[1]  = 0x2aa;
+
+    const auto out = pack(l.view(), 0, 2, isa_t::scalar);
+    // 1111111111 0000000000 0101010101 1010101010
+    const std::vector<uint8_t> expected{0xff, 0xc0, 0x05, 0x56, 0xaa};
+    ASSERT_EQ(out, expected);
+}
+
+TEST(bisect_rtp, i422_10le_kernels_match_scalar)
+{
+    const auto l    = random_line();
+    const auto view = l.view();
+
+    for(const auto isa : {isa_t::sse4, isa_t::avx2})
+    {
+        if(static_cast<int>(isa) > static_cast<int>(detect_isa())) continue;
+        for(const auto& [offset, count] : {std::pair<size_t, size_t>{0, width}, {2, 1598}, {100, 26}, {0, 6}})
+        {
+            ASSERT_EQ(pack(view, offset, count, isa), pack(view, offset, count, isa_t::scalar))
+                << "isa " << static_cast<int>(isa) << " offset " << offset << " count " << count;
+        }
+    }
+}
+
+TEST(bisect_rtp, v210_matches_planar)
+{
+    const auto l    = random_line();
+    const auto v210 = to_v210(l);
+    const frame_view_t view{.layout = pixel_layout_t::v210, .planes = {v210.data()}, .strides = {v210.size()}};
+
+    for(const auto isa : {isa_t::scalar, isa_t::sse4, isa_t::avx2})
+    {
+        if(static_cast<int>(isa) > static_cast<int>(detect_isa())) continue;
+        for(const auto& [offset, count] : {std::pair<size_t, size_t>{0, width}, {2, 1598}, {4, 14}, {0, 6}})
+        {
+            ASSERT_EQ(pack(view, offset, count, isa), pack(l.view(), offset, count, isa_t::scalar))
+                << "isa " << static_cast<int>(isa) << " offset " << offset << " count " << count;
+        }
+    }
+}
+
+TEST(bisect_rtp, uyvp_is_copied)
+{
+    const auto l      = random_line();
+    const auto packed = pack(l.view(), 0, width, isa_t::scalar);
+    const frame_view_t view{.layout = pixel_layout_t::uyvp, .planes = {packed.data()}, .strides = {packed.size()}};
+
+    ASSERT_EQ(pack(view, 40, 200, detect_isa()), pack(l.view(), 40, 200, isa_t::scalar));
+}
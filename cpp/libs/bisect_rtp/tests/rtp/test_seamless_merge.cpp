@@ -0,0 +1,131 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/seamless_merge.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace bisect::rtp;
+
+TEST(bisect_rtp, seamless_merge_window_size)
+{
+    ASSERT_TRUE(seamless_merge_t::create(1024).has_value());
+    ASSERT_FALSE(seamless_merge_t::create(1000).has_value());
+    ASSERT_FALSE(seamless_merge_t::create(1).has_value());
+    ASSERT_FALSE(seamless_merge_t::create(65536).has_value());
+}
+
+TEST(bisect_rtp, seamless_merge_fills_gaps_from_either_leg)
+{
+    auto merge = seamless_merge_t::create(64).value();
+
+    // Each leg loses every 10th packet, never the same one, and leg 1 runs 5 packets behind. The sequence numbers
+    // wrap.
+    constexpr uint16_t first = 65500;
+    constexpr int count      = 200;
+    std::vector<uint16_t> forwarded;
+    for(int i = 0; i < count + 5; ++i)
+    {
+        if(i < count && i % 10 != 3)
+        {
+            const auto seqnum = static_cast<uint16_t>(first + i);
+            if(merge.accept(0, seqnum)) forwarded.push_back(seqnum);
+        }
+        if(i >= 5 && (i - 5) % 10 != 8)
+        {
+            const auto seqnum = static_cast<uint16_t>(first + i - 5);
+            if(merge.accept(1, seqnum)) forwarded.push_back(seqnum);
+        }
+    }
+
+    // Every packet exactly once; those lost on leg 0 come 5 packets late from leg 1.
+    ASSERT_EQ(forwarded.size(), size_t{count});
+    std::sort(forwarded.begin(), forwarded.end(),
+              [](uint16_t a, uint16_t b) { return static_cast<int16_t>(static_cast<uint16_t>(a - first)) <
+                                                  static_cast<int16_t>(static_cast<uint16_t>(b - first)); });
+    for(int i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(forwarded[static_cast<size_t>(i)], static_cast<uint16_t>(first + i));
+    }
+
+    const auto& c = merge.counters();
+    ASSERT_EQ(c.forwarded, uint64_t{count});
+    ASSERT_EQ(c.legs[0].forwarded + c.legs[1].forwarded, uint64_t{count});
+    ASSERT_EQ(c.legs[0].forwarded, c.legs[0].received);
+    ASSERT_EQ(c.legs[1].forwarded, 20u);
+    ASSERT_EQ(c.legs[1].duplicates, c.legs[1].received - 20);
+    ASSERT_EQ(c.lost, 0u);
+    ASSERT_EQ(c.legs[0].late, 0u);
+    ASSERT_EQ(c.legs[1].late, 0u);
+
+    // Only what has left the 64 packet window, the first 136 sequence numbers, is accounted as lost.
+    ASSERT_EQ(c.legs[0].lost, 14u);
+    ASSERT_EQ(c.legs[1].lost, 13u);
+}
+
+TEST(bisect_rtp, seamless_merge_late_and_lost)
+{
+    auto merge = seamless_merge_t::create(16).value();
+
+    for(uint16_t s = 0; s < 40; ++s)
+    {
+        if(s != 10)
+        {
+            ASSERT_TRUE(merge.accept(0, s));
+        }
+    }
+
+    // Too old for the window, even though nobody forwarded it.
+    ASSERT_FALSE(merge.accept(1, 10));
+    ASSERT_FALSE(merge.accept(1, 23));
+    ASSERT_FALSE(merge.accept(1, 30));
+    ASSERT_TRUE(merge.accept(1, 40));
+
+    // A jump past the window counts the 44 skipped sequence numbers as lost on both legs.
+    ASSERT_TRUE(merge.accept(0, 100));
+
+    const auto& c = merge.counters();
+    ASSERT_EQ(c.legs[1].late, 2u);
+    ASSERT_EQ(c.legs[1].duplicates, 1u);
+    ASSERT_EQ(c.lost, 1u + 44u);
+    ASSERT_EQ(c.legs[0].lost, 2u + 44u);
+    ASSERT_EQ(c.legs[1].lost, 39u + 44u);
+}
+
+TEST(bisect_rtp, seamless_merge_resyncs_on_restart)
+{
+    auto merge = seamless_merge_t::create(16).value();
+
+    for(uint16_t s = 30000; s < 30100; ++s)
+    {
+        merge.accept(0, s);
+    }
+
+    // The sender restarted far behind: after a window of late packets, the merge follows the new stream.
+    int forwarded = 0;
+    for(uint16_t s = 100; s < 200; ++s)
+    {
+        if(merge.accept(0, s)) ++forwarded;
+    }
+
+    const auto& c = merge.counters();
+    ASSERT_EQ(c.resyncs, 1u);
+    ASSERT_EQ(c.legs[0].late, 16u);
+    ASSERT_EQ(forwarded, 100 - 16);
+
+    merge.reset();
+    ASSERT_TRUE(merge.accept(1, 5));
+    ASSERT_EQ(merge.counters().resyncs, 1u);
+}
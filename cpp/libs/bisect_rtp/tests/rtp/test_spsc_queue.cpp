@@ -0,0 +1,72 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/spsc_queue.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace bisect::rtp;
+
+TEST(bisect_rtp, spsc_queue_fills_and_drains_in_order)
+{
+    spsc_queue_t<std::string, 4> queue;
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.pop().has_value());
+
+    for(int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.push(std::to_string(i)));
+    }
+    ASSERT_FALSE(queue.push("full"));
+
+    ASSERT_EQ(queue.pop().value(), "0");
+    ASSERT_TRUE(queue.push("4"));
+    for(int i = 1; i <= 4; ++i)
+    {
+        ASSERT_EQ(queue.pop().value(), std::to_string(i));
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(bisect_rtp, spsc_queue_hands_over_between_threads)
+{
+    constexpr uint64_t count = 100'000;
+    spsc_queue_t<uint64_t, 64> queue;
+
+    std::thread producer([&] {
+        for(uint64_t i = 0; i < count;)
+        {
+            if(queue.push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    while(expected < count)
+    {
+        const auto value = queue.pop();
+        if(!value.has_value())
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(*value, expected);
+        ++expected;
+    }
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
@@ -0,0 +1,99 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/udp_receiver.h"
+#include "bisect/rtp/udp_sender.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    constexpr size_t slot_octets = 1500;
+
+    struct slots_t
+    {
+        std::vector<uint8_t> memory;
+        std::vector<iovec> iovs;
+
+        explicit slots_t(size_t count) : memory(count * slot_octets), iovs(count)
+        {
+            for(size_t i = 0; i < count; ++i)
+                iovs[i] = {memory.data() + i * slot_octets, slot_octets};
+        }
+    };
+} // namespace
+
+TEST(bisect_rtp, udp_receiver_reads_batches)
+{
+    auto receiver = udp_batch_receiver_t::create({.address = "127.0.0.1", .batch_size = 16}).value();
+    auto sender =
+        udp_batch_sender_t::create({.destination_address = "127.0.0.1", .destination_port = receiver->port()}).value();
+
+    constexpr size_t count = 40;
+    std::vector<std::vector<uint8_t>> payloads;
+    for(size_t i = 0; i < count; ++i)
+        payloads.emplace_back(100 + i, uint8_t(i));
+    for(const auto& p : payloads)
+    {
+        const iovec part{const_cast<uint8_t*>(p.data()), p.size()};
+        ASSERT_TRUE(sender->queue({&part, 1}).has_value());
+    }
+    ASSERT_TRUE(sender->flush().has_value());
+
+    slots_t slots(32);
+    size_t next = 0;
+    while(next < count)
+    {
+        const auto datagrams = receiver->receive(slots.iovs, 1000).value();
+        ASSERT_FALSE(datagrams.empty());
+        ASSERT_LE(datagrams.size(), 16u);
+
+        for(size_t i = 0; i < datagrams.size(); ++i, ++next)
+        {
+            ASSERT_EQ(datagrams[i].size, payloads[next].size());
+            ASSERT_FALSE(datagrams[i].truncated);
+            ASSERT_GT(datagrams[i].timestamp_ns, 0);
+            ASSERT_EQ(slots.memory[i * slot_octets], uint8_t(next));
+        }
+    }
+}
+
+TEST(bisect_rtp, udp_receiver_times_out_and_interrupts)
+{
+    auto receiver = udp_batch_receiver_t::create({.address = "127.0.0.1"}).value();
+    slots_t slots(4);
+
+    ASSERT_TRUE(receiver->receive(slots.iovs, 10).value().empty());
+
+    std::thread waker([&] { receiver->interrupt(); });
+    ASSERT_TRUE(receiver->receive(slots.iovs, -1).value().empty());
+    waker.join();
+
+    receiver->clear_interrupt();
+    ASSERT_TRUE(receiver->receive(slots.iovs, 10).value().empty());
+}
+
+TEST(bisect_rtp, udp_receiver_filters_by_source)
+{
+    const auto from_loopback = udp_batch_receiver_t::create(
+        {.address = "239.255.20.21", .source_address = "127.0.0.1", .interface_name = "lo"});
+    ASSERT_TRUE(from_loopback.has_value());
+
+    ASSERT_FALSE(udp_batch_receiver_t::create({.address = "239.255.20.21", .source_address = "not-an-address"})
+                     .has_value());
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/rtp/udp_sender.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+
+using namespace bisect::rtp;
+
+namespace
+{
+    struct receiver_t
+    {
+        int fd = -1;
+        uint16_t port = 0;
+
+        receiver_t()
+        {
+            fd = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            socklen_t size = sizeof(address);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&address), &size);
+            port = ntohs(address.sin_port);
+
+            timeval timeout{};
+            timeout.tv_sec = 1;
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            const int buffer = 4 * 1024 * 1024;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        }
+
+        ~receiver_t() { close(fd); }
+
+        std::vector<uint8_t> receive()
+        {
+            std::vector<uint8_t> data(2048);
+            const auto size = recv(fd, data.data(), data.size(), 0);
+            data.resize(size < 0 ? 0 : static_cast<size_t>(size));
+            return data;
+        }
+    };
+
+    // A header part and a payload part per datagram, as rtpbasepayload produces them.
+    void send_and_check(bool gso)
+    {
+        receiver_t receiver;
+        udp_sender_settings_t settings;
+        settings.destination_address = "127.0.0.1";
+        settings.destination_port    = receiver.port;
+        settings.batch_size          = 8;
+        settings.gso                 = gso;
+        auto sender                  = udp_batch_sender_t::create(settings).value();
+
+        constexpr size_t count = 20;
+        std::array<uint8_t, 12> header{};
+        std::vector<std::vector<uint8_t>> payloads;
+        for(size_t i = 0; i < count; ++i)
+            payloads.emplace_back(i + 1 == count ? 100 : 1000, uint8_t(i));
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            const std::array<iovec, 2> parts{iovec{header.data(), header.size()},
+                                             iovec{payloads[i].data(), payloads[i].size()}};
+            ASSERT_TRUE(sender->queue(parts).has_value());
+        }
+        ASSERT_TRUE(sender->flush().has_value());
+        ASSERT_EQ(sender->datagrams_sent(), count);
+        ASSERT_LT(sender->send_calls(), count);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            const auto data = receiver.receive();
+            ASSERT_EQ(data.size(), header.size() + payloads[i].size());
+            ASSERT_EQ(data.back(), uint8_t(i));
+        }
+    }
+} // namespace
+
+TEST(bisect_rtp, udp_sender_batches)
+{
+    send_and_check(false);
+}
+
+TEST(bisect_rtp, udp_sender_gso)
+{
+    send_and_check(true);
+}
+
+TEST(bisect_rtp, udp_sender_rejects_bad_destination)
+{
+    udp_sender_settings_t bad_address;
+    bad_address.destination_address = "not an address";
+    bad_address.destination_port    = 5004;
+    ASSERT_FALSE(udp_batch_sender_t::create(bad_address).has_value());
+
+    udp_sender_settings_t no_batch;
+    no_batch.destination_address = "127.0.0.1";
+    no_batch.batch_size          = 0;
+    ASSERT_FALSE(udp_batch_sender_t::create(no_batch).has_value());
+}
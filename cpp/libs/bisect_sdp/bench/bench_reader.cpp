@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reports the average time parse_sdp takes on a video and an audio SDP, and the time the reader it replaced takes
+// going through nmos-cpp's parser and a JSON representation.
+
+#include "bisect/sdp/reader.h"
+#include "nmos_reader.h"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace bisect;
+using namespace bisect::sdp;
+
+namespace
+{
+    constexpr auto video_sdp = "v=0\r\n"
+                               "o=- 1443716955 1443716956 IN IP4 192.168.1.10\r\n"
+                               "s=ST 2110-20 video\r\n"
+                               "t=0 0\r\n"
+                               "a=recvonly\r\n"
+                               "a=group:DUP primary secondary\r\n"
+                               "m=video 5004 RTP/AVP 96\r\n"
+                               "c=IN IP4 239.10.10.1/64\r\n"
+                               "a=source-filter: incl IN IP4 239.10.10.1 192.168.1.10\r\n"
+                               "a=rtpmap:96 raw/90000\r\n"
+                               "a=fmtp:96 sampling=YCbCr-4:2:2; width=1920; height=1080; exactframerate=30000/1001; "
+                               "depth=10; TCS=SDR; colorimetry=BT709; PM=2110GPM; SSN=ST2110-20:2017; interlace; "
+                               "TP=2110TPN\r\n"
+                               "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\r\n"
+                               "a=mediaclk:direct=0\r\n"
+                               "a=mid:primary\r\n"
+                               "m=video 5006 RTP/AVP 96\r\n"
+                               "c=IN IP4 239.10.20.1/64\r\n"
+                               "a=source-filter: incl IN IP4 239.10.20.1 192.168.2.10\r\n"
+                               "a=rtpmap:96 raw/90000\r\n"
+                               "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\r\n"
+                               "a=mediaclk:direct=0\r\n"
+                               "a=mid:secondary\r\n";
+
+    constexpr auto audio_sdp = "v=0\n"
+                               "o=- 7 8 IN IP4 192.168.1.20\n"
+                               "s=ST 2110-30 audio\n"
+                               "t=0 0\n"
+                               "a=ts-refclk:localmac=98-03-9b-8d-7e-5c\n"
+                               "a=mediaclk:sender\n"
+                               "m=audio 5008 RTP/AVP 97\n"
+                               "c=IN IP4 239.10.30.1/64\n"
+                               "a=source-filter: incl IN IP4 239.10.30.1 192.168.1.20\n"
+                               "a=rtpmap:97 L24/48000/8\n"
+                               "a=fmtp:97 channel-order=SMPTE2110.(SGRP,SGRP)\n"
+                               "a=ptime:0.125\n";
+
+    struct result_t
+    {
+        double average_us;
+        size_t failed;
+    };
+
+    template <typename F> result_t time_parses(const std::vector<std::string>& sdps, F&& parse)
+    {
+        size_t failed    = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for(const auto& sdp : sdps)
+        {
+            if(!parse(sdp).has_value()) ++failed;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return {std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(sdps.size()), failed};
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 200;
+    if(count == 0)
+    {
+        fprintf(stderr, "usage: %s [sdps of each kind]\n", argv[0]);
+        return -1;
+    }
+
+    std::vector<std::string> sdps(count, video_sdp);
+    sdps.insert(sdps.end(), count, audio_sdp);
+
+    const auto nmos = time_parses(sdps, [](const std::string& sdp) { return tests::parse_sdp_with_nmos(sdp); });
+    const auto ours = time_parses(sdps, [](const std::string& sdp) { return parse_sdp(sdp); });
+
+    fmt::print("{} SDPs, half video and half audio\n", sdps.size());
+    fmt::print("{:<24} {:>10} {:>8}\n", "reader", "us", "failed");
+    fmt::print("{:<24} {:>10.2f} {:>8}\n", "parse_sdp", ours.average_us, ours.failed);
+    fmt::print("{:<24} {:>10.2f} {:>8}\n", "nmos-cpp and JSON", nmos.average_us, nmos.failed);
+    return 0;
+}
@@ -24,5 +24,7 @@
 
 namespace bisect::sdp
 {
+    // Describes the essences of `settings` when there are more than one, and otherwise the essence of its own fields.
+    // The origin and its address always come from the latter.
     expected<std::string> build_sdp(const sdp_settings_t& settings);
 } // namespace bisect::sdp
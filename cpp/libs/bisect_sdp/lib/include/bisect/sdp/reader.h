@@ -16,10 +16,28 @@
 
 #include "bisect/sdp/settings.h"
 #include "bisect/expected.h"
+#include "bisect/expected/macros.h"
 
-#include <string>
+#include <string_view>
+#include <variant>
 
 namespace bisect::sdp
 {
-    expected<sdp_settings_t> parse_sdp(const std::string& sdp);
+    // Reads the ST 2110 settings of every essence of the session. Media descriptions grouped with a=group:DUP are read
+    // as the SMPTE 2022-7 legs of one essence.
+    expected<sdp_settings_t> parse_sdp(std::string_view sdp);
+
+    // Has the fields of `settings` describe its first essence in format F, e.g. the video of a session which also
+    // carries audio, for receivers of a single essence.
+    template <typename F> expected<sdp_settings_t> select_essence(sdp_settings_t settings)
+    {
+        for(const auto& e : settings.essences)
+        {
+            if(!std::holds_alternative<F>(e.format)) continue;
+
+            static_cast<essence_settings_t&>(settings) = e;
+            return settings;
+        }
+        BST_FAIL("SDP has no essence in the format of the receiver");
+    }
 } // namespace bisect::sdp
\ No newline at end of file
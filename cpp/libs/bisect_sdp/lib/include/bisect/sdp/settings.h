@@ -18,6 +18,7 @@
 #include "bisect/sdp/clocks.h"
 #include <string>
 #include <variant>
+#include <vector>
 
 namespace bisect::sdp
 {
@@ -33,16 +34,26 @@ namespace bisect::sdp
         std::string session_version;
     };
 
-    struct sdp_settings_t
+    // The settings of one stream: a media description, or the two grouped as the SMPTE 2022-7 legs of one stream by
+    // a=group:DUP.
+    struct essence_settings_t
     {
         using format_t = std::variant<bisect::nmoscpp::video_sender_info_t, bisect::nmoscpp::audio_sender_info_t>;
 
         format_t format;
-        origin_settings_t origin;
         rtp_settings_t rtp;
         bisect::nmoscpp::network_leg_t primary;
         std::optional<bisect::nmoscpp::network_leg_t> secondary;
         refclk_t ts_refclk;
         mediaclk_t mediaclk;
     };
+
+    // The inherited fields describe the first essence of the session, which is all that single essence senders and
+    // receivers need.
+    struct sdp_settings_t : essence_settings_t
+    {
+        origin_settings_t origin;
+        // Every essence of the session in the order of their media descriptions, the first one included.
+        std::vector<essence_settings_t> essences;
+    };
 } // namespace bisect::sdp
@@ -50,7 +50,7 @@ a=recvonly
                            fmt::arg("sess_version", f.origin.session_version), fmt::arg("source_ip", source_ip));
     }
 
-    std::string build_clock_info(const sdp::sdp_settings_t& f)
+    std::string build_clock_info(const sdp::essence_settings_t& f)
     {
         constexpr auto clock =
             R"({}
@@ -89,7 +89,8 @@ a=fmtp:{payload_type} sampling=YCbCr-4:2:2; width={width}; height={height}; exac
 )";
 
         const auto frame_rate_s = fmt::format("{}/{}", f.exact_framerate.numerator(), f.exact_framerate.denominator());
-        const auto interlace    = f.structure == nmos::interlace_modes::progressive ? "progressive" : "interlaced";
+        // ST 2110-20 signals interlaced video with a valueless parameter, and progressive video by its absence.
+        const auto interlace = f.structure == nmos::interlace_modes::progressive ? "" : " interlace;";
 
         return fmt::format(t, fmt::arg("media_type", media_type), fmt::arg("payload_type", rtp.payload_type),
                            fmt::arg("destination_port", destination_port), fmt::arg("width", f.width),
@@ -102,6 +103,7 @@ a=fmtp:{payload_type} sampling=YCbCr-4:2:2; width={width}; height={height}; exac
                                       const nmoscpp::audio_sender_info_t& f)
     {
         constexpr auto t = R"(m=audio {destination_port} RTP/AVP {payload_type}
+{connection}
 a=rtpmap:{payload_type} {type}/{sample_rate}/{channel_count}
 a=fmtp:{payload_type} channel-order={channel_order};
 a=ptime:{ptime}
@@ -110,20 +112,51 @@ a=maxptime:{ptime}
 
         const auto destination_port = net.destination_port.has_value() ? *net.destination_port : -1;
         // const auto type     = f.is_am824 ? "AM824" : fmt::format("L{}", as_bit_count(f.sample_format));
-        const auto type     = fmt::format("L{}", f.bits_per_sample);
-        const auto ptime_us = static_cast<double>(
-            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<float>(f.packet_time)).count());
-        const auto ptime = fmt::format("{:.3f}", ptime_us / 1000.0);
+        const auto type        = fmt::format("L{}", f.bits_per_sample);
+        const auto packet_time = std::chrono::duration<float, std::milli>(f.packet_time);
+        const auto ptime_us    = std::chrono::duration_cast<std::chrono::microseconds>(packet_time).count();
+        const auto ptime       = fmt::format("{:.3f}", static_cast<double>(ptime_us) / 1000.0);
 
         return fmt::format(t, fmt::arg("payload_type", rtp.payload_type), fmt::arg("channel_order", "SMPTE2110.(U02)"),
                            fmt::arg("destination_port", destination_port), fmt::arg("type", type),
                            fmt::arg("sample_rate", f.sampling_rate), fmt::arg("channel_count", f.number_of_channels),
-                           fmt::arg("ptime", ptime));
+                           fmt::arg("ptime", ptime), fmt::arg("connection", build_connection(net)));
+    }
+
+    // Each essence carries its own clocks, and the legs of each are grouped by their mids.
+    expected<std::string> build_essences(const sdp::sdp_settings_t& config)
+    {
+        std::string groups;
+        std::string media;
+        for(size_t i = 0; i < config.essences.size(); ++i)
+        {
+            const auto& e          = config.essences[i];
+            const auto clock_info  = build_clock_info(e);
+            const auto primary_mid = fmt::format("primary-{}", i);
+
+            BST_ASSIGN(primary_media,
+                       match(e.format, [&e](const auto& f) { return build_media(e.primary, e.rtp, f); }));
+            media += fmt::format("{}{}a=mid:{}\n", primary_media, clock_info, primary_mid);
+
+            if(e.secondary.has_value())
+            {
+                const auto secondary_mid = fmt::format("secondary-{}", i);
+                BST_ASSIGN(secondary_media, match(e.format, [&e](const auto& f) {
+                               return build_media(e.secondary.value(), e.rtp, f);
+                           }));
+                media  += fmt::format("{}{}a=mid:{}\n", secondary_media, clock_info, secondary_mid);
+                groups += fmt::format("a=group:DUP {} {}\n", primary_mid, secondary_mid);
+            }
+        }
+
+        return build_header(config) + groups + media;
     }
 } // namespace
 
 expected<std::string> sdp::build_sdp(const sdp_settings_t& config)
 {
+    if(config.essences.size() > 1) return build_essences(config);
+
     BST_ASSIGN(primary_media,
                match(config.format, [&config](const auto& f) { return build_media(config.primary, config.rtp, f); }));
 
@@ -12,189 +12,463 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <sdp/sdp.h>
-//////////////////////////////////////////////////////////////////////////////
-// Work around a missing forward declaration in cpprest
-#include <cpprest/json.h>
 
-namespace web
-{
-    namespace json
-    {
-        bool operator<(const web::json::value& lhs, const web::json::value& rhs);
-    }
-} // namespace web
-
-#include <cpprest/json_ops.h>
-//////////////////////////////////////////////////////////////////////////////
 #include "bisect/sdp/reader.h"
-#if !defined(U)
-#define U(X) _XPLATSTR(X)
-#endif
-#include <nmos/sdp_utils.h>
-#undef U
-#include <sdp/json.h>
 #include "bisect/expected/macros.h"
-#include "bisect/expected/helpers.h"
 #include "bisect/sdp/clocks.h"
-#include "bisect/json.h"
 #include "bisect/nmoscpp/configuration.h"
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 using namespace bisect;
 using namespace bisect::sdp;
-using namespace bisect::selectors;
 using namespace bisect::nmoscpp;
 
 namespace
 {
-    expected<refclk_t> to_refclk_t(const std::vector<nmos::sdp_parameters::ts_refclk_t>& params)
+    // Views into the SDP text, which outlives them.
+    struct attribute_t
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    using attributes_t = std::vector<attribute_t>;
+
+    struct media_description_t
+    {
+        std::string_view media;
+        attributes_t attributes;
+    };
+
+    struct session_description_t
+    {
+        std::string_view origin;
+        std::string_view name;
+        bool has_version = false;
+        bool has_timing  = false;
+        attributes_t attributes;
+        std::vector<media_description_t> media;
+    };
+
+    constexpr std::string_view whitespace = " \t";
+
+    std::string_view trim(std::string_view s)
+    {
+        const auto first = s.find_first_not_of(whitespace);
+        if(first == std::string_view::npos) return {};
+        return s.substr(first, s.find_last_not_of(whitespace) - first + 1);
+    }
+
+    // Splits s at the first `separator`; the second part is empty when there is none.
+    std::pair<std::string_view, std::string_view> split(std::string_view s, char separator)
+    {
+        const auto pos = s.find(separator);
+        if(pos == std::string_view::npos) return {s, {}};
+        return {s.substr(0, pos), s.substr(pos + 1)};
+    }
+
+    // Removes and returns the next whitespace separated token of s.
+    std::string_view next_token(std::string_view& s)
+    {
+        s                = s.substr(std::min(s.find_first_not_of(whitespace), s.size()));
+        const auto end   = std::min(s.find_first_of(whitespace), s.size());
+        const auto token = s.substr(0, end);
+        s                = s.substr(end);
+        return token;
+    }
+
+    template <typename T> expected<T> to_number(std::string_view s)
     {
-        BST_ENFORCE(params.size() == 1, "params size is different from 1");
-        if(params[0].clock_source.name == utility::conversions::to_string_t("localmac"))
+        T value{};
+        const auto [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+        BST_ENFORCE(error == std::errc{} && end == s.data() + s.size() && !s.empty(), "'{}' is not a valid number",
+                    s);
+        return value;
+    }
+
+    std::optional<std::string_view> find_attribute(const attributes_t& attributes, std::string_view name)
+    {
+        for(const auto& a : attributes)
         {
-            BST_ASSIGN(mac_address,
-                       ethernet::to_mac_address(utility::conversions::to_utf8string(params[0].mac_address)));
+            if(a.name == name) return a.value;
+        }
+        return std::nullopt;
+    }
 
+    expected<session_description_t> split_description(std::string_view sdp)
+    {
+        session_description_t session;
+        while(!sdp.empty())
+        {
+            auto [line, rest] = split(sdp, '\n');
+            sdp               = rest;
+            if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if(line.empty()) continue;
+
+            BST_ENFORCE(line.size() >= 2 && line[1] == '=', "invalid SDP line: '{}'", line);
+            const auto value = line.substr(2);
+            auto& attributes = session.media.empty() ? session.attributes : session.media.back().attributes;
+
+            switch(line[0])
+            {
+            case 'v': session.has_version = true; break;
+            case 'o': session.origin = value; break;
+            case 's': session.name = value; break;
+            case 't': session.has_timing = true; break;
+            case 'm': session.media.push_back(media_description_t{.media = value, .attributes = {}}); break;
+            case 'a': {
+                const auto [name, attribute_value] = split(value, ':');
+                attributes.push_back(attribute_t{.name = name, .value = attribute_value});
+                break;
+            }
+            default: break;
+            }
+        }
+
+        BST_ENFORCE(session.has_version && !session.origin.empty() && session.has_timing,
+                    "SDP is missing one of the v=, o= or t= lines");
+        BST_ENFORCE(!session.media.empty(), "SDP has no media description");
+        return session;
+    }
+
+    // Media level attributes take precedence over session level ones.
+    std::optional<std::string_view> find_clock_attribute(const session_description_t& session,
+                                                         const media_description_t& media, std::string_view name)
+    {
+        if(const auto a = find_attribute(media.attributes, name); a.has_value()) return a;
+        return find_attribute(session.attributes, name);
+    }
+
+    // e.g. ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127 or localmac=98-03-9b-8d-7e-5c
+    expected<refclk_t> to_refclk_t(const session_description_t& session, const media_description_t& media)
+    {
+        const auto& attributes =
+            find_attribute(media.attributes, "ts-refclk").has_value() ? media.attributes : session.attributes;
+        std::optional<std::string_view> refclk;
+        for(const auto& a : attributes)
+        {
+            if(a.name != "ts-refclk") continue;
+            BST_ENFORCE(!refclk.has_value(), "params size is different from 1");
+            refclk = a.value;
+        }
+        BST_ENFORCE(refclk.has_value(), "params size is different from 1");
+
+        const auto [clock_source, parameters] = split(*refclk, '=');
+        if(clock_source == "localmac")
+        {
+            BST_ASSIGN(mac_address, ethernet::to_mac_address(parameters));
             return refclks::localmac_t{.address = mac_address};
         }
-        else if(params[0].clock_source.name == utility::conversions::to_string_t("ptp"))
+        else if(clock_source == "ptp")
         {
-            auto ptp_server = utility::conversions::to_utf8string(params[0].ptp_server);
-            auto pos        = ptp_server.find(":");
-            if(pos == std::string::npos)
+            // The version comes first and is not kept.
+            const auto ptp_server     = split(parameters, ':').second;
+            const auto [gmid, domain] = split(ptp_server, ':');
+            if(ptp_server.find(':') == std::string_view::npos)
             {
-                return refclks::ptp_t{.gmid = utility::conversions::to_utf8string(ptp_server), .domain = std::nullopt};
+                return refclks::ptp_t{.gmid = std::string(gmid), .domain = std::nullopt};
             }
-            return refclks::ptp_t{.gmid   = utility::conversions::to_utf8string(ptp_server.substr(0, pos)),
-                                  .domain = static_cast<uint8_t>(std::stoi(ptp_server.substr(pos + 1)))};
+            BST_ASSIGN(domain_number, to_number<uint8_t>(domain));
+            return refclks::ptp_t{.gmid = std::string(gmid), .domain = domain_number};
         }
-        BST_FAIL("Reference clock {} is invalid.", utility::conversions::to_utf8string(params[0].clock_source.name));
+        BST_FAIL("Reference clock {} is invalid.", clock_source);
     }
 
-    expected<mediaclk_t> to_mediaclk_t(const nmos::sdp_parameters::mediaclk_t& params)
+    // e.g. direct=0 or sender
+    expected<mediaclk_t> to_mediaclk_t(const session_description_t& session, const media_description_t& media)
     {
-        if(params.clock_source.name == utility::conversions::to_string_t("direct"))
+        const auto mediaclk             = find_clock_attribute(session, media, "mediaclk").value_or("");
+        auto [clock_source, parameters] = split(mediaclk, '=');
+        if(clock_source == "direct")
         {
-            return mediaclks::direct_t{.offset = static_cast<uint64_t>(std::stoi(params.clock_parameters))};
+            BST_ASSIGN(offset, to_number<uint64_t>(next_token(parameters)));
+            return mediaclks::direct_t{.offset = offset};
         }
-        else if(params.clock_source.name == utility::conversions::to_string_t("sender"))
+        else if(clock_source == "sender")
         {
             return mediaclks::sender_t{};
         }
-        BST_FAIL("Media clock {} is invalid.", utility::conversions::to_utf8string(params.clock_source.name));
+        BST_FAIL("Media clock {} is invalid.", clock_source);
     }
 
-    expected<network_leg_t> to_network_settings_t(const nlohmann::json& sdp_settings)
+    // e.g. m=video 5004 RTP/AVP 96 and a=source-filter: incl IN IP4 239.0.0.1 192.168.1.10
+    expected<network_leg_t> to_network_settings_t(const media_description_t& media)
     {
-        auto s = network_leg_t{};
-        BST_CHECK_ASSIGN(s.destination_port, select<uint16_t>(sdp_settings, element("media_descriptions"), index(0),
-                                                              element("media"), element("port")));
-
-        BST_CHECK_ASSIGN(s.destination_ip, select<std::string>(sdp_settings, element("media_descriptions"), index(0),
-                                                               element("attributes"), name_value("source-filter"),
-                                                               element("destination_address")));
+        auto s            = network_leg_t{};
+        auto media_fields = media.media;
+        next_token(media_fields);
+        const auto port = split(next_token(media_fields), '/').first;
+        BST_CHECK_ASSIGN(s.destination_port, to_number<uint16_t>(port));
 
-        BST_CHECK_ASSIGN(s.source_ip, select<std::string>(sdp_settings, element("media_descriptions"), index(0),
-                                                          element("attributes"), name_value("source-filter"),
-                                                          element("source_addresses"), index(0)));
+        const auto source_filter = find_attribute(media.attributes, "source-filter");
+        BST_ENFORCE(source_filter.has_value(), "media description has no source-filter attribute");
+        auto fields = *source_filter;
+        for(auto i = 0; i < 3; ++i)
+        {
+            next_token(fields); // filter mode, network type and address type
+        }
+        const auto destination_address = next_token(fields);
+        const auto source_address      = next_token(fields);
+        BST_ENFORCE(!destination_address.empty() && !source_address.empty(), "invalid source-filter: '{}'",
+                    *source_filter);
+        s.destination_ip = std::string(destination_address);
+        s.source_ip      = std::string(source_address);
 
         s.interface_ip = "0.0.0.0";
 
         return s;
     }
 
-    expected<audio_sender_info_t> get_raw_audio_params(const nmos::sdp_parameters& sdp_params,
-                                                       const utility::string_t& encoding_name)
+    // The media descriptions of one essence: a single one, or the two legs of a SMPTE 2022-7 stream.
+    struct essence_media_t
+    {
+        const media_description_t* primary;
+        const media_description_t* secondary;
+    };
+
+    std::optional<size_t> find_media(const session_description_t& session, std::string_view mid)
+    {
+        for(size_t i = 0; i < session.media.size(); ++i)
+        {
+            if(find_attribute(session.media[i].attributes, "mid") == mid) return i;
+        }
+        return std::nullopt;
+    }
+
+    // RFC 7104 "a=group:DUP <mid> <mid>": the two media descriptions carry the same stream on the SMPTE 2022-7 primary
+    // and secondary legs. A group whose mids are not all declared pairs the next two media descriptions instead.
+    std::vector<essence_media_t> group_essences(const session_description_t& session)
+    {
+        const auto count = session.media.size();
+        std::vector<std::optional<size_t>> secondary_of(count);
+        std::vector<bool> grouped(count, false);
+        const auto next_ungrouped = [&grouped, count](size_t from) {
+            while(from < count && grouped[from]) ++from;
+            return from;
+        };
+
+        for(const auto& a : session.attributes)
+        {
+            auto fields = a.value;
+            if(a.name != "group" || next_token(fields) != "DUP") continue;
+
+            auto primary   = find_media(session, next_token(fields));
+            auto secondary = find_media(session, next_token(fields));
+            if(!primary.has_value() || !secondary.has_value() || primary == secondary || grouped[*primary] ||
+               grouped[*secondary])
+            {
+                primary   = next_ungrouped(0);
+                secondary = next_ungrouped(*primary + 1);
+                if(*secondary >= count) continue;
+            }
+
+            secondary_of[*primary] = secondary;
+            grouped[*primary]      = true;
+            grouped[*secondary]    = true;
+        }
+
+        std::vector<essence_media_t> essences;
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(grouped[i] && !secondary_of[i].has_value()) continue; // a secondary leg
+
+            const auto* secondary = secondary_of[i].has_value() ? &session.media[*secondary_of[i]] : nullptr;
+            essences.push_back(essence_media_t{.primary = &session.media[i], .secondary = secondary});
+        }
+        return essences;
+    }
+
+    struct rtpmap_t
+    {
+        uint8_t payload_type;
+        std::string_view encoding_name;
+        std::string_view clock_rate;
+        std::string_view encoding_parameters;
+    };
+
+    // e.g. a=rtpmap:96 raw/90000 or a=rtpmap:97 L24/48000/2
+    expected<rtpmap_t> get_rtpmap(const media_description_t& media)
+    {
+        const auto value = find_attribute(media.attributes, "rtpmap");
+        BST_ENFORCE(value.has_value(), "media description has no rtpmap attribute");
+
+        auto fields = *value;
+        BST_ASSIGN(payload_type, to_number<uint8_t>(next_token(fields)));
+        const auto [encoding_name, rate_and_parameters] = split(trim(fields), '/');
+        const auto [clock_rate, encoding_parameters]    = split(rate_and_parameters, '/');
+        return rtpmap_t{.payload_type        = payload_type,
+                        .encoding_name       = encoding_name,
+                        .clock_rate          = clock_rate,
+                        .encoding_parameters = encoding_parameters};
+    }
+
+    // Looks `name` up in e.g. a=fmtp:96 sampling=YCbCr-4:2:2; width=1920; height=1080; interlace; ...
+    // Parameters without a value, like interlace, are found with an empty value.
+    std::optional<std::string_view> find_format_parameter(const media_description_t& media, std::string_view name)
+    {
+        auto fmtp = find_attribute(media.attributes, "fmtp").value_or("");
+        next_token(fmtp);
+        while(!fmtp.empty())
+        {
+            const auto [parameter, rest] = split(fmtp, ';');
+            fmtp                          = rest;
+            const auto [key, value]       = split(trim(parameter), '=');
+            if(key == name) return value;
+        }
+        return std::nullopt;
+    }
+
+    template <typename T> expected<T> get_format_number(const media_description_t& media, std::string_view name)
+    {
+        const auto value = find_format_parameter(media, name);
+        if(!value.has_value()) return T{};
+        return to_number<T>(*value);
+    }
+
+    expected<audio_sender_info_t> get_raw_audio_params(const media_description_t& media, const rtpmap_t& rtpmap)
     {
-        const auto params            = nmos::get_audio_L_parameters(sdp_params);
         unsigned int bits_per_sample = 0;
-        if(encoding_name == utility::conversions::to_string_t("L16"))
+        if(rtpmap.encoding_name == "L16")
         {
             bits_per_sample = 16;
         }
-        else if(encoding_name == utility::conversions::to_string_t("L24"))
+        else if(rtpmap.encoding_name == "L24")
         {
             bits_per_sample = 24;
         }
         else
         {
-            BST_FAIL("error parsing SDP: media type audio and encoding {} not supported",
-                     utility::conversions::to_utf8string(encoding_name));
+            BST_FAIL("error parsing SDP: media type audio and encoding {} not supported", rtpmap.encoding_name);
+        }
+
+        BST_ASSIGN(sample_rate, to_number<unsigned int>(rtpmap.clock_rate));
+        unsigned int channel_count = 1;
+        if(!rtpmap.encoding_parameters.empty())
+        {
+            BST_CHECK_ASSIGN(channel_count, to_number<unsigned int>(rtpmap.encoding_parameters));
+        }
+        double packet_time = 0;
+        if(const auto ptime = find_attribute(media.attributes, "ptime"); ptime.has_value())
+        {
+            BST_CHECK_ASSIGN(packet_time, to_number<double>(trim(*ptime)));
         }
 
         return audio_sender_info_t{
-            .number_of_channels = static_cast<int>(params.channel_count),
+            .number_of_channels = static_cast<int>(channel_count),
             .bits_per_sample    = bits_per_sample,
-            .sampling_rate      = static_cast<int>(params.sample_rate),
-            .packet_time        = static_cast<float>(params.packet_time),
+            .sampling_rate      = static_cast<int>(sample_rate),
+            .packet_time        = static_cast<float>(packet_time),
         };
     }
 
-    expected<video_sender_info_t> get_raw_video_params(const nmos::sdp_parameters& sdp_params)
+    expected<video_sender_info_t> get_raw_video_params(const media_description_t& media)
     {
-        const auto params = nmos::get_video_raw_parameters(sdp_params);
+        BST_ASSIGN(width, get_format_number<unsigned int>(media, "width"));
+        BST_ASSIGN(height, get_format_number<unsigned int>(media, "height"));
+        BST_ASSIGN(depth, get_format_number<unsigned int>(media, "depth"));
 
-        if(params.width == 0 || params.height == 0)
+        if(width == 0 || height == 0)
         {
             BST_FAIL("SDP reader: Invalid width and/or height.");
         }
 
+        // e.g. exactframerate=30000/1001 or exactframerate=25
+        const auto [numerator, denominator] = split(find_format_parameter(media, "exactframerate").value_or("0"), '/');
+        BST_ASSIGN(framerate_numerator, to_number<int64_t>(numerator));
+        int64_t framerate_denominator = 1;
+        if(!denominator.empty())
+        {
+            BST_CHECK_ASSIGN(framerate_denominator, to_number<int64_t>(denominator));
+        }
+        BST_ENFORCE(framerate_denominator != 0, "SDP reader: Invalid exactframerate.");
+
+        const auto interlace = find_format_parameter(media, "interlace").has_value();
+
         return video_sender_info_t{
-            .height          = static_cast<int>(params.height),
-            .width           = static_cast<int>(params.width),
-            .exact_framerate = nmos::rational(params.exactframerate.numerator(), params.exactframerate.denominator()),
+            .height              = static_cast<int>(height),
+            .width               = static_cast<int>(width),
+            .exact_framerate     = nmos::rational(framerate_numerator, framerate_denominator),
             .chroma_sub_sampling = "YCbCr-4:2:2",
-            .structure = params.interlace ? nmos::interlace_modes::interlaced_tff : nmos::interlace_modes::progressive,
-            .depth     = static_cast<int>(params.depth),
+            .structure = interlace ? nmos::interlace_modes::interlaced_tff : nmos::interlace_modes::progressive,
+            .depth               = static_cast<int>(depth),
         };
     }
-} // namespace
 
-// TODO: US_5727 - having more than one media type per sdp file
-// TODO: US_5728 - parsing secondary/redundant network case it exists
-expected<sdp_settings_t> bisect::sdp::parse_sdp(const std::string& sdp)
-{
-    try
+    std::string_view get_media_type(const media_description_t& media)
     {
-        const auto parsed         = ::sdp::parse_session_description(sdp);
-        const auto sdp_parameters = nmos::get_session_description_sdp_parameters(parsed);
-        BST_ASSIGN(json_sdp, parse_json(utility::conversions::to_utf8string(parsed.serialize())));
+        auto media_fields = media.media;
+        return next_token(media_fields);
+    }
 
-        auto s                   = sdp_settings_t{};
-        s.rtp.payload_type       = static_cast<uint8_t>(sdp_parameters.rtpmap.payload_type);
-        s.origin.session_id      = std::to_string(sdp_parameters.origin.session_id);
-        s.origin.session_version = std::to_string(sdp_parameters.origin.session_version);
-        s.origin.description     = utility::conversions::to_utf8string(sdp_parameters.session_name);
-        BST_CHECK_ASSIGN(s.mediaclk, to_mediaclk_t(sdp_parameters.mediaclk));
-        BST_CHECK_ASSIGN(s.ts_refclk, to_refclk_t(sdp_parameters.ts_refclk));
-        BST_CHECK_ASSIGN(s.primary, to_network_settings_t(json_sdp));
+    // The legs of an essence share its format and clocks, only their network settings differ.
+    expected<essence_settings_t> to_essence_settings_t(const session_description_t& session,
+                                                       const essence_media_t& essence)
+    {
+        const auto& media = *essence.primary;
+        BST_ASSIGN(rtpmap, get_rtpmap(media));
 
-        if(sdp_parameters.media_type.name == utility::conversions::to_string_t("video") &&
-           sdp_parameters.rtpmap.encoding_name == utility::conversions::to_string_t("raw"))
+        auto e             = essence_settings_t{};
+        e.rtp.payload_type = rtpmap.payload_type;
+        BST_CHECK_ASSIGN(e.mediaclk, to_mediaclk_t(session, media));
+        BST_CHECK_ASSIGN(e.ts_refclk, to_refclk_t(session, media));
+        BST_CHECK_ASSIGN(e.primary, to_network_settings_t(media));
+        if(essence.secondary != nullptr)
         {
-            BST_ASSIGN(video, get_raw_video_params(sdp_parameters));
-
-            s.format = video;
-            return s;
+            BST_CHECK_ASSIGN(e.secondary, to_network_settings_t(*essence.secondary));
         }
 
-        if(sdp_parameters.media_type.name == utility::conversions::to_string_t("audio"))
+        const auto media_type = get_media_type(media);
+        if(media_type == "video" && rtpmap.encoding_name == "raw")
         {
-            const auto params = nmos::get_audio_L_parameters(sdp_parameters);
+            BST_ASSIGN(video, get_raw_video_params(media));
 
-            BST_ASSIGN(audio, get_raw_audio_params(sdp_parameters, sdp_parameters.rtpmap.encoding_name));
+            e.format = video;
+            return e;
+        }
 
-            s.format = audio;
+        if(media_type == "audio")
+        {
+            BST_ASSIGN(audio, get_raw_audio_params(media, rtpmap));
 
-            return s;
+            e.format = audio;
+
+            return e;
         }
 
-        BST_FAIL("error parsing SDP: media type {} and encoding {} not supported",
-                 utility::conversions::to_utf8string(sdp_parameters.media_type.name),
-                 utility::conversions::to_utf8string(sdp_parameters.rtpmap.encoding_name));
+        BST_FAIL("error parsing SDP: media type {} and encoding {} not supported", media_type, rtpmap.encoding_name);
     }
-    catch(std::exception& ex)
+} // namespace
+
+expected<sdp_settings_t> bisect::sdp::parse_sdp(std::string_view sdp)
+{
+    BST_ASSIGN(session, split_description(sdp));
+
+    // e.g. o=- 1443716955 1443716955 IN IP4 192.168.1.10
+    auto origin = session.origin;
+    next_token(origin);
+    BST_ASSIGN(session_id, to_number<uint64_t>(next_token(origin)));
+    BST_ASSIGN(session_version, to_number<uint64_t>(next_token(origin)));
+
+    auto s                   = sdp_settings_t{};
+    s.origin.session_id      = std::to_string(session_id);
+    s.origin.session_version = std::to_string(session_version);
+    s.origin.description     = std::string(session.name);
+
+    for(const auto& essence : group_essences(session))
     {
-        BST_FAIL("error parsing SDP: {}", ex.what());
+        // Only the first essence has to be one this reader supports. The others, e.g. ST 2110-40 ancillary data,
+        // AM824 audio or compressed video, are left out, so that a description that was accepted when only its first
+        // essence was read still is.
+        auto e = to_essence_settings_t(session, essence);
+        if(!s.essences.empty() && !e.has_value()) continue;
+
+        BST_CHECK(e);
+        s.essences.push_back(std::move(e.value()));
     }
+
+    static_cast<essence_settings_t&>(s) = s.essences.front();
+    return s;
 }
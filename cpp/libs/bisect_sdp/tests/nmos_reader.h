@@ -0,0 +1,27 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bisect/sdp/settings.h"
+#include "bisect/expected.h"
+
+#include <string>
+
+namespace bisect::sdp::tests
+{
+    // The reader parse_sdp replaced, which goes through nmos-cpp's SDP parser and a JSON representation of the
+    // session description. Kept as the reference parse_sdp must agree with.
+    expected<sdp_settings_t> parse_sdp_with_nmos(const std::string& sdp);
+} // namespace bisect::sdp::tests
@@ -0,0 +1,422 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bisect/sdp/builder.h"
+#include "bisect/sdp/reader.h"
+#include "nmos_reader.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace bisect;
+using namespace bisect::sdp;
+using namespace bisect::nmoscpp;
+
+namespace
+{
+    constexpr auto video_sdp = "v=0\r\n"
+                               "o=- 1443716955 1443716956 IN IP4 192.168.1.10\r\n"
+                               "s=ST 2110-20 video\r\n"
+                               "t=0 0\r\n"
+                               "a=recvonly\r\n"
+                               "a=group:DUP primary secondary\r\n"
+                               "m=video 5004 RTP/AVP 96\r\n"
+                               "c=IN IP4 239.10.10.1/64\r\n"
+                               "a=source-filter: incl IN IP4 239.10.10.1 192.168.1.10\r\n"
+                               "a=rtpmap:96 raw/90000\r\n"
+                               "a=fmtp:96 sampling=YCbCr-4:2:2; width=1920; height=1080; exactframerate=30000/1001; "
+                               "depth=10; TCS=SDR; colorimetry=BT709; PM=2110GPM; SSN=ST2110-20:2017; interlace; "
+                               "TP=2110TPN\r\n"
+                               "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\r\n"
+                               "a=mediaclk:direct=0\r\n"
+                               "a=mid:primary\r\n"
+                               "m=video 5006 RTP/AVP 96\r\n"
+                               "c=IN IP4 239.10.20.1/64\r\n"
+                               "a=source-filter: incl IN IP4 239.10.20.1 192.168.2.10\r\n"
+                               "a=rtpmap:96 raw/90000\r\n"
+                               "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\r\n"
+                               "a=mediaclk:direct=0\r\n"
+                               "a=mid:secondary\r\n";
+
+    constexpr auto audio_sdp = "v=0\n"
+                               "o=- 7 8 IN IP4 192.168.1.20\n"
+                               "s=ST 2110-30 audio\n"
+                               "t=0 0\n"
+                               "a=ts-refclk:localmac=98-03-9b-8d-7e-5c\n"
+                               "a=mediaclk:sender\n"
+                               "m=audio 5008 RTP/AVP 97\n"
+                               "c=IN IP4 239.10.30.1/64\n"
+                               "a=source-filter: incl IN IP4 239.10.30.1 192.168.1.20\n"
+                               "a=rtpmap:97 L24/48000/8\n"
+                               "a=fmtp:97 channel-order=SMPTE2110.(SGRP,SGRP)\n"
+                               "a=ptime:0.125\n";
+
+    // Video and audio, each on two legs, with ancillary data. The legs are paired by mid, not by position.
+    constexpr auto multi_essence_sdp = "v=0\n"
+                                       "o=- 11 12 IN IP4 192.168.1.30\n"
+                                       "s=ST 2110 session\n"
+                                       "t=0 0\n"
+                                       "a=group:DUP audio-1 audio-2\n"
+                                       "a=group:DUP video-1 video-2\n"
+                                       "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\n"
+                                       "a=mediaclk:direct=0\n"
+                                       "m=video 5010 RTP/AVP 96\n"
+                                       "a=source-filter: incl IN IP4 239.20.10.1 192.168.1.30\n"
+                                       "a=rtpmap:96 raw/90000\n"
+                                       "a=fmtp:96 sampling=YCbCr-4:2:2; width=1280; height=720; exactframerate=50; "
+                                       "depth=10\n"
+                                       "a=mid:video-1\n"
+                                       "m=audio 5012 RTP/AVP 97\n"
+                                       "a=source-filter: incl IN IP4 239.20.30.1 192.168.1.30\n"
+                                       "a=rtpmap:97 L16/48000/2\n"
+                                       "a=ptime:1\n"
+                                       "a=mediaclk:sender\n"
+                                       "a=mid:audio-1\n"
+                                       "m=video 5014 RTP/AVP 96\n"
+                                       "a=source-filter: incl IN IP4 239.20.20.1 192.168.2.30\n"
+                                       "a=rtpmap:96 raw/90000\n"
+                                       "a=mid:video-2\n"
+                                       "m=audio 5016 RTP/AVP 97\n"
+                                       "a=source-filter: incl IN IP4 239.20.40.1 192.168.2.30\n"
+                                       "a=rtpmap:97 L16/48000/2\n"
+                                       "a=mid:audio-2\n"
+                                       "m=application 5018 RTP/AVP 100\n"
+                                       "a=source-filter: incl IN IP4 239.20.50.1 192.168.1.30\n"
+                                       "a=rtpmap:100 smpte291/90000\n"
+                                       "a=mid:anc\n";
+
+    void expect_same_leg(const network_leg_t& lhs, const network_leg_t& rhs)
+    {
+        EXPECT_EQ(lhs.destination_ip, rhs.destination_ip);
+        EXPECT_EQ(lhs.destination_port, rhs.destination_port);
+        EXPECT_EQ(lhs.source_ip, rhs.source_ip);
+        EXPECT_EQ(lhs.interface_ip, rhs.interface_ip);
+    }
+
+    void expect_same_essence(const essence_settings_t& lhs, const essence_settings_t& rhs)
+    {
+        EXPECT_EQ(lhs.rtp.payload_type, rhs.rtp.payload_type);
+        EXPECT_EQ(to_string(lhs.ts_refclk), to_string(rhs.ts_refclk));
+        EXPECT_EQ(to_string(lhs.mediaclk), to_string(rhs.mediaclk));
+        expect_same_leg(lhs.primary, rhs.primary);
+        ASSERT_EQ(lhs.secondary.has_value(), rhs.secondary.has_value());
+        if(lhs.secondary.has_value()) expect_same_leg(*lhs.secondary, *rhs.secondary);
+
+        ASSERT_EQ(lhs.format.index(), rhs.format.index());
+        if(const auto* video = std::get_if<video_sender_info_t>(&lhs.format); video != nullptr)
+        {
+            const auto& other = std::get<video_sender_info_t>(rhs.format);
+            EXPECT_EQ(video->width, other.width);
+            EXPECT_EQ(video->height, other.height);
+            EXPECT_EQ(video->exact_framerate, other.exact_framerate);
+            EXPECT_EQ(video->chroma_sub_sampling, other.chroma_sub_sampling);
+            EXPECT_TRUE(video->structure == other.structure);
+            EXPECT_EQ(video->depth, other.depth);
+        }
+        else
+        {
+            const auto& audio = std::get<audio_sender_info_t>(lhs.format);
+            const auto& other = std::get<audio_sender_info_t>(rhs.format);
+            EXPECT_EQ(audio.number_of_channels, other.number_of_channels);
+            EXPECT_EQ(audio.bits_per_sample, other.bits_per_sample);
+            EXPECT_EQ(audio.sampling_rate, other.sampling_rate);
+            EXPECT_EQ(audio.packet_time, other.packet_time);
+        }
+    }
+
+    void expect_same_settings(const sdp_settings_t& lhs, const sdp_settings_t& rhs)
+    {
+        EXPECT_EQ(lhs.origin.description, rhs.origin.description);
+        EXPECT_EQ(lhs.origin.session_id, rhs.origin.session_id);
+        EXPECT_EQ(lhs.origin.session_version, rhs.origin.session_version);
+        expect_same_essence(lhs, rhs);
+    }
+
+    // Generates ST 2110 session descriptions with random values, clocks at either level, with or without
+    // SMPTE 2022-7 duplication, and sometimes with one attribute line missing.
+    class sdp_generator_t
+    {
+      public:
+        explicit sdp_generator_t(uint32_t seed) : random_(seed) {}
+
+        std::string next()
+        {
+            const auto eol        = pick<std::string>({"\n", "\r\n"});
+            const auto duplicated = coin();
+            const auto video      = coin();
+            const auto pt         = std::to_string(uniform(96, 127));
+            const auto refclk     = pick<std::string>({
+                "ptp=IEEE1588-2008:" + gmid() + ":" + std::to_string(uniform(0, 127)),
+                "ptp=IEEE1588-2008:traceable",
+                "localmac=" + gmid().substr(0, 17),
+            });
+            const auto mediaclk =
+                pick<std::string>({"direct=0", "direct=" + std::to_string(uniform(1, 100000)), "sender"});
+            const auto session_clocks = coin();
+
+            std::vector<std::string> lines{"v=0",
+                                           "o=- " + std::to_string(random_()) + " " + std::to_string(random_()) +
+                                               " IN IP4 192.168.1.10",
+                                           "s=" + pick<std::string>({"video", "ST 2110 audio", "-"}), "t=0 0"};
+            if(session_clocks)
+            {
+                lines.push_back("a=ts-refclk:" + refclk);
+                lines.push_back("a=mediaclk:" + mediaclk);
+            }
+            if(duplicated) lines.push_back("a=group:DUP primary secondary");
+
+            for(const auto& mid : duplicated ? std::vector<std::string>{"primary", "secondary"}
+                                             : std::vector<std::string>{"primary"})
+            {
+                const auto multicast = "239.10." + std::to_string(uniform(0, 255)) + ".1";
+                lines.push_back("m=" + std::string(video ? "video " : "audio ") + std::to_string(uniform(1024, 65535)) +
+                                " RTP/AVP " + pt);
+                lines.push_back("c=IN IP4 " + multicast + "/64");
+                lines.push_back("a=source-filter: incl IN IP4 " + multicast + " 192.168." +
+                                std::to_string(uniform(0, 255)) + ".10");
+                if(video)
+                {
+                    lines.push_back("a=rtpmap:" + pt + " raw/90000");
+                    lines.push_back("a=fmtp:" + pt + " sampling=YCbCr-4:2:2; width=" +
+                                    pick<std::string>({"1280", "1920", "3840"}) +
+                                    "; height=" + pick<std::string>({"720", "1080", "2160"}) + "; exactframerate=" +
+                                    pick<std::string>({"25", "50", "30000/1001", "60000/1001", "50/2"}) +
+                                    "; depth=" + pick<std::string>({"8", "10"}) + ";" +
+                                    (coin() ? " interlace;" : "") + " TCS=SDR; colorimetry=BT709; PM=2110GPM");
+                }
+                else
+                {
+                    const auto channels = pick<std::string>({"", "/1", "/2", "/8"});
+                    lines.push_back("a=rtpmap:" + pt + " " + pick<std::string>({"L16", "L24"}) + "/" +
+                                    pick<std::string>({"48000", "96000"}) + channels);
+                    lines.push_back("a=ptime:" + pick<std::string>({"1", "0.125", "1.000"}));
+                }
+                if(!session_clocks)
+                {
+                    lines.push_back("a=ts-refclk:" + refclk);
+                    lines.push_back("a=mediaclk:" + mediaclk);
+                }
+                if(duplicated) lines.push_back("a=mid:" + mid);
+            }
+
+            // Drops an attribute, other than ptime whose absence the two readers may default differently.
+            if(uniform(0, 3) == 0)
+            {
+                const auto line = lines.begin() + uniform(0, static_cast<int>(lines.size()) - 1);
+                if(line->starts_with("a=") && !line->starts_with("a=ptime")) lines.erase(line);
+            }
+
+            std::string sdp;
+            for(const auto& line : lines)
+            {
+                sdp += line + eol;
+            }
+            return sdp;
+        }
+
+      private:
+        int uniform(int min, int max) { return std::uniform_int_distribution<int>(min, max)(random_); }
+        bool coin() { return uniform(0, 1) == 1; }
+
+        template <typename T> T pick(std::vector<T> values)
+        {
+            return values[static_cast<size_t>(uniform(0, static_cast<int>(values.size()) - 1))];
+        }
+
+        std::string gmid()
+        {
+            std::string id;
+            for(auto i = 0; i < 8; ++i)
+            {
+                constexpr auto digits = "0123456789abcdef";
+                if(i > 0) id += '-';
+                id += digits[uniform(0, 15)];
+                id += digits[uniform(0, 15)];
+            }
+            return id;
+        }
+
+        std::mt19937 random_;
+    };
+} // namespace
+
+TEST(bisect_sdp, parse_video_with_duplication)
+{
+    const auto s = parse_sdp(video_sdp);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+
+    ASSERT_EQ(s->rtp.payload_type, 96);
+    ASSERT_EQ(s->origin.session_id, "1443716955");
+    ASSERT_EQ(s->origin.session_version, "1443716956");
+    ASSERT_EQ(s->origin.description, "ST 2110-20 video");
+    ASSERT_EQ(s->primary.destination_ip, "239.10.10.1");
+    ASSERT_EQ(s->primary.source_ip, "192.168.1.10");
+    ASSERT_EQ(s->primary.destination_port, 5004);
+    ASSERT_TRUE(s->secondary.has_value());
+    ASSERT_EQ(s->secondary->destination_ip, "239.10.20.1");
+    ASSERT_EQ(s->secondary->destination_port, 5006);
+
+    const auto& ptp = std::get<refclks::ptp_t>(s->ts_refclk);
+    ASSERT_EQ(ptp.gmid, "ec-46-70-ff-fe-10-ff-b0");
+    ASSERT_EQ(ptp.domain, 127);
+    ASSERT_EQ(std::get<mediaclks::direct_t>(s->mediaclk).offset, 0u);
+
+    const auto& video = std::get<video_sender_info_t>(s->format);
+    ASSERT_EQ(video.width, 1920);
+    ASSERT_EQ(video.height, 1080);
+    ASSERT_EQ(video.exact_framerate, nmos::rational(30000, 1001));
+    ASSERT_EQ(video.depth, 10);
+    ASSERT_TRUE(video.structure == nmos::interlace_modes::interlaced_tff);
+}
+
+TEST(bisect_sdp, parse_audio_with_session_clocks)
+{
+    const auto s = parse_sdp(audio_sdp);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+
+    ASSERT_FALSE(s->secondary.has_value());
+    ASSERT_TRUE(std::holds_alternative<refclks::localmac_t>(s->ts_refclk));
+    ASSERT_TRUE(std::holds_alternative<mediaclks::sender_t>(s->mediaclk));
+
+    const auto& audio = std::get<audio_sender_info_t>(s->format);
+    ASSERT_EQ(audio.bits_per_sample, 24u);
+    ASSERT_EQ(audio.sampling_rate, 48000);
+    ASSERT_EQ(audio.number_of_channels, 8);
+    ASSERT_EQ(audio.packet_time, 0.125f);
+}
+
+TEST(bisect_sdp, parse_multiple_essences)
+{
+    const auto s = parse_sdp(multi_essence_sdp);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+    ASSERT_EQ(s->essences.size(), 2u);
+    expect_same_essence(*s, s->essences[0]);
+
+    const auto& video = s->essences[0];
+    ASSERT_EQ(std::get<video_sender_info_t>(video.format).width, 1280);
+    ASSERT_EQ(video.primary.destination_ip, "239.20.10.1");
+    ASSERT_TRUE(video.secondary.has_value());
+    ASSERT_EQ(video.secondary->destination_ip, "239.20.20.1");
+    ASSERT_EQ(video.secondary->source_ip, "192.168.2.30");
+    ASSERT_EQ(video.secondary->destination_port, 5014);
+    ASSERT_TRUE(std::holds_alternative<mediaclks::direct_t>(video.mediaclk));
+
+    const auto& audio = s->essences[1];
+    ASSERT_EQ(audio.rtp.payload_type, 97);
+    ASSERT_EQ(std::get<audio_sender_info_t>(audio.format).number_of_channels, 2);
+    ASSERT_EQ(audio.primary.destination_ip, "239.20.30.1");
+    ASSERT_TRUE(audio.secondary.has_value());
+    ASSERT_EQ(audio.secondary->destination_ip, "239.20.40.1");
+    ASSERT_EQ(audio.secondary->destination_port, 5016);
+    // Media level clocks take precedence over the session level ones.
+    ASSERT_TRUE(std::holds_alternative<mediaclks::sender_t>(audio.mediaclk));
+    ASSERT_TRUE(std::holds_alternative<refclks::ptp_t>(audio.ts_refclk));
+}
+
+TEST(bisect_sdp, parse_skips_unsupported_essences)
+{
+    // Raw video followed by AM824 audio and compressed video, which the reader does not parse.
+    const std::string header = "v=0\n"
+                               "o=- 13 14 IN IP4 192.168.1.40\n"
+                               "s=ST 2110 session\n"
+                               "t=0 0\n"
+                               "a=ts-refclk:ptp=IEEE1588-2008:ec-46-70-ff-fe-10-ff-b0:127\n"
+                               "a=mediaclk:direct=0\n";
+    const std::string raw_video = "m=video 5020 RTP/AVP 96\n"
+                                  "c=IN IP4 239.30.10.1/64\n"
+                                  "a=source-filter: incl IN IP4 239.30.10.1 192.168.1.40\n"
+                                  "a=rtpmap:96 raw/90000\n"
+                                  "a=fmtp:96 sampling=YCbCr-4:2:2; width=1920; height=1080; exactframerate=25; "
+                                  "depth=10\n";
+    const std::string am824 = "m=audio 5022 RTP/AVP 98\n"
+                              "c=IN IP4 239.30.20.1/64\n"
+                              "a=source-filter: incl IN IP4 239.30.20.1 192.168.1.40\n"
+                              "a=rtpmap:98 AM824/48000/2\n";
+    const std::string jxsv = "m=video 5024 RTP/AVP 112\n"
+                             "c=IN IP4 239.30.30.1/64\n"
+                             "a=source-filter: incl IN IP4 239.30.30.1 192.168.1.40\n"
+                             "a=rtpmap:112 jxsv/90000\n";
+
+    const auto s = parse_sdp(header + raw_video + am824 + jxsv);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+    ASSERT_EQ(s->essences.size(), 1u);
+    ASSERT_EQ(std::get<video_sender_info_t>(s->format).width, 1920);
+    ASSERT_EQ(s->primary.destination_ip, "239.30.10.1");
+
+    // The first essence still has to be supported.
+    ASSERT_FALSE(parse_sdp(header + am824 + raw_video).has_value());
+}
+
+TEST(bisect_sdp, select_essence_by_format)
+{
+    const auto s = parse_sdp(multi_essence_sdp);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+
+    const auto audio = select_essence<audio_sender_info_t>(*s);
+    ASSERT_TRUE(audio.has_value()) << audio.error().what();
+    expect_same_essence(*audio, s->essences[1]);
+    ASSERT_EQ(audio->origin.session_id, "11");
+
+    const auto video = parse_sdp(video_sdp);
+    ASSERT_TRUE(video.has_value()) << video.error().what();
+    ASSERT_FALSE(select_essence<audio_sender_info_t>(*video).has_value());
+}
+
+TEST(bisect_sdp, build_and_parse_multiple_essences)
+{
+    const auto s = parse_sdp(multi_essence_sdp);
+    ASSERT_TRUE(s.has_value()) << s.error().what();
+
+    const auto sdp = build_sdp(*s);
+    ASSERT_TRUE(sdp.has_value()) << sdp.error().what();
+    const auto rebuilt = parse_sdp(*sdp);
+    ASSERT_TRUE(rebuilt.has_value()) << rebuilt.error().what() << *sdp;
+
+    expect_same_settings(*rebuilt, *s);
+    ASSERT_EQ(rebuilt->essences.size(), s->essences.size()) << *sdp;
+    for(size_t i = 0; i < s->essences.size(); ++i)
+    {
+        expect_same_essence(rebuilt->essences[i], s->essences[i]);
+    }
+}
+
+TEST(bisect_sdp, parse_rejects_incomplete_descriptions)
+{
+    ASSERT_FALSE(parse_sdp("").has_value());
+    ASSERT_FALSE(parse_sdp("v=0\no=- 1 1 IN IP4 127.0.0.1\ns=-\nt=0 0\n").has_value());
+
+    std::string without_source_filter = audio_sdp;
+    without_source_filter.erase(without_source_filter.find("a=source-filter"),
+                                without_source_filter.find("a=rtpmap") - without_source_filter.find("a=source-filter"));
+    ASSERT_FALSE(parse_sdp(without_source_filter).has_value());
+}
+
+TEST(bisect_sdp, parse_matches_nmos_reader)
+{
+    sdp_generator_t generator(2110);
+    for(auto i = 0; i < 1000; ++i)
+    {
+        const auto sdp      = generator.next();
+        const auto expected = tests::parse_sdp_with_nmos(sdp);
+        const auto actual   = parse_sdp(sdp);
+
+        ASSERT_EQ(actual.has_value(), expected.has_value()) << sdp;
+        if(actual.has_value())
+        {
+            SCOPED_TRACE(sdp);
+            expect_same_settings(*actual, *expected);
+        }
+    }
+}
@@ -39,6 +39,8 @@ struct network_fields_t
     std::string interface_name;
     std::string destination_address;
     gint destination_port;
+    guint udp_batch_size;
+    gboolean udp_gso;
 };
 
 struct config_fields_t
@@ -25,7 +25,9 @@
 #include "bisect/sdp.h"
 #include "bisect/sdp/reader.h"
 #include "bisect/nmoscpp/configuration.h"
+#include "bisect/rtp/elements.h"
 #include "ossrf/nmos/api/nmos_client.h"
+#include "receive_chain_pool.hpp"
 #include "utils.hpp"
 #include "gst_nmos_plugins/include/element_class.hpp"
 #include "gst_nmos_plugins/include/nmos_configuration.hpp"
@@ -48,14 +50,14 @@ typedef struct _GstNmosaudioreceiver
 {
     GstBin parent;
     GstPad* element_pad;
-    GstPad* bin_pad;
     GstClock* clock;
-    GstElementHandle<_GstElement> bin;
+    // The jitter buffer, queue and depayloader, taken from `chains` on activation.
+    GstElement* chain;
+    const char* chain_format;
+    std::unique_ptr<receive_chain_pool_t> chains;
     GstElementHandle<_GstElement> udp_src;
-    GstElementHandle<_GstElement> rtp_audio_depay_16;
-    GstElementHandle<_GstElement> rtp_audio_depay_24;
-    GstElementHandle<_GstElement> rtp_jitter_buffer;
-    GstElementHandle<_GstElement> queue;
+    GstElementHandle<_GstElement> udp_src_secondary;
+    GstElementHandle<_GstElement> merge;
     ossrf::nmos_client_uptr client;
     config_fields_t config;
     std::string sdp_string;
@@ -141,6 +143,10 @@ static GstPadProbeReturn block_pad_probe_cb(GstPad* pad, GstPadProbeInfo* info,
     return GST_PAD_PROBE_DROP;
 }
 
+constexpr auto l16_chain = "L16";
+constexpr auto l24_chain = "L24";
+
+// Removes the sources and gives the chain back to the pool.
 void remove_old_bin(GstNmosaudioreceiver* self)
 {
     if(self->element_pad == nullptr)
@@ -155,27 +161,79 @@ void remove_old_bin(GstNmosaudioreceiver* self)
 
     self->clock = gst_element_get_clock(GST_ELEMENT(self));
 
-    gst_element_set_state(self->bin.get(), GST_STATE_NULL);
-
+    gst_element_set_state(self->udp_src.get(), GST_STATE_NULL);
     gst_bin_remove(GST_BIN(self), self->udp_src.get());
-    gst_bin_remove(GST_BIN(self), self->rtp_jitter_buffer.get());
-    gst_bin_remove(GST_BIN(self), self->rtp_audio_depay_16.get());
-    gst_bin_remove(GST_BIN(self), self->rtp_audio_depay_24.get());
-    gst_bin_remove(GST_BIN(self), self->queue.get());
+    if(self->merge.get() != nullptr)
+    {
+        gst_element_set_state(self->udp_src_secondary.get(), GST_STATE_NULL);
+        gst_element_set_state(self->merge.get(), GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(self), self->udp_src_secondary.get());
+        gst_bin_remove(GST_BIN(self), self->merge.get());
+    }
 
-    gst_bin_remove(GST_BIN(self), self->bin.get());
+    gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), nullptr);
+    gst_bin_remove(GST_BIN(self), self->chain);
+    self->chains->release(self->chain_format, self->chain);
+    self->chain = nullptr;
 
     self->udp_src.forget();
-    self->queue.forget();
-    self->rtp_jitter_buffer.forget();
-    self->rtp_audio_depay_16.forget();
-    self->rtp_audio_depay_24.forget();
-    self->bin.forget();
+    self->udp_src_secondary.forget();
+    self->merge.forget();
 
     if(block_id != 0)
     {
         gst_pad_remove_probe(self->element_pad, block_id);
     }
+    self->element_pad = nullptr;
+}
+
+// Joins the leg's group, taking only the packets of its source when the SDP names one.
+void set_source(GstElement* udp_src, const bisect::nmoscpp::network_leg_t& leg)
+{
+    g_object_set(G_OBJECT(udp_src), "address", leg.destination_ip.value().c_str(), "port",
+                 leg.destination_port.value(), "source-address", leg.source_ip.value_or("").c_str(), nullptr);
+}
+
+// SMPTE 2022-7: a second source on the secondary leg, and the merge that forwards each packet from whichever leg
+// delivers it first.
+bool add_secondary_leg(GstNmosaudioreceiver* self, GstCaps* caps)
+{
+    const auto& secondary = self->sdp_settings.secondary.value();
+    fmt::print("Secondary leg:\n"
+               "  - destination_ip:   {}\n"
+               "  - destination_port: {}\n"
+               "\n",
+               secondary.destination_ip.value().c_str(), secondary.destination_port.value());
+
+    auto maybe_udpsrc = GstElementHandle<GstElement>::create_element(bisect::rtp::udp_batch_src_factory, nullptr);
+    auto maybe_merge  = GstElementHandle<GstElement>::create_element(bisect::rtp::st2022_7_merge_factory, nullptr);
+    if(std::holds_alternative<std::nullptr_t>(maybe_udpsrc) || std::holds_alternative<std::nullptr_t>(maybe_merge))
+    {
+        GST_ERROR_OBJECT(self, "Failed to create the secondary leg elements.");
+        return false;
+    }
+
+    self->udp_src_secondary = std::move(std::get<GstElementHandle<GstElement>>(maybe_udpsrc));
+    self->merge             = std::move(std::get<GstElementHandle<GstElement>>(maybe_merge));
+
+    set_source(self->udp_src_secondary.get(), secondary);
+    g_object_set(G_OBJECT(self->udp_src_secondary.get()), "buffer-size", 212992, "caps", caps, nullptr);
+
+    gst_bin_add_many(GST_BIN(self), self->udp_src_secondary.get(), self->merge.get(), nullptr);
+    return true;
+}
+
+// Links the source of each leg to the chain, through the merge when there are two.
+bool link_sources(GstNmosaudioreceiver* self)
+{
+    if(self->merge.get() == nullptr)
+    {
+        return gst_element_link(self->udp_src.get(), self->chain);
+    }
+
+    return gst_element_link_pads(self->udp_src.get(), "src", self->merge.get(), "sink_0") &&
+           gst_element_link_pads(self->udp_src_secondary.get(), "src", self->merge.get(), "sink_1") &&
+           gst_element_link(self->merge.get(), self->chain);
 }
 
 void construct_pipeline(GstNmosaudioreceiver* self)
@@ -198,107 +256,52 @@ void construct_pipeline(GstNmosaudioreceiver* self)
                    audio_info.sampling_rate, self->sdp_settings.primary.destination_ip.value().c_str(),
                    self->sdp_settings.primary.destination_port.value());
 
-        auto maybe_bin = GstElementHandle<GstElement>::create_bin("dynamic-bin");
-        if(std::holds_alternative<std::nullptr_t>(maybe_bin))
+        auto maybe_udpsrc = GstElementHandle<GstElement>::create_element(bisect::rtp::udp_batch_src_factory, nullptr);
+        if(std::holds_alternative<std::nullptr_t>(maybe_udpsrc))
         {
-            GST_ERROR_OBJECT(self, "Failed to create bin");
+            GST_ERROR_OBJECT(self, "Failed to create pipeline elements.");
             return;
         }
+        self->udp_src = std::move(std::get<GstElementHandle<GstElement>>(maybe_udpsrc));
 
-        self->bin = std::move(std::get<GstElementHandle<GstElement>>(maybe_bin));
-
-        auto maybe_udpsrc  = GstElementHandle<GstElement>::create_element("udpsrc", nullptr);
-        auto maybe_queue   = GstElementHandle<GstElement>::create_element("queue", nullptr);
-        auto maybe_jitter  = GstElementHandle<GstElement>::create_element("rtpjitterbuffer", nullptr);
-        auto maybe_depay16 = GstElementHandle<GstElement>::create_element("rtpL16depay", nullptr);
-        auto maybe_depay24 = GstElementHandle<GstElement>::create_element("rtpL24depay", nullptr);
-
-        if(std::holds_alternative<std::nullptr_t>(maybe_udpsrc) ||
-           std::holds_alternative<std::nullptr_t>(maybe_queue) ||
-           std::holds_alternative<std::nullptr_t>(maybe_jitter) ||
-           std::holds_alternative<std::nullptr_t>(maybe_depay16) ||
-           std::holds_alternative<std::nullptr_t>(maybe_depay24))
+        self->chain_format = audio_info.bits_per_sample == 16 ? l16_chain : l24_chain;
+        self->chain        = self->chains->acquire(self->chain_format);
+        if(self->chain == nullptr)
         {
             GST_ERROR_OBJECT(self, "Failed to create pipeline elements.");
             return;
         }
 
-        self->udp_src            = std::move(std::get<GstElementHandle<GstElement>>(maybe_udpsrc));
-        self->queue              = std::move(std::get<GstElementHandle<GstElement>>(maybe_queue));
-        self->rtp_jitter_buffer  = std::move(std::get<GstElementHandle<GstElement>>(maybe_jitter));
-        self->rtp_audio_depay_16 = std::move(std::get<GstElementHandle<GstElement>>(maybe_depay16));
-        self->rtp_audio_depay_24 = std::move(std::get<GstElementHandle<GstElement>>(maybe_depay24));
-
-        g_object_set(
-            G_OBJECT(self->udp_src.get()), "address", self->sdp_settings.primary.destination_ip.value().c_str(), "port",
-            self->sdp_settings.primary.destination_port.value(), "do-timestamp", true, "buffer-size", 212992, nullptr);
+        set_source(self->udp_src.get(), self->sdp_settings.primary);
+        g_object_set(G_OBJECT(self->udp_src.get()), "buffer-size", 212992, nullptr);
 
         GstCaps* caps = gst_caps_new_simple("application/x-rtp", "clock-rate", G_TYPE_INT, audio_info.sampling_rate,
                                             "channels", G_TYPE_INT, audio_info.number_of_channels, nullptr);
 
         g_object_set(G_OBJECT(self->udp_src.get()), "caps", caps, nullptr);
 
-        g_object_set(G_OBJECT(self->rtp_jitter_buffer.get()), "do-lost", false, "do-retransmission", false, "mode", 0,
-                     "latency", 10, nullptr);
-
-        g_object_set(G_OBJECT(self->queue.get()), "max-size-buffers", 3, nullptr);
-
-        gst_bin_add_many(GST_BIN(self->bin.get()), self->udp_src.get(), self->rtp_jitter_buffer.get(),
-                         self->queue.get(), self->rtp_audio_depay_16.get(), self->rtp_audio_depay_24.get(), nullptr);
-
-        gst_element_sync_state_with_parent(self->udp_src.get());
-        gst_element_sync_state_with_parent(self->rtp_jitter_buffer.get());
-        gst_element_sync_state_with_parent(self->queue.get());
-        gst_element_sync_state_with_parent(self->rtp_audio_depay_16.get());
-        gst_element_sync_state_with_parent(self->rtp_audio_depay_24.get());
-
-        GstPad* bin_src_pad = nullptr;
-
-        if(audio_info.bits_per_sample == 16)
+        if(self->sdp_settings.secondary.has_value() && !add_secondary_leg(self, caps))
         {
-            if(gst_element_link_many(self->udp_src.get(), self->rtp_jitter_buffer.get(), self->queue.get(),
-                                     self->rtp_audio_depay_16.get(), nullptr) == false)
-            {
-                GST_ERROR_OBJECT(self, "Failed to link elements inside the bin.");
-                return;
-            }
-            // Create a ghost pad from the depay's src
-            bin_src_pad = gst_element_get_static_pad(self->rtp_audio_depay_16.get(), "src");
-            if(bin_src_pad == nullptr)
-            {
-                GST_ERROR_OBJECT(self, "Failed to get src pad from rtp_audio_depay.");
-                return;
-            }
-        }
-        else
-        {
-            if(gst_element_link_many(self->udp_src.get(), self->rtp_jitter_buffer.get(), self->queue.get(),
-                                     self->rtp_audio_depay_24.get(), nullptr) == false)
-            {
-                GST_ERROR_OBJECT(self, "Failed to link elements inside the bin.");
-                return;
-            }
-
-            // Create a ghost pad from the depay's src
-            bin_src_pad = gst_element_get_static_pad(self->rtp_audio_depay_24.get(), "src");
-            if(bin_src_pad == nullptr)
-            {
-                GST_ERROR_OBJECT(self, "Failed to get src pad from rtp_audio_depay.");
-                return;
-            }
+            gst_caps_unref(caps);
+            return;
         }
+        gst_caps_unref(caps);
 
-        GstPad* bin_ghost_pad = gst_ghost_pad_new("src", bin_src_pad);
-        gst_object_unref(bin_src_pad);
-        self->bin_pad = bin_ghost_pad;
+        gst_bin_add_many(GST_BIN(self), self->udp_src.get(), self->chain, nullptr);
 
-        if(bin_ghost_pad == nullptr || gst_element_add_pad(self->bin.get(), bin_ghost_pad) == false)
+        if(link_sources(self) == false)
         {
-            GST_ERROR_OBJECT(self, "Failed to create or add ghost pad to bin.");
+            GST_ERROR_OBJECT(self, "Failed to link the sources to the receive chain.");
             return;
         }
 
-        gst_bin_add(GST_BIN(self), self->bin.get());
+        gst_element_sync_state_with_parent(self->chain);
+        if(self->merge.get() != nullptr)
+        {
+            gst_element_sync_state_with_parent(self->merge.get());
+            gst_element_sync_state_with_parent(self->udp_src_secondary.get());
+        }
+        gst_element_sync_state_with_parent(self->udp_src.get());
 
         GstPad* plugin_pad = gst_element_get_static_pad(GST_ELEMENT(self), "src");
         if(plugin_pad == nullptr)
@@ -309,9 +312,12 @@ void construct_pipeline(GstNmosaudioreceiver* self)
 
         self->element_pad = plugin_pad;
 
-        if(gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), bin_ghost_pad) == false)
+        GstPad* chain_pad   = gst_element_get_static_pad(self->chain, "src");
+        const auto targeted = gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), chain_pad);
+        gst_object_unref(chain_pad);
+        if(targeted == false)
         {
-            GST_ERROR_OBJECT(self, "Failed to link plugin ghost pad to bin's ghost pad.");
+            GST_ERROR_OBJECT(self, "Failed to link plugin ghost pad to the receive chain.");
             return;
         }
         gst_object_unref(plugin_pad);
@@ -367,6 +373,10 @@ void create_nmos(GstNmosaudioreceiver* self)
                 {
                     fmt::print("Received SDP: {}\n", sdp.value());
                     auto sdp_settings = parse_sdp(sdp.value());
+                    if(sdp_settings.has_value())
+                    {
+                        sdp_settings = select_essence<bisect::nmoscpp::audio_sender_info_t>(sdp_settings.value());
+                    }
                     if(sdp_settings.has_value() && sdp.value() != self->sdp_string)
                     {
                         self->sdp_settings = sdp_settings.value();
@@ -408,6 +418,13 @@ static GstStateChangeReturn gst_nmosaudioreceiver_change_state(GstElement* eleme
     switch(transition)
     {
     case GST_STATE_CHANGE_NULL_TO_READY: {
+        // Built before the receiver is registered, so its first activation finds a chain ready.
+        if(self->chains == nullptr)
+        {
+            self->chains = std::make_unique<receive_chain_pool_t>();
+            self->chains->add_format(l16_chain, []() { return receive_chain_pool_t::make_rtp_chain("rtpL16depay"); });
+            self->chains->add_format(l24_chain, []() { return receive_chain_pool_t::make_rtp_chain("rtpL24depay"); });
+        }
         if(self->nmos_active != true)
         {
             create_nmos(self);
@@ -481,7 +498,8 @@ static void gst_nmosaudioreceiver_init(GstNmosaudioreceiver* self)
 
 static gboolean plugin_init(GstPlugin* plugin)
 {
-    return gst_element_register(plugin, "nmosaudioreceiver", GST_RANK_NONE, GST_TYPE_NMOSAUDIORECEIVER);
+    return bisect::rtp::register_elements(plugin) &&
+           gst_element_register(plugin, "nmosaudioreceiver", GST_RANK_NONE, GST_TYPE_NMOSAUDIORECEIVER);
 }
 
 #define VERSION "1.0"
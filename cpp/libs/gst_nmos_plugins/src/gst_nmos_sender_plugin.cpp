@@ -21,12 +21,16 @@
  */
 
 #include "bisect/json.h"
+#include "bisect/rtp/elements.h"
 #include "ossrf/nmos/api/nmos_client.h"
 #include "utils.hpp"
 #include "gst_nmos_plugins/include/element_class.hpp"
 #include "gst_nmos_plugins/include/nmos_configuration.hpp"
 #include <gst/gst.h>
 #include <gst/gstpad.h>
+#include <algorithm>
+#include <mutex>
+#include <optional>
 
 GST_DEBUG_CATEGORY_STATIC(gst_nmossender_debug_category);
 #define GST_CAT_DEFAULT gst_nmossender_debug_category
@@ -36,6 +40,23 @@ GST_DEBUG_CATEGORY_STATIC(gst_nmossender_debug_category);
 #define GST_IS_NMOSSENDER(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_NMOSSENDER))
 #define GST_IS_NMOSSENDER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_NMOSSENDER))
 
+// A change requested by an IS-05 activation, applied by the streaming thread between two frames.
+struct sender_command_t
+{
+    bool enabled = false;
+    std::string destination_ip;
+    int destination_port = 0;
+    gint64 activated_at  = 0;
+};
+
+// The newest activation the streaming thread has not applied yet. An activation replaces any older one still pending,
+// since the newest one describes the whole state the sender must reach.
+struct pending_command_t
+{
+    std::mutex mutex;
+    std::optional<sender_command_t> command;
+};
+
 typedef struct _GstNmossender
 {
     GstBin parent;
@@ -45,7 +66,14 @@ typedef struct _GstNmossender
     GstElementHandle<_GstElement> audio_payloader_16;
     GstElementHandle<_GstElement> audio_payloader_24;
     GstElementHandle<_GstElement> udpsink;
-    gulong block_id;
+    // The payloader the queue is linked to, once the format is known.
+    GstElement* payloader;
+    std::unique_ptr<pending_command_t> pending;
+    // Streaming thread only.
+    bool enabled;
+    gint64 activated_at;
+    // The probe timing the first packet after the last activation, until that packet is sent.
+    gulong first_packet_probe;
     ossrf::nmos_client_uptr client;
     GstCaps* caps;
     config_fields_t config;
@@ -70,7 +98,10 @@ enum class PropertyId : uint32_t
     SourceAddress          = 9,
     InterfaceName          = 10,
     DestinationAddress     = 11,
-    DestinationPort        = 12
+    DestinationPort        = 12,
+    UdpBatchSize           = 13,
+    UdpGso                 = 14,
+    Caps                   = 15
 };
 
 G_DEFINE_TYPE_WITH_CODE(GstNmossender, gst_nmossender, GST_TYPE_BIN,
@@ -79,13 +110,102 @@ G_DEFINE_TYPE_WITH_CODE(GstNmossender, gst_nmossender, GST_TYPE_BIN,
 /* Pad template */
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_REQUEST,
                                                                     GST_STATIC_CAPS("video/x-raw, "
-                                                                                    "format=(string){ UYVP }; "
+                                                                                    "format=(string){ UYVP, v210, I422_10LE }; "
                                                                                     "audio/x-raw, "
                                                                                     "format=(string){ S24BE, S16BE }, "
                                                                                     "layout=(string)interleaved, "
                                                                                     "rate=(int)[ 1, 2147483647 ], "
                                                                                     "channels=(int)[ 1, 2147483647 ]"));
 
+/* Links the queue to `payloader` and the payloader to the sink, replacing the payloader linked before */
+static bool link_payloader(GstNmossender* self, GstElement* payloader)
+{
+    if(self->payloader == payloader)
+    {
+        return true;
+    }
+    if(self->payloader != nullptr)
+    {
+        gst_element_unlink_many(self->queue.get(), self->payloader, self->udpsink.get(), nullptr);
+        self->payloader = nullptr;
+    }
+    if(gst_element_link(self->queue.get(), payloader) == false)
+    {
+        GST_ERROR_OBJECT(self, "Failed to link queue to %s", GST_ELEMENT_NAME(payloader));
+        return false;
+    }
+    if(gst_element_link(payloader, self->udpsink.get()) == false)
+    {
+        GST_ERROR_OBJECT(self, "Failed to link %s to udpsink", GST_ELEMENT_NAME(payloader));
+        return false;
+    }
+    self->payloader = payloader;
+    return true;
+}
+
+/* Takes the sender's format from `caps` and links the matching payloader. Called with the caps property, before the
+ * pipeline runs, and again on each CAPS event. */
+static bool apply_caps(GstNmossender* self, GstCaps* caps)
+{
+    const GstStructure* structure = gst_caps_get_structure(caps, 0);
+    std::string media_type        = gst_structure_get_name(structure);
+    GstElement* payloader         = nullptr;
+
+    if(media_type == "audio/x-raw")
+    {
+        self->config.is_audio = true;
+        gint rate, channels;
+        const gchar* format;
+        if(gst_structure_get_int(structure, "rate", &rate))
+        {
+            self->config.audio_sender_fields.sampling_rate = rate;
+        }
+        if(gst_structure_get_int(structure, "channels", &channels))
+        {
+            self->config.audio_sender_fields.number_of_channels = channels;
+        }
+        if((format = gst_structure_get_string(structure, "format")))
+        {
+            self->config.audio_sender_fields.format = format;
+        }
+        payloader = self->config.audio_sender_fields.format == "S24BE" ? self->audio_payloader_24.get()
+                                                                       : self->audio_payloader_16.get();
+    }
+    else if(media_type == "video/x-raw")
+    {
+        self->config.is_audio = false;
+        gint width, height;
+        const gchar* format;
+        if(gst_structure_get_int(structure, "width", &width))
+        {
+            self->config.video_media_fields.width = width;
+        }
+        if(gst_structure_get_int(structure, "height", &height))
+        {
+            self->config.video_media_fields.height = height;
+        }
+        if((format = gst_structure_get_string(structure, "format")))
+        {
+            self->config.video_media_fields.sampling = translate_video_format(format);
+        }
+        gint num, den;
+        if(gst_structure_get_fraction(structure, "framerate", &num, &den))
+        {
+            self->config.video_media_fields.frame_rate_num = num;
+            self->config.video_media_fields.frame_rate_den = den;
+        }
+        payloader = self->video_payloader.get();
+    }
+    else
+    {
+        GST_WARNING_OBJECT(self, "Unsupported media type: %s", media_type.c_str());
+        return true;
+    }
+
+    gst_caps_replace(&self->caps, caps);
+    return link_payloader(self, payloader);
+}
+
 /* Set properties so element variables can change depending on them */
 static void gst_nmossender_set_property(GObject* object, guint property_id, const GValue* value, GParamSpec* pspec)
 {
@@ -117,6 +237,26 @@ static void gst_nmossender_set_property(GObject* object, guint property_id, cons
         self->config.network.destination_port = atoi(g_value_get_string(value));
         g_object_set(G_OBJECT(self->udpsink.get()), "port", self->config.network.destination_port, nullptr);
         break;
+    case PropertyId::UdpBatchSize:
+        self->config.network.udp_batch_size = std::max(1, atoi(g_value_get_string(value)));
+        g_object_set(G_OBJECT(self->udpsink.get()), "batch-size", self->config.network.udp_batch_size, nullptr);
+        break;
+    case PropertyId::UdpGso:
+        self->config.network.udp_gso = g_strcmp0(g_value_get_string(value), "true") == 0;
+        g_object_set(G_OBJECT(self->udpsink.get()), "gso", self->config.network.udp_gso, nullptr);
+        break;
+    case PropertyId::Caps: {
+        const auto* caps = gst_value_get_caps(value);
+        if(caps != nullptr && gst_caps_is_fixed(caps))
+        {
+            apply_caps(self, const_cast<GstCaps*>(caps));
+        }
+        else if(caps != nullptr)
+        {
+            GST_WARNING_OBJECT(self, "Ignoring caps that are not fixed");
+        }
+        break;
+    }
 
     default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
     }
@@ -144,18 +284,65 @@ static void gst_nmossender_get_property(GObject* object, guint property_id, GVal
         g_value_set_string(value, self->config.network.destination_address.c_str());
         break;
     case PropertyId::DestinationPort: g_value_set_int(value, self->config.network.destination_port); break;
+    case PropertyId::UdpBatchSize:
+        g_value_take_string(value, g_strdup_printf("%u", self->config.network.udp_batch_size));
+        break;
+    case PropertyId::UdpGso: g_value_set_string(value, self->config.network.udp_gso ? "true" : "false"); break;
+    case PropertyId::Caps: gst_value_set_caps(value, self->caps); break;
 
     default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
     }
 }
 
-static GstPadProbeReturn block_pad_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+static GstPadProbeReturn first_packet_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    GstNmossender* self = (GstNmossender*)user_data;
+    GST_INFO_OBJECT(self, "First packet %" G_GINT64_FORMAT " us after activation",
+                    g_get_monotonic_time() - self->activated_at);
+    self->first_packet_probe = 0;
+    return GST_PAD_PROBE_REMOVE;
+}
+
+static void apply_command(GstNmossender* self, const sender_command_t& command)
+{
+    self->enabled = command.enabled;
+    if(!command.enabled)
+    {
+        return;
+    }
+
+    g_object_set(G_OBJECT(self->udpsink.get()), "host", command.destination_ip.c_str(), "port",
+                 command.destination_port, nullptr);
+
+    // Time from the activation to the first packet handed to the sink. An activation that comes before any packet was
+    // sent replaces the probe of the previous one.
+    self->activated_at = command.activated_at;
+    GstPad* sink_pad   = gst_element_get_static_pad(self->udpsink.get(), "sink");
+    if(self->first_packet_probe != 0)
+    {
+        gst_pad_remove_probe(sink_pad, self->first_packet_probe);
+    }
+    self->first_packet_probe =
+        gst_pad_add_probe(sink_pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                          first_packet_probe_cb, self, nullptr);
+    gst_object_unref(sink_pad);
+}
+
+/* Runs on the streaming thread for each buffer leaving the queue, a whole frame, before it is payloaded. Activations
+ * take effect here, so a frame is sent entirely to the old destination or entirely to the new one. */
+static GstPadProbeReturn frame_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER)
+    GstNmossender* self = (GstNmossender*)user_data;
+    std::optional<sender_command_t> command;
+    {
+        std::lock_guard lock(self->pending->mutex);
+        command.swap(self->pending->command);
+    }
+    if(command.has_value())
     {
-        return GST_PAD_PROBE_DROP;
+        apply_command(self, *command);
     }
-    return GST_PAD_PROBE_OK;
+    return self->enabled ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
 }
 
 /* Event handler for the sink pad */
@@ -168,111 +355,22 @@ static gboolean gst_nmossender_sink_event(GstPad* pad, GstObject* parent, GstEve
     case GST_EVENT_CAPS: {
         GstCaps* caps = nullptr;
         gst_event_parse_caps(event, &caps);
-        if(caps)
+        if(caps == nullptr)
         {
-            gchar* caps_str = gst_caps_to_string(caps);
-
-            const GstStructure* structure = gst_caps_get_structure(caps, 0);
-            std::string media_type        = gst_structure_get_name(structure);
-
-            if(media_type == "audio/x-raw")
-            {
+            GST_WARNING_OBJECT(self, "No caps found in CAPS event");
+            break;
+        }
 
-                self->caps            = gst_caps_ref(caps);
-                self->config.is_audio = true;
-                for(guint i = 0; i < gst_caps_get_size(caps); i++)
-                {
-                    gint rate, channels;
-                    const gchar* format;
-                    if(gst_structure_get_int(structure, "rate", &rate))
-                    {
-                        self->config.audio_sender_fields.sampling_rate = rate;
-                    }
-                    if(gst_structure_get_int(structure, "channels", &channels))
-                    {
-                        self->config.audio_sender_fields.number_of_channels = channels;
-                    }
-                    if((format = gst_structure_get_string(structure, "format")))
-                    {
-                        self->config.audio_sender_fields.format = format;
-                    }
-                }
-                if(self->config.audio_sender_fields.format == "S24BE")
-                {
-                    if(gst_element_link(self->queue.get(), self->audio_payloader_24.get()) == false)
-                    {
-                        GST_ERROR_OBJECT(self, "Failed to link queue to audio_payloader");
-                        return false;
-                    }
-                    if(gst_element_link(self->audio_payloader_24.get(), self->udpsink.get()) == false)
-                    {
-                        GST_ERROR_OBJECT(self, "Failed to link audio_payloader_24 to udpsink");
-                        return false;
-                    }
-                }
-                else
-                {
-                    if(gst_element_link(self->queue.get(), self->audio_payloader_16.get()) == false)
-                    {
-                        GST_ERROR_OBJECT(self, "Failed to link queue to audio_payloader");
-                        return false;
-                    }
-                    if(gst_element_link(self->audio_payloader_16.get(), self->udpsink.get()) == false)
-                    {
-                        GST_ERROR_OBJECT(self, "Failed to link audio_payloader_16 to udpsink");
-                        return false;
-                    }
-                }
-            }
-            else if(media_type == "video/x-raw")
-            {
-                if(gst_element_link(self->queue.get(), self->video_payloader.get()) == false)
-                {
-                    GST_ERROR_OBJECT(self, "Failed to link queue to video_payloader");
-                    return false;
-                }
-                if(gst_element_link(self->video_payloader.get(), self->udpsink.get()) == false)
-                {
-                    GST_ERROR_OBJECT(self, "Failed to link video_payloader to udpsink");
-                    return false;
-                }
-                self->caps            = gst_caps_ref(caps);
-                self->config.is_audio = false;
-                for(guint i = 0; i < gst_caps_get_size(caps); i++)
-                {
-                    gint width, height;
-                    const gchar* format;
-                    if(gst_structure_get_int(structure, "width", &width))
-                    {
-                        self->config.video_media_fields.width = width;
-                    }
-                    if(gst_structure_get_int(structure, "height", &height))
-                    {
-                        self->config.video_media_fields.height = height;
-                    }
-                    if((format = gst_structure_get_string(structure, "format")))
-                    {
-                        self->config.video_media_fields.sampling = translate_video_format(format);
-                    }
-                    gint num, den;
-                    if(gst_structure_get_fraction(structure, "framerate", &num, &den))
-                    {
-                        self->config.video_media_fields.frame_rate_num = num;
-                        self->config.video_media_fields.frame_rate_den = den;
-                    }
-                }
-            }
-            else
-            {
-                GST_WARNING_OBJECT(self, "Unsupported media type: %s", media_type.c_str());
-            }
-            g_free(caps_str);
+        // A sender registered with the caps property keeps advertising those.
+        if(self->nmos_active && self->caps != nullptr && !gst_caps_is_equal(caps, self->caps))
+        {
+            GST_WARNING_OBJECT(self, "Upstream caps differ from the caps the sender was registered with");
         }
-        else
+        if(!apply_caps(self, caps))
         {
-            GST_WARNING_OBJECT(self, "No caps found in CAPS event");
+            gst_event_unref(event);
+            return false;
         }
-
         break;
     }
     default: break;
@@ -283,10 +381,10 @@ static gboolean gst_nmossender_sink_event(GstPad* pad, GstObject* parent, GstEve
 
 void create_nmos(GstNmossender* self)
 {
+    // Called on an nmos-cpp thread: only hands the change over to the streaming thread.
     auto sender_activation_callback = [self](bool master_enabled, const nlohmann::json& transport_params) {
         fmt::print("nmos_sender_callback: master_enabled={}, transport_params={}\n", master_enabled,
                    transport_params.dump());
-        GstPad* pad = gst_element_get_static_pad(self->queue.get(), "sink");
         nlohmann::json_abi_v3_11_3::basic_json<>::value_type param;
         bool rtp_enabled = false;
         if(transport_params.is_array() && !transport_params.empty())
@@ -297,35 +395,25 @@ void create_nmos(GstNmossender* self)
                 rtp_enabled = param["rtp_enabled"].get<bool>();
             }
         }
-        if(master_enabled && rtp_enabled)
+
+        sender_command_t command{.enabled          = master_enabled && rtp_enabled,
+                                 .destination_ip   = {},
+                                 .destination_port = 9999,
+                                 .activated_at     = g_get_monotonic_time()};
+        if(command.enabled)
         {
-            if(self->block_id == 0)
-            {
-                self->block_id =
-                    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, block_pad_probe_cb, nullptr, nullptr);
-            }
-            std::string dest_ip;
             if(param.contains("destination_ip"))
             {
-                dest_ip = param["destination_ip"].get<std::string>();
+                command.destination_ip = param["destination_ip"].get<std::string>();
             }
-            int dest_port = 9999;
             if(param.contains("destination_port"))
             {
-                dest_port = param["destination_port"].get<int>();
-            }
-            g_object_set(G_OBJECT(self->udpsink.get()), "host", dest_ip.c_str(), "port", dest_port, nullptr);
-            if(self->block_id != 0)
-            {
-                gst_pad_remove_probe(pad, self->block_id);
-                self->block_id = 0;
+                command.destination_port = param["destination_port"].get<int>();
             }
         }
-        else
-        {
-            self->block_id =
-                gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, block_pad_probe_cb, nullptr, nullptr);
-        }
+
+        std::lock_guard lock(self->pending->mutex);
+        self->pending->command = std::move(command);
     };
     const auto node_config_json = create_node_config(self->config);
     if(node_config_json == nullptr)
@@ -366,7 +454,8 @@ void create_nmos(GstNmossender* self)
     }
 }
 
-/* State Change so it doesn't boot NMOS without pipeline being set to playing */
+/* State Change so NMOS isn't booted before the sender's format is known: at READY when the caps property gives it,
+ * otherwise once the pipeline is set to playing, after upstream has negotiated */
 static GstStateChangeReturn gst_nmossender_change_state(GstElement* element, GstStateChange transition)
 {
     GstStateChangeReturn ret;
@@ -374,6 +463,15 @@ static GstStateChangeReturn gst_nmossender_change_state(GstElement* element, Gst
 
     switch(transition)
     {
+    case GST_STATE_CHANGE_NULL_TO_READY: {
+        if(self->nmos_active != true && self->caps != nullptr)
+        {
+            create_nmos(self);
+            self->nmos_active = true;
+        }
+    }
+    break;
+
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING: {
         if(self->nmos_active != true)
         {
@@ -433,6 +531,15 @@ static void gst_nmossender_class_init(GstNmossenderClass* klass)
     add_property(object_class, 11, "destination-address", "Destination Address", "The address of the destination",
                  "127.0.0.1");
     add_property(object_class, 12, "destination-port", "Destination Port", "Port of the destination", "9999");
+    add_property(object_class, 13, "udp-batch-size", "UDP Batch Size", "Maximum number of packets per sendmmsg call",
+                 "64");
+    add_property(object_class, 14, "udp-gso", "UDP GSO",
+                 "Use UDP generic segmentation offload for equal-sized packets (true/false)", "false");
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::Caps),
+        g_param_spec_boxed("caps", "Caps",
+                           "Format of the stream, to register the sender and link the payloader before negotiation",
+                           GST_TYPE_CAPS, (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
     gst_element_class_set_static_metadata(element_class, "NMOS Sender", "Sink/Network",
                                           "Processes raw video and sends it over RTP and UDP to NMOS client",
@@ -447,10 +554,10 @@ static void gst_nmossender_init(GstNmossender* self)
     auto maybeBin = GstElementHandle<GstElement>::create_bin("dynamic-bin");
 
     auto maybeQueue      = GstElementHandle<GstElement>::create_element("queue", nullptr);
-    auto maybeVideoPay   = GstElementHandle<GstElement>::create_element("rtpvrawpay", nullptr);
+    auto maybeVideoPay   = GstElementHandle<GstElement>::create_element(bisect::rtp::st2110_20_pay_factory, nullptr);
     auto maybeAudioPay16 = GstElementHandle<GstElement>::create_element("rtpL16pay", nullptr);
     auto maybeAudioPay24 = GstElementHandle<GstElement>::create_element("rtpL24pay", nullptr);
-    auto maybeUdpSink    = GstElementHandle<GstElement>::create_element("udpsink", nullptr);
+    auto maybeUdpSink    = GstElementHandle<GstElement>::create_element(bisect::rtp::udp_batch_sink_factory, nullptr);
 
     if(std::holds_alternative<std::nullptr_t>(maybeBin) || std::holds_alternative<std::nullptr_t>(maybeQueue) ||
        std::holds_alternative<std::nullptr_t>(maybeVideoPay) ||
@@ -469,9 +576,9 @@ static void gst_nmossender_init(GstNmossender* self)
 
     // set properties
     g_object_set(G_OBJECT(self->queue.get()), "max-size-buffers", 1, nullptr);
-    g_object_set(G_OBJECT(self->udpsink.get()), "host", "127.0.0.1", "port", 9999, "is-live", true, "async", false,
-                 nullptr);
     create_default_config_fields_sender(&self->config);
+    g_object_set(G_OBJECT(self->udpsink.get()), "host", "127.0.0.1", "port", 9999, "async", false, "batch-size",
+                 self->config.network.udp_batch_size, "gso", self->config.network.udp_gso, nullptr);
 
     gst_bin_add_many(GST_BIN(self), self->queue.get(), self->video_payloader.get(), self->audio_payloader_24.get(),
                      self->audio_payloader_16.get(), self->udpsink.get(), nullptr);
@@ -494,6 +601,14 @@ static void gst_nmossender_init(GstNmossender* self)
 
     gst_pad_set_event_function(sink_ghost_pad, gst_nmossender_sink_event);
 
+    // Sends until the first activation says otherwise, as before NMOS is up.
+    self->pending            = std::make_unique<pending_command_t>();
+    self->enabled            = true;
+    self->first_packet_probe = 0;
+    GstPad* queue_srcpad     = gst_element_get_static_pad(self->queue.get(), "src");
+    gst_pad_add_probe(queue_srcpad, GST_PAD_PROBE_TYPE_BUFFER, frame_probe_cb, self, nullptr);
+    gst_object_unref(queue_srcpad);
+
     if(gst_element_add_pad(GST_ELEMENT(self), sink_ghost_pad) == false)
     {
         GST_ERROR_OBJECT(self, "Failed to add ghost pad to element; pad with same name might exist");
@@ -504,7 +619,8 @@ static void gst_nmossender_init(GstNmossender* self)
 
 static gboolean plugin_init(GstPlugin* plugin)
 {
-    return gst_element_register(plugin, "nmossender", GST_RANK_NONE, GST_TYPE_NMOSSENDER);
+    return bisect::rtp::register_elements(plugin) &&
+           gst_element_register(plugin, "nmossender", GST_RANK_NONE, GST_TYPE_NMOSSENDER);
 }
 
 #define VERSION "1.0"
@@ -25,12 +25,16 @@
 #include "bisect/sdp.h"
 #include "bisect/sdp/reader.h"
 #include "bisect/nmoscpp/configuration.h"
+#include "bisect/rtp/elements.h"
 #include "ossrf/nmos/api/nmos_client.h"
 #include "utils.hpp"
+#include "receive_chain_pool.hpp"
+#include "watchdog.hpp"
 #include "gst_nmos_plugins/include/element_class.hpp"
 #include "gst_nmos_plugins/include/nmos_configuration.hpp"
 #include <gst/gst.h>
 #include <gst/gstpad.h>
+#include <mutex>
 
 using namespace bisect;
 using namespace bisect::sdp;
@@ -48,21 +52,24 @@ typedef struct _GstNmosvideoreceiver
 {
     GstBin parent;
     GstPad* element_pad;
-    GstPad* bin_pad;
-    GstElementHandle<_GstElement> bin;
+    // The jitter buffer, queue and depayloader, taken from `chains` on activation.
+    GstElement* chain;
+    // The depayloader factory `chain` was taken for, which is also its format in the pool.
+    const char* chain_format;
+    std::unique_ptr<receive_chain_pool_t> chains;
     GstElementHandle<_GstElement> udp_src;
-    GstElementHandle<_GstElement> rtp_video_depay;
-    GstElementHandle<_GstElement> rtp_jitter_buffer;
-    GstElementHandle<_GstElement> queue;
+    GstElementHandle<_GstElement> udp_src_secondary;
+    GstElementHandle<_GstElement> merge;
 
     ossrf::nmos_client_uptr client;
     config_fields_t config;
     sdp_settings_t sdp_settings;
     std::string sdp_string;
     bool nmos_active;
-    bool pipeline_clear;
     bool user_forced_stop;
-    gint64 last_buffer_time;
+    std::unique_ptr<no_data_watchdog_t> watchdog;
+    // Held by the activation callback and by the restart after a silence, which both rework the bin.
+    std::unique_ptr<std::mutex> activation_mutex;
 } GstNmosvideoreceiver;
 
 typedef struct _GstNmosvideoreceiverClass
@@ -92,9 +99,12 @@ enum class PropertyId : uint32_t
     ReceiverId             = 6,
     ReceiverLabel          = 7,
     ReceiverDescription    = 8,
-    DstAddress             = 9
+    DstAddress             = 9,
+    NoDataTimeout          = 10
 };
 
+constexpr guint default_no_data_timeout_ms = 6000;
+
 // Set properties so element variables can change depending on them
 static void gst_nmosvideoreceiver_set_property(GObject* object, guint property_id, const GValue* value,
                                                GParamSpec* pspec)
@@ -114,6 +124,9 @@ static void gst_nmosvideoreceiver_set_property(GObject* object, guint property_i
     case PropertyId::ReceiverLabel: self->config.label = g_value_dup_string(value); break;
     case PropertyId::ReceiverDescription: self->config.description = g_value_dup_string(value); break;
     case PropertyId::DstAddress: self->config.address = g_value_dup_string(value); break;
+    case PropertyId::NoDataTimeout:
+        if(self->watchdog) self->watchdog->set_timeout(std::chrono::milliseconds(g_value_get_uint(value)));
+        break;
 
     default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
     }
@@ -137,6 +150,10 @@ static void gst_nmosvideoreceiver_get_property(GObject* object, guint property_i
     case PropertyId::ReceiverLabel: g_value_set_string(value, self->config.label.c_str()); break;
     case PropertyId::ReceiverDescription: g_value_set_string(value, self->config.description.c_str()); break;
     case PropertyId::DstAddress: g_value_set_string(value, self->config.address.c_str()); break;
+    case PropertyId::NoDataTimeout:
+        g_value_set_uint(value, self->watchdog ? static_cast<guint>(self->watchdog->timeout().count())
+                                               : default_no_data_timeout_ms);
+        break;
 
     default: G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec); break;
     }
@@ -147,6 +164,7 @@ static GstPadProbeReturn block_pad_probe_cb(GstPad* pad, GstPadProbeInfo* info,
     return GST_PAD_PROBE_DROP;
 }
 
+// Detaches the sources from the chain and gives the chain back to the pool. The primary source stays in the element.
 void remove_old_bin(GstNmosvideoreceiver* self)
 {
     if(self->element_pad == nullptr)
@@ -160,20 +178,22 @@ void remove_old_bin(GstNmosvideoreceiver* self)
     gst_element_send_event(GST_ELEMENT(self), gst_event_new_flush_stop(false));
 
     gst_element_set_state(self->udp_src.get(), GST_STATE_NULL);
-    gst_element_set_state(self->bin.get(), GST_STATE_NULL);
-
-    gst_bin_remove(GST_BIN(self->bin.get()), self->rtp_jitter_buffer.get());
-    gst_bin_remove(GST_BIN(self->bin.get()), self->rtp_video_depay.get());
-    gst_bin_remove(GST_BIN(self->bin.get()), self->queue.get());
+    if(self->merge.get() != nullptr)
+    {
+        gst_element_set_state(self->udp_src_secondary.get(), GST_STATE_NULL);
+        gst_element_set_state(self->merge.get(), GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(self), self->udp_src_secondary.get());
+        gst_bin_remove(GST_BIN(self), self->merge.get());
+    }
 
-    gst_bin_remove(GST_BIN(self), self->bin.get());
+    gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), nullptr);
+    gst_bin_remove(GST_BIN(self), self->chain);
+    self->chains->release(self->chain_format, self->chain);
+    self->chain = nullptr;
 
-    self->queue.forget();
-    self->rtp_jitter_buffer.forget();
-    self->rtp_video_depay.forget();
-    self->bin.forget();
+    self->udp_src_secondary.forget();
+    self->merge.forget();
 
-    gst_element_set_state(self->bin.get(), GST_STATE_PLAYING);
     if(block_id != 0)
     {
         gst_pad_remove_probe(self->element_pad, block_id);
@@ -181,18 +201,90 @@ void remove_old_bin(GstNmosvideoreceiver* self)
     self->element_pad = nullptr;
 }
 
-static GstPadProbeReturn buffer_monitor_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+// Each buffer leaving the element is a whole frame.
+static GstPadProbeReturn frame_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER)
+    GstNmosvideoreceiver* self = (GstNmosvideoreceiver*)user_data;
+    if(self->watchdog != nullptr) self->watchdog->frame();
+    return GST_PAD_PROBE_OK;
+}
+
+// The depayloader, jitter buffer and queue only depend on the format of the stream, not on where it comes from.
+bool same_format(const sdp_settings_t& current, const sdp_settings_t& next)
+{
+    const auto* a = std::get_if<bisect::nmoscpp::video_sender_info_t>(&current.format);
+    const auto* b = std::get_if<bisect::nmoscpp::video_sender_info_t>(&next.format);
+    if(a == nullptr || b == nullptr) return false;
+
+    return a->width == b->width && a->height == b->height && a->exact_framerate == b->exact_framerate &&
+           a->chroma_sub_sampling == b->chroma_sub_sampling && a->structure == b->structure && a->depth == b->depth &&
+           current.rtp.payload_type == next.rtp.payload_type &&
+           current.secondary.has_value() == next.secondary.has_value();
+}
+
+void set_source(GstElement* udp_src, const bisect::nmoscpp::network_leg_t& leg)
+{
+    g_object_set(G_OBJECT(udp_src), "address", leg.destination_ip.value().c_str(), "port",
+                 leg.destination_port.value(), "source-address", leg.source_ip.value_or("").c_str(), nullptr);
+}
+
+// Re-points the running sources at a new stream of the same format. Each source joins the new group before leaving
+// the old one and everything downstream of them stays as it is, so the switch costs the packets in flight rather
+// than a rebuild of the bin.
+bool retarget_sources(GstNmosvideoreceiver* self, const sdp_settings_t& next)
+{
+    if(self->element_pad == nullptr || !same_format(self->sdp_settings, next)) return false;
+
+    GST_INFO_OBJECT(self, "Re-targeting receiver to %s:%d", next.primary.destination_ip.value().c_str(),
+                    next.primary.destination_port.value());
+    set_source(self->udp_src.get(), next.primary);
+    if(next.secondary.has_value())
     {
-        GstNmosvideoreceiver* self = (GstNmosvideoreceiver*)user_data;
-        self->last_buffer_time     = g_get_monotonic_time();
-        if(self->pipeline_clear == true)
-        {
-            self->pipeline_clear = false;
-        }
+        set_source(self->udp_src_secondary.get(), next.secondary.value());
     }
-    return GST_PAD_PROBE_OK;
+    return true;
+}
+
+// SMPTE 2022-7: a second batched source on the secondary leg, and the merge that forwards each packet from whichever
+// leg delivers it first.
+bool add_secondary_leg(GstNmosvideoreceiver* self, GstCaps* caps)
+{
+    const auto& secondary = self->sdp_settings.secondary.value();
+    fmt::print("Secondary leg:\n"
+               "  - destination_ip:   {}\n"
+               "  - destination_port: {}\n"
+               "\n",
+               secondary.destination_ip.value().c_str(), secondary.destination_port.value());
+
+    auto maybe_udpsrc = GstElementHandle<GstElement>::create_element(bisect::rtp::udp_batch_src_factory, nullptr);
+    auto maybe_merge  = GstElementHandle<GstElement>::create_element(bisect::rtp::st2022_7_merge_factory, nullptr);
+    if(std::holds_alternative<std::nullptr_t>(maybe_udpsrc) || std::holds_alternative<std::nullptr_t>(maybe_merge))
+    {
+        GST_ERROR_OBJECT(self, "Failed to create the secondary leg elements.");
+        return false;
+    }
+
+    self->udp_src_secondary = std::move(std::get<GstElementHandle<GstElement>>(maybe_udpsrc));
+    self->merge             = std::move(std::get<GstElementHandle<GstElement>>(maybe_merge));
+
+    set_source(self->udp_src_secondary.get(), secondary);
+    g_object_set(G_OBJECT(self->udp_src_secondary.get()), "buffer-size", 67108864, "caps", caps, nullptr);
+
+    gst_bin_add_many(GST_BIN(self), self->udp_src_secondary.get(), self->merge.get(), nullptr);
+    return true;
+}
+
+// Links the source of each leg to the chain, through the merge when there are two.
+bool link_sources(GstNmosvideoreceiver* self)
+{
+    if(self->merge.get() == nullptr)
+    {
+        return gst_element_link(self->udp_src.get(), self->chain);
+    }
+
+    return gst_element_link_pads(self->udp_src.get(), "src", self->merge.get(), "sink_0") &&
+           gst_element_link_pads(self->udp_src_secondary.get(), "src", self->merge.get(), "sink_1") &&
+           gst_element_link(self->merge.get(), self->chain);
 }
 
 void construct_pipeline(GstNmosvideoreceiver* self)
@@ -219,33 +311,16 @@ void construct_pipeline(GstNmosvideoreceiver* self)
                    self->sdp_settings.primary.destination_ip.value().c_str(),
                    self->sdp_settings.primary.destination_port.value());
 
-        auto maybe_bin = GstElementHandle<GstElement>::create_bin("dynamic-bin");
-        if(std::holds_alternative<std::nullptr_t>(maybe_bin))
-        {
-            GST_ERROR_OBJECT(self, "Failed to create bin");
-            return;
-        }
-
-        self->bin = std::move(std::get<GstElementHandle<GstElement>>(maybe_bin));
-
-        auto maybe_queue  = GstElementHandle<GstElement>::create_element("queue", nullptr);
-        auto maybe_jitter = GstElementHandle<GstElement>::create_element("rtpjitterbuffer", nullptr);
-        auto maybe_depay  = GstElementHandle<GstElement>::create_element("rtpvrawdepay", nullptr);
-
-        if(std::holds_alternative<std::nullptr_t>(maybe_queue) ||
-           std::holds_alternative<std::nullptr_t>(maybe_jitter) || std::holds_alternative<std::nullptr_t>(maybe_depay))
+        self->chain_format = bisect::rtp::raw_video_depay_factory(video_info.chroma_sub_sampling, video_info.depth);
+        self->chain        = self->chains->acquire(self->chain_format);
+        if(self->chain == nullptr)
         {
             GST_ERROR_OBJECT(self, "Failed to create pipeline elements.");
             return;
         }
 
-        self->queue             = std::move(std::get<GstElementHandle<GstElement>>(maybe_queue));
-        self->rtp_jitter_buffer = std::move(std::get<GstElementHandle<GstElement>>(maybe_jitter));
-        self->rtp_video_depay   = std::move(std::get<GstElementHandle<GstElement>>(maybe_depay));
-
-        g_object_set(G_OBJECT(self->udp_src.get()), "address",
-                     self->sdp_settings.primary.destination_ip.value().c_str(), "port",
-                     self->sdp_settings.primary.destination_port.value(), "buffer-size", 67108864, nullptr);
+        set_source(self->udp_src.get(), self->sdp_settings.primary);
+        g_object_set(G_OBJECT(self->udp_src.get()), "buffer-size", 67108864, nullptr);
 
         GstCaps* caps = gst_caps_new_simple(
             "application/x-rtp", "media", G_TYPE_STRING, "video", "clock-rate", G_TYPE_INT, 90000, "encoding-name",
@@ -257,48 +332,31 @@ void construct_pipeline(GstNmosvideoreceiver* self)
 
         g_object_set(G_OBJECT(self->udp_src.get()), "caps", caps, nullptr);
 
-        g_object_set(G_OBJECT(self->rtp_jitter_buffer.get()), "do-lost", false, "do-retransmission", false, "mode", 0,
-                     "latency", 10, nullptr);
-
-        g_object_set(G_OBJECT(self->queue.get()), "max-size-buffers", 3, nullptr);
-
-        gst_bin_add_many(GST_BIN(self->bin.get()), self->rtp_jitter_buffer.get(), self->queue.get(),
-                         self->rtp_video_depay.get(), nullptr);
-
-        // Even though this is supposedly re-adding the udp_src, the function checks
-        // the bin's elements before adding them and skips the ones that are already
-        // there, so it only add's the new bin (not requiring if/else verification)
-        gst_bin_add_many(GST_BIN(self), self->udp_src.get(), self->bin.get(), nullptr);
-
-        gst_element_sync_state_with_parent(self->udp_src.get());
-        gst_element_sync_state_with_parent(self->rtp_jitter_buffer.get());
-        gst_element_sync_state_with_parent(self->queue.get());
-        gst_element_sync_state_with_parent(self->rtp_video_depay.get());
-
-        if(gst_element_link_many(self->udp_src.get(), self->rtp_jitter_buffer.get(), self->queue.get(),
-                                 self->rtp_video_depay.get(), nullptr) == false)
+        if(self->sdp_settings.secondary.has_value() && !add_secondary_leg(self, caps))
         {
-            GST_ERROR_OBJECT(self, "Failed to link elements inside the bin.");
+            gst_caps_unref(caps);
             return;
         }
+        gst_caps_unref(caps);
 
-        // Create a ghost pad from the depay's src
-        GstPad* bin_src_pad = gst_element_get_static_pad(self->rtp_video_depay.get(), "src");
-        if(bin_src_pad == nullptr)
+        // Even though this is supposedly re-adding the udp_src, the function checks
+        // the bin's elements before adding them and skips the ones that are already
+        // there, so it only add's the chain (not requiring if/else verification)
+        gst_bin_add_many(GST_BIN(self), self->udp_src.get(), self->chain, nullptr);
+
+        if(link_sources(self) == false)
         {
-            GST_ERROR_OBJECT(self, "Failed to get src pad from rtp_video_depay.");
+            GST_ERROR_OBJECT(self, "Failed to link the sources to the receive chain.");
             return;
         }
 
-        GstPad* bin_ghost_pad = gst_ghost_pad_new("src", bin_src_pad);
-        gst_object_unref(bin_src_pad);
-        self->bin_pad = bin_ghost_pad;
-
-        if(bin_ghost_pad == nullptr || gst_element_add_pad(self->bin.get(), bin_ghost_pad) == false)
+        gst_element_sync_state_with_parent(self->chain);
+        if(self->merge.get() != nullptr)
         {
-            GST_ERROR_OBJECT(self, "Failed to create or add ghost pad to bin.");
-            return;
+            gst_element_sync_state_with_parent(self->merge.get());
+            gst_element_sync_state_with_parent(self->udp_src_secondary.get());
         }
+        gst_element_sync_state_with_parent(self->udp_src.get());
 
         GstPad* plugin_pad = gst_element_get_static_pad(GST_ELEMENT(self), "src");
         if(plugin_pad == nullptr)
@@ -309,9 +367,12 @@ void construct_pipeline(GstNmosvideoreceiver* self)
 
         self->element_pad = plugin_pad;
 
-        if(gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), bin_ghost_pad) == false)
+        GstPad* chain_pad   = gst_element_get_static_pad(self->chain, "src");
+        const auto targeted = gst_ghost_pad_set_target(GST_GHOST_PAD(self->element_pad), chain_pad);
+        gst_object_unref(chain_pad);
+        if(targeted == false)
         {
-            GST_ERROR_OBJECT(self, "Failed to link plugin ghost pad to bin's ghost pad.");
+            GST_ERROR_OBJECT(self, "Failed to link plugin ghost pad to the receive chain.");
             return;
         }
 
@@ -323,30 +384,18 @@ void construct_pipeline(GstNmosvideoreceiver* self)
     }
 }
 
-// check_no_data_timeout:
-//     If the pipeline is not intentionally stopped (user_forced_stop == false)
-//     and there's been no data for X seconds, this function triggers a pipeline
-//     rebuild (called by a g_timeout_add_seconds(1, ...)). This is required so
-//     there isn't a reconfiguration period when data is received again,
-//     making it instantly turn the stream back on.
-static gboolean check_no_data_timeout(gpointer user_data)
+// After a silence the bin is flushed rather than rebuilt: the jitter buffer and depayloader drop the state of the
+// old stream, and the elements, their pools and the sockets stay ready for when the data comes back. Runs on the
+// watchdog thread, so it waits for an activation in progress to finish with the bin.
+static void restart_after_silence(GstNmosvideoreceiver* self)
 {
-    GstNmosvideoreceiver* self = (GstNmosvideoreceiver*)user_data;
-    gint64 now                 = g_get_monotonic_time();
-    if(self->user_forced_stop == true)
-    {
-        return G_SOURCE_CONTINUE;
-    }
-    if((now - self->last_buffer_time) > (6 * G_GINT64_CONSTANT(1000000)) && self->pipeline_clear == false)
-    {
-        fmt::print("Timeout detected. Restarting pipeline.\n");
-        self->pipeline_clear = true;
-        remove_old_bin(self);
-        gst_element_set_state(self->udp_src.get(), GST_STATE_PLAYING);
-        construct_pipeline(self);
-        gst_element_set_state(GST_ELEMENT(self), GST_STATE_PLAYING);
-    }
-    return true;
+    const std::lock_guard lock(*self->activation_mutex);
+    if(self->user_forced_stop || self->element_pad == nullptr) return;
+
+    GST_INFO_OBJECT(self, "No data for %u ms. Flushing pipeline.",
+                    static_cast<guint>(self->watchdog->timeout().count()));
+    gst_element_send_event(GST_ELEMENT(self), gst_event_new_flush_start());
+    gst_element_send_event(GST_ELEMENT(self), gst_event_new_flush_stop(false));
 }
 
 void create_nmos(GstNmosvideoreceiver* self)
@@ -377,6 +426,7 @@ void create_nmos(GstNmosvideoreceiver* self)
     self->client->add_receiver(
         self->config.device.id, create_receiver_config(self->config).dump(),
         [self](const std::optional<std::string>& sdp, bool master_enabled, const nlohmann::json& transport_params) {
+            const std::lock_guard lock(*self->activation_mutex);
             fmt::print("Receiver Activation Callback: SDP={}, Master Enabled={}\n",
                        sdp.has_value() ? sdp.value() : "None", master_enabled);
             nlohmann::json_abi_v3_11_3::basic_json<>::value_type param;
@@ -396,13 +446,22 @@ void create_nmos(GstNmosvideoreceiver* self)
                 {
                     fmt::print("Received SDP: {}\n", sdp.value());
                     auto sdp_settings = parse_sdp(sdp.value());
+                    if(sdp_settings.has_value())
+                    {
+                        sdp_settings = select_essence<bisect::nmoscpp::video_sender_info_t>(sdp_settings.value());
+                    }
                     if(sdp_settings.has_value() && sdp.value() != self->sdp_string)
                     {
-                        self->sdp_settings = sdp_settings.value();
-                        self->sdp_string   = sdp.value();
-                        remove_old_bin(self);
-                        construct_pipeline(self);
-                        gst_element_set_state(GST_ELEMENT(self), GST_STATE_PLAYING);
+                        // Only a new group, port or source: keep the bin and re-point its sources.
+                        const bool retargeted = retarget_sources(self, sdp_settings.value());
+                        self->sdp_settings    = sdp_settings.value();
+                        self->sdp_string      = sdp.value();
+                        if(!retargeted)
+                        {
+                            remove_old_bin(self);
+                            construct_pipeline(self);
+                            gst_element_set_state(GST_ELEMENT(self), GST_STATE_PLAYING);
+                        }
                     }
                 }
                 else if(!sdp && self->sdp_string != "")
@@ -416,6 +475,7 @@ void create_nmos(GstNmosvideoreceiver* self)
             else
             {
                 self->user_forced_stop = true;
+                if(self->watchdog) self->watchdog->disarm();
                 if(sdp)
                 {
                     fmt::print("Disabling master: SDP received but master is not enabled.\n");
@@ -439,6 +499,16 @@ static GstStateChangeReturn gst_nmosvideoreceiver_change_state(GstElement* eleme
     switch(transition)
     {
     case GST_STATE_CHANGE_NULL_TO_READY: {
+        // Built before the receiver is registered, so its first activation finds a chain ready.
+        if(self->chains == nullptr)
+        {
+            self->chains = std::make_unique<receive_chain_pool_t>();
+            // Pooled by depayloader: st2110vrawdepay for 4:2:2 10-bit, rtpvrawdepay for the other samplings.
+            for(const auto* depay : {bisect::rtp::st2110_20_depay_factory, "rtpvrawdepay"})
+            {
+                self->chains->add_format(depay, [depay]() { return receive_chain_pool_t::make_rtp_chain(depay); });
+            }
+        }
         if(self->nmos_active != true)
         {
             create_nmos(self);
@@ -492,6 +562,11 @@ static void gst_nmosvideoreceiver_class_init(GstNmosvideoreceiverClass* klass)
                  "BISECT OSSRF Video Receiver");
     add_property(object_class, 9, "destination-address", "Destination Address", "Address of the destination",
                  "127.0.0.1");
+    g_object_class_install_property(
+        object_class, static_cast<guint>(PropertyId::NoDataTimeout),
+        g_param_spec_uint("no-data-timeout", "No Data Timeout",
+                          "Milliseconds without a frame before the pipeline is flushed", 1, G_MAXUINT,
+                          default_no_data_timeout_ms, (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
     gst_element_class_set_static_metadata(element_class, "NMOS Video Receiver", "Source/Network",
                                           "Receives raw video from NMOS", "Luis Ferreira <luis.ferreira@bisect.pt>");
@@ -502,32 +577,37 @@ static void gst_nmosvideoreceiver_class_init(GstNmosvideoreceiverClass* klass)
 // Object initialization
 static void gst_nmosvideoreceiver_init(GstNmosvideoreceiver* self)
 {
-    self->last_buffer_time = g_get_monotonic_time();
-    self->pipeline_clear   = true;
     self->user_forced_stop = false;
     create_default_config_fields_video_receiver(&self->config);
 
-    g_timeout_add_seconds(1, (GSourceFunc)check_no_data_timeout, self);
+    self->activation_mutex = std::make_unique<std::mutex>();
+    self->watchdog         = no_data_watchdog_t::create(std::chrono::milliseconds(default_no_data_timeout_ms),
+                                                        [self]() { restart_after_silence(self); });
+    if(self->watchdog == nullptr)
+    {
+        GST_WARNING_OBJECT(self, "Failed to create the no-data watchdog.");
+    }
+
     GstPadTemplate* src_tmpl = gst_static_pad_template_get(&src_template);
     GstPad* ghost_src        = gst_ghost_pad_new_no_target_from_template("src", src_tmpl);
     gst_object_unref(src_tmpl);
+    gst_pad_add_probe(ghost_src, GST_PAD_PROBE_TYPE_BUFFER, frame_probe_cb, self, nullptr);
     gst_element_add_pad(GST_ELEMENT(self), ghost_src);
 
-    auto maybe_udpsrc = GstElementHandle<GstElement>::create_element("udpsrc", nullptr);
+    // Batched source: one recvmmsg per up to 64 packets, each stamped with its kernel receive time.
+    auto maybe_udpsrc = GstElementHandle<GstElement>::create_element(bisect::rtp::udp_batch_src_factory, nullptr);
     if(std::holds_alternative<std::nullptr_t>(maybe_udpsrc))
     {
         GST_ERROR_OBJECT(self, "Failed to create udpsrc elements.");
         return;
     }
     self->udp_src = std::move(std::get<GstElementHandle<GstElement>>(maybe_udpsrc));
-    GstPad* pad   = gst_element_get_static_pad(self->udp_src.get(), "src");
-    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_monitor_probe_cb, self, nullptr);
-    gst_object_unref(pad);
 }
 
 static gboolean plugin_init(GstPlugin* plugin)
 {
-    return gst_element_register(plugin, "nmosvideoreceiver", GST_RANK_NONE, GST_TYPE_NMOSVIDEORECEIVER);
+    return bisect::rtp::register_elements(plugin) &&
+           gst_element_register(plugin, "nmosvideoreceiver", GST_RANK_NONE, GST_TYPE_NMOSVIDEORECEIVER);
 }
 
 #define VERSION "1.0"
@@ -0,0 +1,137 @@
+#include "receive_chain_pool.hpp"
+
+receive_chain_pool_t::~receive_chain_pool_t()
+{
+    for(auto& [_, format] : formats_)
+    {
+        for(auto* chain : format.ready)
+        {
+            gst_element_set_state(chain, GST_STATE_NULL);
+            gst_object_unref(chain);
+        }
+    }
+}
+
+GstElement* receive_chain_pool_t::build(const factory_t& factory)
+{
+    auto* chain = factory();
+    if(chain == nullptr) return nullptr;
+
+    // Allocating the elements' resources now is what makes a later activation cheap.
+    gst_object_ref_sink(chain);
+    if(gst_element_set_state(chain, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE)
+    {
+        gst_element_set_state(chain, GST_STATE_NULL);
+        gst_object_unref(chain);
+        return nullptr;
+    }
+    return chain;
+}
+
+void receive_chain_pool_t::add_format(const std::string& format, factory_t factory)
+{
+    auto* chain = build(factory);
+
+    std::unique_lock lock(mutex_);
+    auto& f   = formats_[format];
+    f.factory = std::move(factory);
+    if(chain != nullptr) f.ready.push_back(chain);
+}
+
+GstElement* receive_chain_pool_t::acquire(const std::string& format)
+{
+    factory_t factory;
+    {
+        std::unique_lock lock(mutex_);
+        const auto it = formats_.find(format);
+        if(it == formats_.end()) return nullptr;
+
+        auto& f = it->second;
+        if(!f.ready.empty())
+        {
+            auto* chain = f.ready.back();
+            f.ready.pop_back();
+            return chain;
+        }
+        factory = f.factory;
+    }
+
+    // Only when the pool was built short or a chain is still in use elsewhere.
+    return build(factory);
+}
+
+void receive_chain_pool_t::release(const std::string& format, GstElement* chain)
+{
+    if(chain == nullptr) return;
+
+    // Back to READY drops the state of the stream the chain was receiving, but keeps its resources.
+    gst_element_set_state(chain, GST_STATE_READY);
+
+    std::unique_lock lock(mutex_);
+    const auto it = formats_.find(format);
+    if(it == formats_.end())
+    {
+        lock.unlock();
+        gst_element_set_state(chain, GST_STATE_NULL);
+        gst_object_unref(chain);
+        return;
+    }
+    it->second.ready.push_back(chain);
+}
+
+GstElement* receive_chain_pool_t::make_chain(std::vector<GstElement*> elements)
+{
+    for(auto* element : elements)
+    {
+        if(element != nullptr) continue;
+        for(auto* e : elements)
+        {
+            if(e != nullptr) gst_object_unref(e);
+        }
+        return nullptr;
+    }
+
+    auto* bin = gst_bin_new(nullptr);
+    for(auto* element : elements)
+    {
+        gst_bin_add(GST_BIN(bin), element);
+    }
+    for(size_t i = 1; i < elements.size(); ++i)
+    {
+        if(!gst_element_link(elements[i - 1], elements[i]))
+        {
+            gst_object_unref(bin);
+            return nullptr;
+        }
+    }
+
+    auto* sink = gst_element_get_static_pad(elements.front(), "sink");
+    auto* src  = gst_element_get_static_pad(elements.back(), "src");
+    const auto ghosted = gst_element_add_pad(bin, gst_ghost_pad_new("sink", sink)) &&
+                         gst_element_add_pad(bin, gst_ghost_pad_new("src", src));
+    gst_object_unref(sink);
+    gst_object_unref(src);
+    if(!ghosted)
+    {
+        gst_object_unref(bin);
+        return nullptr;
+    }
+    return bin;
+}
+
+GstElement* receive_chain_pool_t::make_rtp_chain(const char* depay_factory)
+{
+    auto* jitter = gst_element_factory_make("rtpjitterbuffer", nullptr);
+    auto* queue  = gst_element_factory_make("queue", nullptr);
+    auto* depay  = gst_element_factory_make(depay_factory, nullptr);
+    if(jitter != nullptr)
+    {
+        g_object_set(G_OBJECT(jitter), "do-lost", false, "do-retransmission", false, "mode", 0, "latency", 10,
+                     nullptr);
+    }
+    if(queue != nullptr)
+    {
+        g_object_set(G_OBJECT(queue), "max-size-buffers", 3, nullptr);
+    }
+    return make_chain({jitter, queue, depay});
+}
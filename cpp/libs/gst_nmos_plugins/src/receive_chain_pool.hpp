@@ -0,0 +1,51 @@
+#pragma once
+#include <gst/gst.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Receive chains (jitter buffer, queue and depayloader) built ahead of activation and kept in READY, by format, so
+// that an activation only links a chain to its sources and sets it playing.
+//
+// A chain is a bin with a "sink" ghost pad on its first element and a "src" ghost pad on its last one. A released
+// chain is reset to READY and handed out again, so each format is built once per receiver.
+class receive_chain_pool_t
+{
+  public:
+    // Builds one chain of a format, or returns nullptr.
+    using factory_t = std::function<GstElement*()>;
+
+    receive_chain_pool_t() = default;
+    ~receive_chain_pool_t();
+    receive_chain_pool_t(const receive_chain_pool_t&)            = delete;
+    receive_chain_pool_t& operator=(const receive_chain_pool_t&) = delete;
+
+    // Registers a format and builds its first chain.
+    void add_format(const std::string& format, factory_t factory);
+
+    // Returns a chain in READY, building one if none is left, or nullptr. The caller owns the returned reference.
+    GstElement* acquire(const std::string& format);
+
+    // Takes back a chain acquired for `format`, once it has been removed from its parent.
+    void release(const std::string& format, GstElement* chain);
+
+    // Puts `elements` in a new bin and links them in order. Returns nullptr if any is missing or they don't link.
+    static GstElement* make_chain(std::vector<GstElement*> elements);
+
+    // The chain of the receivers: a low-latency jitter buffer, a short queue and a `depay_factory` depayloader.
+    static GstElement* make_rtp_chain(const char* depay_factory);
+
+  private:
+    struct format_t
+    {
+        factory_t factory;
+        std::vector<GstElement*> ready;
+    };
+
+    static GstElement* build(const factory_t& factory);
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, format_t> formats_;
+};
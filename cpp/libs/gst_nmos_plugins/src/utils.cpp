@@ -48,6 +48,8 @@ void create_default_config_fields_sender(config_fields_t* config)
     config->network.interface_name      = "wlp1s0";
     config->network.destination_address = "192.168.1.120";
     config->network.destination_port    = 9999;
+    config->network.udp_batch_size      = 64;
+    config->network.udp_gso             = false;
 
     // Initialize config_fields_t
     config->id          = "1c920570-e0b4-4637-b02c-26c9d4275c71";
@@ -151,6 +153,8 @@ json create_receiver_config(config_fields_t& config)
 std::string translate_video_format(const std::string& gst_format)
 {
     static const std::unordered_map<std::string, std::string> video_format_map = {{"UYVP", "YCbCr-4:2:2"},
+                                                                                  {"v210", "YCbCr-4:2:2"},
+                                                                                  {"I422_10LE", "YCbCr-4:2:2"},
                                                                                   {"RGBA", "RGBA-8:8:8:8"}};
 
     auto it = video_format_map.find(gst_format);
@@ -188,17 +192,17 @@ std::string get_node_id(char* node_configuration_location)
 
     const json& configuration = configuration_result.value();
 
-    auto node_result = find<json>(configuration, "node");
+    auto node_result = find<json_ref>(configuration, "node");
 
     const json& node = node_result.value();
 
     auto node_id_result     = find<std::string>(node, "id");
-    auto node_config_result = find<json>(node, "configuration");
+    auto node_config_result = find<json_ref>(node, "configuration");
 
     if(node_id_result.has_value() && node_config_result.has_value())
     {
         const std::string node_id            = node_id_result.value();
-        const std::string node_configuration = node_config_result.value().dump();
+        const std::string node_configuration = node_config_result.value().get().dump();
 
         return node_id;
     }
@@ -214,17 +218,17 @@ std::string get_node_config(std::string node_configuration_location)
     {
         const json& configuration = configuration_result.value();
 
-        auto node_result = find<json>(configuration, "node");
+        auto node_result = find<json_ref>(configuration, "node");
 
         const json& node = node_result.value();
 
         auto node_id_result     = find<std::string>(node, "id");
-        auto node_config_result = find<json>(node, "configuration");
+        auto node_config_result = find<json_ref>(node, "configuration");
 
         if(node_id_result.has_value() && node_config_result.has_value())
         {
             const std::string node_id            = node_id_result.value();
-            const std::string node_configuration = node_config_result.value().dump();
+            const std::string node_configuration = node_config_result.value().get().dump();
 
             return node_configuration;
         }
@@ -238,7 +242,7 @@ std::string get_device_id(char* device_configuration_location)
 
     const json& configuration = configuration_result.value();
 
-    auto device_result = find<json>(configuration, "device");
+    auto device_result = find<json_ref>(configuration, "device");
 
     const json& device = device_result.value();
 
@@ -256,7 +260,7 @@ std::string get_device_config(char* device_configuration_location)
 
     const json& configuration = configuration_result.value();
 
-    auto device_result = find<json>(configuration, "device");
+    auto device_result = find<json_ref>(configuration, "device");
 
     const json& device = device_result.value();
 
@@ -0,0 +1,185 @@
+#include "watchdog.hpp"
+#include <glib-unix.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+
+namespace
+{
+    constexpr int64_t ns_per_second = 1'000'000'000;
+
+    // Read through the vDSO, without a system call.
+    int64_t monotonic_now_ns() noexcept
+    {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return int64_t{now.tv_sec} * ns_per_second + now.tv_nsec;
+    }
+
+    struct watchdog_thread_t
+    {
+        GMainContext* context;
+        GThread* thread;
+    };
+
+    gpointer run_watchdog_thread(gpointer user_data)
+    {
+        auto* context = static_cast<GMainContext*>(user_data);
+        g_main_context_push_thread_default(context);
+        g_main_loop_run(g_main_loop_new(context, FALSE));
+        return nullptr;
+    }
+
+    // The thread the timers of all the watchdogs are watched from. The pipelines run their own main contexts, and
+    // nothing guarantees the default one is iterated, so it iterates a context of its own. It is started with the first
+    // watchdog and runs for as long as the process.
+    const watchdog_thread_t& watchdog_thread()
+    {
+        static const watchdog_thread_t shared = [] {
+            auto* context = g_main_context_new();
+            return watchdog_thread_t{context, g_thread_new("no-data-watchdog", &run_watchdog_thread, context)};
+        }();
+        return shared;
+    }
+} // namespace
+
+struct no_data_watchdog_t::state_t
+{
+    state_t(int timer_fd, std::chrono::milliseconds timeout, on_timeout_t callback)
+        : fd(timer_fd), on_timeout(std::move(callback)),
+          timeout_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count())
+    {
+    }
+
+    ~state_t() { close(fd); }
+
+    // Requires mutex.
+    void arm_in(int64_t delay_ns) noexcept
+    {
+        frames_when_armed = frames.load(std::memory_order_relaxed);
+
+        // A zero delay would disarm the timer instead.
+        const auto delay = delay_ns > 0 ? delay_ns : 1;
+        itimerspec when{};
+        when.it_value.tv_sec  = delay / ns_per_second;
+        when.it_value.tv_nsec = delay % ns_per_second;
+        timerfd_settime(fd, 0, &when, nullptr);
+    }
+
+    static gboolean on_expired(gint fd, GIOCondition condition, gpointer user_data);
+
+    const int fd;
+    const on_timeout_t on_timeout;
+
+    // Serializes arming and disarming the timer. Frames take it only when they find the watchdog idle.
+    std::mutex mutex;
+    // Held while the timeout is raised, so that the destructor can wait for it.
+    std::mutex callback_mutex;
+    std::atomic<bool> stopped = false;
+
+    std::atomic<int64_t> timeout_ns;
+    std::atomic<int64_t> last_frame_ns = 0;
+    std::atomic<uint64_t> frames       = 0;
+    // Frames seen when the timer was last armed.
+    std::atomic<uint64_t> frames_when_armed = 0;
+    // No timer is armed; the next frame arms it. Written under mutex.
+    std::atomic<bool> idle = true;
+};
+
+std::unique_ptr<no_data_watchdog_t> no_data_watchdog_t::create(std::chrono::milliseconds timeout,
+                                                                on_timeout_t on_timeout)
+{
+    // Relative timeouts on the monotonic clock, which wall clock adjustments don't move.
+    const auto fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(fd < 0) return nullptr;
+
+    auto state = std::make_shared<state_t>(fd, timeout, std::move(on_timeout));
+
+    // The source keeps its own reference to the state, which GLib holds on to while the callback runs.
+    auto* source = g_unix_fd_source_new(fd, G_IO_IN);
+    g_source_set_callback(source, G_SOURCE_FUNC(&state_t::on_expired), new std::shared_ptr<state_t>(state),
+                          [](gpointer data) { delete static_cast<std::shared_ptr<state_t>*>(data); });
+    g_source_attach(source, watchdog_thread().context);
+    return std::unique_ptr<no_data_watchdog_t>(new no_data_watchdog_t(std::move(state), source));
+}
+
+no_data_watchdog_t::no_data_watchdog_t(std::shared_ptr<state_t> state, GSource* source)
+    : state_(std::move(state)), source_(source)
+{
+}
+
+no_data_watchdog_t::~no_data_watchdog_t()
+{
+    state_->stopped = true;
+    g_source_destroy(source_);
+    g_source_unref(source_);
+
+    // A timeout being raised on the watchdog thread is waited for. On that thread, the only one that can be running is
+    // the caller's own.
+    if(g_thread_self() != watchdog_thread().thread)
+    {
+        const std::lock_guard callback(state_->callback_mutex);
+    }
+}
+
+void no_data_watchdog_t::frame() noexcept
+{
+    auto& s = *state_;
+    s.last_frame_ns.store(monotonic_now_ns(), std::memory_order_relaxed);
+    s.frames.fetch_add(1, std::memory_order_relaxed);
+
+    if(!s.idle.load(std::memory_order_relaxed)) return;
+
+    // Arming and disarming are serialized: a disarm() racing with this frame either runs first and the frame arms the
+    // timer, or runs after and leaves the watchdog idle, with no timer, for the next frame to arm.
+    const std::lock_guard lock(s.mutex);
+    if(!s.idle) return;
+    s.idle = false;
+    s.arm_in(s.timeout_ns.load(std::memory_order_relaxed));
+}
+
+void no_data_watchdog_t::disarm() noexcept
+{
+    const std::lock_guard lock(state_->mutex);
+    const itimerspec off{};
+    timerfd_settime(state_->fd, 0, &off, nullptr);
+    state_->idle = true;
+}
+
+void no_data_watchdog_t::set_timeout(std::chrono::milliseconds timeout) noexcept
+{
+    state_->timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+}
+
+std::chrono::milliseconds no_data_watchdog_t::timeout() const noexcept
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(state_->timeout_ns.load()));
+}
+
+gboolean no_data_watchdog_t::state_t::on_expired(gint fd, GIOCondition, gpointer user_data)
+{
+    auto& self = **static_cast<std::shared_ptr<state_t>*>(user_data);
+
+    std::unique_lock lock(self.mutex);
+    uint64_t expirations;
+    if(read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || self.idle) return G_SOURCE_CONTINUE;
+
+    // Frames arrived since the timer was armed: move the deadline to `timeout` after the last one.
+    if(self.frames.load(std::memory_order_relaxed) != self.frames_when_armed)
+    {
+        const auto timeout = self.timeout_ns.load(std::memory_order_relaxed);
+        const auto silence = monotonic_now_ns() - self.last_frame_ns.load(std::memory_order_relaxed);
+        self.arm_in(silence < timeout ? timeout - silence : timeout);
+        return G_SOURCE_CONTINUE;
+    }
+
+    self.idle = true;
+    lock.unlock();
+
+    const std::lock_guard callback(self.callback_mutex);
+    if(!self.stopped && self.on_timeout) self.on_timeout();
+    return G_SOURCE_CONTINUE;
+}
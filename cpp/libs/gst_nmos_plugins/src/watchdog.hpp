@@ -0,0 +1,46 @@
+#pragma once
+#include <glib.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// Raises a callback when a receiver has delivered no frame for a while, without a polling timer.
+//
+// Each watchdog has a CLOCK_MONOTONIC timerfd, armed for `timeout` after the last frame. Frames only record their
+// arrival time; the timer is moved forward when it fires and finds newer frames, so a receiver that keeps delivering
+// costs one wakeup per timeout period and a stopped one costs none. The timers of all the watchdogs of the process are
+// watched from a single shared thread, so receivers don't each add a thread.
+class no_data_watchdog_t
+{
+  public:
+    // Called on the shared watchdog thread, which every watchdog raises its timeouts on. The watchdog stays quiet until
+    // the next frame arrives.
+    using on_timeout_t = std::function<void()>;
+
+    // Returns nullptr if the timer can't be created. The watchdog does not use the default main context, so it works in
+    // applications that never iterate it.
+    static std::unique_ptr<no_data_watchdog_t> create(std::chrono::milliseconds timeout, on_timeout_t on_timeout);
+
+    // Waits for a timeout this watchdog is raising to return, so it must not be called with a lock the callback takes.
+    ~no_data_watchdog_t();
+    no_data_watchdog_t(const no_data_watchdog_t&)            = delete;
+    no_data_watchdog_t& operator=(const no_data_watchdog_t&) = delete;
+
+    // Records a frame boundary. Safe to call from the streaming thread; no system call unless the watchdog had fired.
+    void frame() noexcept;
+
+    // Stops watching until the next frame, e.g. while the receiver is disabled on purpose.
+    void disarm() noexcept;
+
+    void set_timeout(std::chrono::milliseconds timeout) noexcept;
+    std::chrono::milliseconds timeout() const noexcept;
+
+  private:
+    // Shared with the timer's source, so that a timeout being raised while the watchdog is destroyed still finds it.
+    struct state_t;
+
+    no_data_watchdog_t(std::shared_ptr<state_t> state, GSource* source);
+
+    std::shared_ptr<state_t> state_;
+    GSource* source_;
+};
@@ -0,0 +1,144 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "watchdog.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Counts the timeouts raised on the watchdog thread. Nothing in these tests iterates the default main context.
+    struct timeouts_t
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        int count = 0;
+
+        void raise()
+        {
+            const std::lock_guard lock(mutex);
+            ++count;
+            changed.notify_all();
+        }
+
+        // Waits for more than `seen` timeouts. The limit only stops a broken watchdog from hanging the test.
+        bool wait_for_more_than(int seen)
+        {
+            std::unique_lock lock(mutex);
+            return changed.wait_for(lock, 10s, [&] { return count > seen; });
+        }
+
+        int current()
+        {
+            const std::lock_guard lock(mutex);
+            return count;
+        }
+    };
+
+    size_t process_thread_count()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.starts_with("Threads:")) return std::stoul(line.substr(8));
+        }
+        return 0;
+    }
+} // namespace
+
+TEST(gst_nmos_plugins, watchdog_fires_after_silence)
+{
+    timeouts_t timeouts;
+    const auto watchdog = no_data_watchdog_t::create(20ms, [&] { timeouts.raise(); });
+    ASSERT_NE(watchdog, nullptr);
+
+    watchdog->frame();
+    ASSERT_TRUE(timeouts.wait_for_more_than(0));
+
+    // Quiet until the next frame, then armed again.
+    watchdog->frame();
+    ASSERT_TRUE(timeouts.wait_for_more_than(1));
+}
+
+TEST(gst_nmos_plugins, watchdog_disarm_racing_a_frame_leaves_it_usable)
+{
+    timeouts_t timeouts;
+    const auto watchdog = no_data_watchdog_t::create(5ms, [&] { timeouts.raise(); });
+    ASSERT_NE(watchdog, nullptr);
+
+    for(auto i = 0; i < 200; ++i)
+    {
+        // Start armed, so that the disarm can leave the watchdog idle just before the racing frame arms it again.
+        watchdog->frame();
+        const auto seen = timeouts.current();
+
+        std::thread disarming([&] { watchdog->disarm(); });
+        std::this_thread::yield();
+        watchdog->frame();
+        disarming.join();
+
+        // Whichever way the race went, the watchdog is either armed or idle, and a frame after it raises a timeout.
+        watchdog->frame();
+        ASSERT_TRUE(timeouts.wait_for_more_than(seen)) << "iteration " << i;
+    }
+}
+
+TEST(gst_nmos_plugins, watchdogs_share_one_thread)
+{
+    const auto threads_before = process_thread_count();
+
+    timeouts_t timeouts;
+    std::vector<std::unique_ptr<no_data_watchdog_t>> watchdogs;
+    for(auto i = 0; i < 100; ++i)
+    {
+        watchdogs.push_back(no_data_watchdog_t::create(20ms, [&] { timeouts.raise(); }));
+        ASSERT_NE(watchdogs.back(), nullptr);
+        watchdogs.back()->frame();
+    }
+
+    // At most the shared thread is new, if no watchdog was created before.
+    ASSERT_LE(process_thread_count(), threads_before + 1);
+    ASSERT_TRUE(timeouts.wait_for_more_than(99));
+}
+
+TEST(gst_nmos_plugins, watchdog_destruction_waits_for_a_timeout_being_raised)
+{
+    std::atomic<bool> raising  = false;
+    std::atomic<bool> returned = false;
+
+    auto watchdog = no_data_watchdog_t::create(5ms, [&] {
+        raising = true;
+        std::this_thread::sleep_for(50ms);
+        returned = true;
+    });
+    ASSERT_NE(watchdog, nullptr);
+
+    watchdog->frame();
+    while(!raising)
+    {
+        std::this_thread::yield();
+    }
+    watchdog.reset();
+    ASSERT_TRUE(returned);
+}
@@ -19,12 +19,21 @@
 
 namespace ossrf::gst::receiver
 {
+    struct udp_batching_t
+    {
+        uint32_t batch_size = 64;
+        // Kernel receive buffer in octets. 0 keeps the system default.
+        int buffer_size = 0;
+    };
+
     struct network_settings_t
     {
         std::string interface_name;
         std::string interface_address;
         std::string source_ip_address;
         uint16_t source_port;
+        // When set, packets are read in recvmmsg batches instead of one syscall each.
+        std::optional<udp_batching_t> batching;
     };
 
     struct video_info_t
@@ -44,10 +53,20 @@ namespace ossrf::gst::receiver
 
     using format_t = std::variant<video_info_t, audio_info_t>;
 
+    // Frames are handed to the application, through gst_receiver_plugin_t, instead of being played out.
+    struct app_sink_settings_t
+    {
+        // Frames kept for pull_frame before the oldest is dropped, or, with drop disabled, before the pipeline
+        // blocks.
+        uint32_t max_frames_queued = 4;
+        bool drop                  = true;
+    };
+
     struct receiver_settings
     {
         format_t format;
         network_settings_t primary;
         std::optional<network_settings_t> secondary;
+        std::optional<app_sink_settings_t> app_sink;
     };
 } // namespace ossrf::gst::receiver
\ No newline at end of file
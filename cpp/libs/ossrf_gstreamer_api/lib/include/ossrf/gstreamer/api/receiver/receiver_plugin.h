@@ -15,19 +15,62 @@
 #pragma once
 
 #include "bisect/expected.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 
 namespace ossrf::gst::plugins
 {
     class gst_receiver_plugin_t;
     using gst_receiver_plugin_uptr = std::unique_ptr<gst_receiver_plugin_t>;
 
+    // A received frame, mapped read-only in the pipeline's own buffer: nothing is converted or copied. The buffer
+    // goes back to the pipeline when the frame is destroyed.
+    class received_frame_t
+    {
+      public:
+        struct impl;
+
+        explicit received_frame_t(std::unique_ptr<impl> i) noexcept;
+        ~received_frame_t();
+        received_frame_t(received_frame_t&& other) noexcept;
+        received_frame_t& operator=(received_frame_t&& rhs) noexcept;
+
+        // Video frames are UYVP, audio frames interleaved S24BE samples.
+        const uint8_t* data() const noexcept;
+        size_t size() const noexcept;
+
+        // False when packets of the frame were lost and some lines were not received.
+        bool is_complete() const noexcept;
+
+        // RTP timestamp of the frame. Only ST 2110-20 video frames carry it.
+        std::optional<uint32_t> rtp_timestamp() const noexcept;
+
+        // Kernel receive time of the first packet of the frame, in nanoseconds since the Unix epoch. Only set when
+        // receiving with "batching".
+        std::optional<uint64_t> arrival_time() const noexcept;
+
+      private:
+        std::unique_ptr<impl> impl_;
+    };
+
     class gst_receiver_plugin_t
     {
       public:
         virtual ~gst_receiver_plugin_t() = default;
 
         virtual void stop() = 0;
+
+        // Receivers configured with an "app_sink" hand their frames to the application, either to `callback` as
+        // they arrive, from a GStreamer thread, or through pull_frame when no callback is set.
+        virtual void on_frame(std::function<void(received_frame_t)> callback) noexcept = 0;
+
+        // Waits up to `timeout` for the next frame. Returns no frame on timeout or end of stream, and fails for
+        // receivers without an app sink.
+        virtual bisect::expected<std::optional<received_frame_t>>
+        pull_frame(std::chrono::nanoseconds timeout) noexcept = 0;
     };
 
     bisect::expected<gst_receiver_plugin_uptr> create_gst_receiver_plugin(const std::string& config,
@@ -20,12 +20,20 @@
 namespace ossrf::gst::sender
 {
 
+    struct udp_batching_t
+    {
+        uint32_t batch_size = 64;
+        bool gso            = false;
+    };
+
     struct network_settings_t
     {
         std::optional<std::string> source_ip_address;
         std::string interface_name;
         std::string destination_ip_address;
         uint16_t destination_port;
+        // When set, packets are sent in sendmmsg batches instead of one syscall each.
+        std::optional<udp_batching_t> batching;
     };
 
     enum class frame_structure_t
@@ -36,6 +44,15 @@ namespace ossrf::gst::sender
         psf,
     };
 
+    // ST 2110-21 sender type to pace video as.
+    enum class pacing_t
+    {
+        none,
+        narrow,
+        narrow_linear,
+        wide,
+    };
+
     struct frame_rate_t
     {
         uint32_t num;
@@ -49,6 +66,7 @@ namespace ossrf::gst::sender
         frame_rate_t exact_framerate;
         std::string chroma_sub_sampling;
         frame_structure_t structure;
+        pacing_t pacing = pacing_t::none;
     };
 
     struct audio_info_t
@@ -61,11 +79,19 @@ namespace ossrf::gst::sender
 
     using format_t = std::variant<video_info_t, audio_info_t>;
 
+    // Frames are pushed by the application, through gst_sender_plugin_t::push_frame, instead of a test source.
+    struct app_source_settings_t
+    {
+        // Frames that may be pushed and not yet released before push_frame reports a full window.
+        uint32_t max_frames_in_flight = 4;
+    };
+
     struct sender_settings
     {
         format_t format;
         network_settings_t primary;
         std::optional<network_settings_t> secondary;
+        std::optional<app_source_settings_t> app_source;
     };
 
 } // namespace ossrf::gst::sender
\ No newline at end of file
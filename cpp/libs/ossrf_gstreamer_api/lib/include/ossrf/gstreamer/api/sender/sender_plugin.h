@@ -15,19 +15,50 @@
 #pragma once
 
 #include "bisect/expected.h"
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 
 namespace ossrf::gst::plugins
 {
     class gst_sender_plugin_t;
     using gst_sender_plugin_uptr = std::unique_ptr<gst_sender_plugin_t>;
 
+    // A frame of application memory, sent without copying. The memory must stay valid and unchanged until `release`
+    // is called, which happens once the pipeline has sent the frame, from a GStreamer thread.
+    struct frame_t
+    {
+        const void* data = nullptr;
+        size_t size      = 0;
+        // Presentation time in nanoseconds on the pipeline clock. When not set, the frame is stamped on arrival.
+        std::optional<uint64_t> pts;
+        std::function<void()> release;
+    };
+
+    enum class push_result_t
+    {
+        pushed,
+        // The in-flight window is full: the frame was not taken and `release` will not be called for it.
+        window_full,
+    };
+
     class gst_sender_plugin_t
     {
       public:
         virtual ~gst_sender_plugin_t() = default;
 
         virtual void stop() = 0;
+
+        // Pushes a frame into a sender configured with an "app_source". Fails for senders that produce a test
+        // pattern, or when the frame does not match the configured format.
+        virtual bisect::expected<push_result_t> push_frame(frame_t frame) noexcept = 0;
+
+        // Frames pushed and not yet released.
+        virtual size_t frames_in_flight() const noexcept = 0;
+
+        // Called, from a GStreamer thread, whenever a full in-flight window gets room for another frame.
+        virtual void on_window_available(std::function<void()> callback) noexcept = 0;
     };
 
     bisect::expected<gst_sender_plugin_uptr> create_gst_sender_plugin(const std::string& config, int pattern) noexcept;
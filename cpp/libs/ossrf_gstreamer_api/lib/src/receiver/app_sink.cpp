@@ -0,0 +1,192 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "app_sink.h"
+#include "bisect/expected/macros.h"
+#include "bisect/rtp/elements.h"
+#include <gst/app/gstappsink.h>
+#include <mutex>
+
+using namespace bisect;
+using namespace ossrf::gst::receiver;
+using namespace ossrf::gst::plugins;
+
+struct received_frame_t::impl
+{
+    impl(GstBuffer* b, const GstMapInfo& m) : buffer(b), map(m) {}
+
+    ~impl()
+    {
+        gst_buffer_unmap(buffer, &map);
+        gst_buffer_unref(buffer);
+    }
+
+    GstBuffer* buffer;
+    GstMapInfo map;
+    std::optional<uint32_t> rtp_timestamp;
+    std::optional<uint64_t> arrival_time;
+};
+
+received_frame_t::received_frame_t(std::unique_ptr<impl> i) noexcept : impl_(std::move(i))
+{
+}
+
+received_frame_t::~received_frame_t()                                          = default;
+received_frame_t::received_frame_t(received_frame_t&& other) noexcept          = default;
+received_frame_t& received_frame_t::operator=(received_frame_t&& rhs) noexcept = default;
+
+const uint8_t* received_frame_t::data() const noexcept
+{
+    return impl_->map.data;
+}
+
+size_t received_frame_t::size() const noexcept
+{
+    return impl_->map.size;
+}
+
+bool received_frame_t::is_complete() const noexcept
+{
+    return !GST_BUFFER_FLAG_IS_SET(impl_->buffer, GST_BUFFER_FLAG_CORRUPTED);
+}
+
+std::optional<uint32_t> received_frame_t::rtp_timestamp() const noexcept
+{
+    return impl_->rtp_timestamp;
+}
+
+std::optional<uint64_t> received_frame_t::arrival_time() const noexcept
+{
+    return impl_->arrival_time;
+}
+
+using frame_callback_t = std::function<void(received_frame_t)>;
+
+struct app_sink_t::state_t
+{
+    std::mutex mutex;
+    std::shared_ptr<const frame_callback_t> on_frame;
+};
+
+namespace
+{
+    // References to look metas up by: a meta matches when its caps are a subset of these.
+    GstCaps* rtp_timestamp_reference()
+    {
+        static GstCaps* const caps = gst_caps_new_empty_simple(bisect::rtp::rtp_timestamp_caps);
+        return caps;
+    }
+
+    GstCaps* arrival_reference()
+    {
+        static GstCaps* const caps = gst_caps_new_empty_simple(bisect::rtp::arrival_timestamp_caps);
+        return caps;
+    }
+
+    std::optional<GstClockTime> find_reference_timestamp(GstBuffer* buffer, GstCaps* reference)
+    {
+        const auto* meta = gst_buffer_get_reference_timestamp_meta(buffer, reference);
+        if(meta == nullptr) return std::nullopt;
+        return meta->timestamp;
+    }
+
+    // Maps the sample's buffer and keeps a reference to it; the sample itself can be released.
+    std::optional<received_frame_t> make_frame(GstSample* sample)
+    {
+        auto* buffer = gst_sample_get_buffer(sample);
+        if(buffer == nullptr) return std::nullopt;
+
+        GstMapInfo map;
+        if(!gst_buffer_map(buffer, &map, GST_MAP_READ)) return std::nullopt;
+        auto i = std::make_unique<received_frame_t::impl>(gst_buffer_ref(buffer), map);
+
+        if(const auto rtp = find_reference_timestamp(buffer, rtp_timestamp_reference()); rtp.has_value())
+        {
+            i->rtp_timestamp = static_cast<uint32_t>(*rtp);
+        }
+        i->arrival_time = find_reference_timestamp(buffer, arrival_reference());
+
+        return received_frame_t(std::move(i));
+    }
+
+    GstFlowReturn on_new_sample(GstAppSink* sink, gpointer data)
+    {
+        auto& state = *static_cast<std::shared_ptr<app_sink_t::state_t>*>(data);
+
+        std::shared_ptr<const frame_callback_t> callback;
+        {
+            std::unique_lock lock(state->mutex);
+            callback = state->on_frame;
+        }
+        // Without a callback the sample stays queued for pull.
+        if(callback == nullptr) return GST_FLOW_OK;
+
+        auto* sample = gst_app_sink_pull_sample(sink);
+        if(sample == nullptr) return GST_FLOW_OK;
+        auto frame = make_frame(sample);
+        gst_sample_unref(sample);
+
+        if(frame.has_value()) (*callback)(std::move(*frame));
+        return GST_FLOW_OK;
+    }
+
+    void delete_state(gpointer data)
+    {
+        delete static_cast<std::shared_ptr<app_sink_t::state_t>*>(data);
+    }
+} // namespace
+
+expected<app_sink_t> app_sink_t::create(GstBin* bin, const app_sink_settings_t& settings) noexcept
+{
+    BST_ENFORCE(settings.max_frames_queued > 0, "max_frames_queued must be greater than 0");
+
+    auto* element = gst_element_factory_make("appsink", NULL);
+    BST_ENFORCE(element != nullptr, "Failed creating GStreamer element appsink");
+    // Frames are handed over as soon as they are complete, not held back until their presentation time.
+    g_object_set(G_OBJECT(element), "sync", FALSE, "emit-signals", FALSE, "max-buffers", settings.max_frames_queued,
+                 "drop", settings.drop ? TRUE : FALSE, NULL);
+    BST_ENFORCE(gst_bin_add(bin, element), "Failed adding appsink to the pipeline");
+
+    auto state = std::make_shared<state_t>();
+
+    GstAppSinkCallbacks callbacks{};
+    callbacks.new_sample = &on_new_sample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(element), &callbacks, new std::shared_ptr<state_t>(state), &delete_state);
+
+    return app_sink_t(element, std::move(state));
+}
+
+app_sink_t::app_sink_t(GstElement* element, std::shared_ptr<state_t> state)
+    : element_(element), state_(std::move(state))
+{
+}
+
+void app_sink_t::on_frame(std::function<void(received_frame_t)> callback) noexcept
+{
+    auto f = callback ? std::make_shared<const frame_callback_t>(std::move(callback)) : nullptr;
+
+    std::unique_lock lock(state_->mutex);
+    state_->on_frame = std::move(f);
+}
+
+expected<std::optional<received_frame_t>> app_sink_t::pull(std::chrono::nanoseconds timeout) noexcept
+{
+    auto* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(element_), static_cast<GstClockTime>(timeout.count()));
+    if(sample == nullptr) return std::optional<received_frame_t>{};
+
+    auto frame = make_frame(sample);
+    gst_sample_unref(sample);
+    BST_ENFORCE(frame.has_value(), "Failed mapping received frame");
+    return frame;
+}
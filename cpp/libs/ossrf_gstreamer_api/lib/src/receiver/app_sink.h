@@ -0,0 +1,49 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "bisect/expected.h"
+#include "ossrf/gstreamer/api/receiver/receiver_configuration.h"
+#include "ossrf/gstreamer/api/receiver/receiver_plugin.h"
+#include <gst/gst.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace ossrf::gst::plugins
+{
+    // An appsink handing the depayloaded buffers to the application as mapped frames, without converting them.
+    class app_sink_t
+    {
+      public:
+        struct state_t;
+
+        // Adds an appsink to `bin`.
+        static bisect::expected<app_sink_t> create(GstBin* bin,
+                                                   const ossrf::gst::receiver::app_sink_settings_t& settings) noexcept;
+
+        GstElement* element() const noexcept { return element_; }
+
+        void on_frame(std::function<void(received_frame_t)> callback) noexcept;
+        bisect::expected<std::optional<received_frame_t>> pull(std::chrono::nanoseconds timeout) noexcept;
+
+      private:
+        app_sink_t(GstElement* element, std::shared_ptr<state_t> state);
+
+        GstElement* element_;
+        // Shared with the streaming thread's callbacks, which may outlive this object until the pipeline is stopped.
+        std::shared_ptr<state_t> state_;
+    };
+} // namespace ossrf::gst::plugins
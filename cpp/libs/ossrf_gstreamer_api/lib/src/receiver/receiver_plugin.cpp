@@ -32,16 +32,49 @@ using json = nlohmann::json;
 
 namespace
 {
-    expected<network_settings_t> network_from_json(const json& config)
+    expected<udp_batching_t> batching_from_json(const json& config)
+    {
+        udp_batching_t batching;
+        BST_CHECK_ASSIGN(batching.batch_size, find_or<uint32_t>(config, "batch_size", uint32_t{batching.batch_size}));
+        BST_CHECK_ASSIGN(batching.buffer_size, find_or<int>(config, "buffer_size", 0));
+        BST_ENFORCE(batching.batch_size > 0, "batch_size must be greater than 0");
+        BST_ENFORCE(batching.buffer_size >= 0, "buffer_size must not be negative");
+        return batching;
+    }
+
+    expected<network_settings_t> network_leg_from_json(const json& leg, const network_leg_t& sdp_leg)
     {
         network_settings_t net;
-        BST_ASSIGN(primary, find<json>(config, "primary"));
-        assign_if<std::string>(primary, "interface_name", net, &network_settings_t::interface_name);
-        assign_if<std::string>(primary, "interface_address", net, &network_settings_t::interface_address);
+        assign_if<std::string>(leg, "interface_name", net, &network_settings_t::interface_name);
+        assign_if<std::string>(leg, "interface_address", net, &network_settings_t::interface_address);
+
+        if(const auto it = leg.find("batching"); it != leg.end())
+        {
+            BST_CHECK_ASSIGN(net.batching, batching_from_json(*it));
+        }
+
+        if(sdp_leg.destination_ip.has_value())
+        {
+            net.source_ip_address = sdp_leg.destination_ip.value();
+        }
+        if(sdp_leg.destination_port.has_value())
+        {
+            net.source_port = static_cast<uint16_t>(sdp_leg.destination_port.value());
+        }
 
         return net;
     }
 
+    expected<app_sink_settings_t> app_sink_from_json(const json& config)
+    {
+        app_sink_settings_t app_sink;
+        BST_CHECK_ASSIGN(app_sink.max_frames_queued,
+                         find_or<uint32_t>(config, "max_frames_queued", uint32_t{app_sink.max_frames_queued}));
+        BST_CHECK_ASSIGN(app_sink.drop, find_or<bool>(config, "drop", app_sink.drop));
+        BST_ENFORCE(app_sink.max_frames_queued > 0, "max_frames_queued must be greater than 0");
+        return app_sink;
+    }
+
     video_info_t translate_sdp_video_settings(const video_sender_info_t video_settings)
     {
         video_info_t info;
@@ -63,23 +96,40 @@ namespace
 
     expected<receiver_settings> translate_json(const json& config, sdp_settings_t sdp_settings)
     {
-        receiver_settings s;
-        BST_ASSIGN(network, find<json>(config, "network"));
-        BST_CHECK_ASSIGN(s.primary, network_from_json(network));
-        if(sdp_settings.primary.destination_ip.has_value())
+        BST_ASSIGN(capabilities, find<json_ref>(config, "capabilities"));
+        BST_ENFORCE(capabilities.get().is_array(), "capabilities is not an array");
+
+        // TODO: Only checking the first position but should receive more capabilities in the future
+        const auto& c = capabilities.get()[0];
+
+        // The receiver takes the first essence of the session in its format.
+        if(c == "video/raw")
         {
-            s.primary.source_ip_address = sdp_settings.primary.destination_ip.value();
+            BST_CHECK_ASSIGN(sdp_settings, select_essence<video_sender_info_t>(std::move(sdp_settings)));
         }
-        if(sdp_settings.primary.destination_port.has_value())
+        else if(c == "audio/L24")
         {
-            s.primary.source_port = static_cast<uint16_t>(sdp_settings.primary.destination_port.value());
+            BST_CHECK_ASSIGN(sdp_settings, select_essence<audio_sender_info_t>(std::move(sdp_settings)));
         }
 
-        BST_ASSIGN(capabilities, find<json>(config, "capabilities"));
-        BST_ENFORCE(capabilities.is_array(), "capabilities is not an array");
+        receiver_settings s;
+        BST_ASSIGN(network, find<json_ref>(config, "network"));
+        BST_ASSIGN(primary, find<json_ref>(network, "primary"));
+        BST_CHECK_ASSIGN(s.primary, network_leg_from_json(primary, sdp_settings.primary));
+
+        // SMPTE 2022-7: listen on the secondary leg when the SDP has one, on its own interface if configured.
+        if(sdp_settings.secondary.has_value())
+        {
+            const auto secondary      = network.get().find("secondary");
+            const json& secondary_leg = secondary != network.get().end() ? *secondary : primary.get();
+            BST_CHECK_ASSIGN(s.secondary, network_leg_from_json(secondary_leg, sdp_settings.secondary.value()));
+        }
 
-        // TODO: Only checking the first position but should receive more capabilities in the future
-        const auto c = capabilities[0];
+        // Frames go to the application instead of being played out.
+        if(const auto app_sink = config.find("app_sink"); app_sink != config.end())
+        {
+            BST_CHECK_ASSIGN(s.app_sink, app_sink_from_json(*app_sink));
+        }
 
         if(c == "video/raw" && std::holds_alternative<video_sender_info_t>(sdp_settings.format))
         {
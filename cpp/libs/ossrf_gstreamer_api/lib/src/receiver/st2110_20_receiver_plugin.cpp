@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "st2110_20_receiver_plugin.h"
+#include "udp_source.h"
+#include "app_sink.h"
 #include "bisect/expected/macros.h"
 #include "bisect/pipeline.h"
+#include "bisect/rtp/elements.h"
 #include <gst/gst.h>
 #include "fmt/format.h"
 
@@ -34,6 +37,7 @@ struct gst_st2110_20_receiver_impl : gst_receiver_plugin_t
     receiver_settings s_;
     video_info_t f_;
     gst::pipeline pipeline_;
+    std::optional<app_sink_t> app_sink_;
 
     gst_st2110_20_receiver_impl(receiver_settings settings, video_info_t format) : s_(settings), f_(format) {}
 
@@ -45,24 +49,16 @@ struct gst_st2110_20_receiver_impl : gst_receiver_plugin_t
         BST_CHECK_ASSIGN(pipeline_, bisect::gst::pipeline::create(NULL));
         auto* pipeline = pipeline_.get();
 
-        // Add pipeline udp source
-        auto* source = gst_element_factory_make("udpsrc", NULL);
-        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element udpsrc");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), source), "Failed adding udpsrc to the pipeline");
-
-        // Set udp source params
-        g_object_set(G_OBJECT(source), "address", s_.primary.source_ip_address.c_str(), NULL);
-        g_object_set(G_OBJECT(source), "auto-multicast", TRUE, NULL);
-        g_object_set(G_OBJECT(source), "port", s_.primary.source_port, NULL);
-        g_object_set(G_OBJECT(source), "multicast-iface", s_.primary.interface_name.c_str(), NULL);
-
-        // Create and set caps for udp source
+        // Create caps for udp source
         GstCaps* caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "video", "clock-rate",
                                             G_TYPE_INT, 90000, "encoding-name", G_TYPE_STRING, "RAW", "width",
                                             G_TYPE_STRING, std::to_string(f_.width).c_str(), "height", G_TYPE_STRING,
                                             std::to_string(f_.height).c_str(), "sampling", G_TYPE_STRING,
                                             f_.chroma_sub_sampling.c_str(), "depth", G_TYPE_STRING, "10", NULL);
-        g_object_set(G_OBJECT(source), "caps", caps, NULL);
+
+        // Add pipeline udp source, one per network leg
+        BST_ASSIGN(source, add_udp_sources(GST_BIN(pipeline), s_, caps));
+        gst_caps_unref(caps);
 
         // Add pipeline rtpjitterbuffer
         auto* jitter_buffer = gst_element_factory_make("rtpjitterbuffer", NULL);
@@ -76,9 +72,11 @@ struct gst_st2110_20_receiver_impl : gst_receiver_plugin_t
         g_object_set(G_OBJECT(queue1), "max-size-time", queue_max_size_time, "max-size-buffers", queue_max_size_buffers,
                      "max-size-bytes", queue_max_size_bytes, NULL);
 
-        // Add pipeline rtp depay
-        auto* depay = gst_element_factory_make("rtpvrawdepay", NULL);
-        BST_ENFORCE(depay != nullptr, "Failed creating GStreamer element depay");
+        // Add pipeline ST 2110-20 depayloader, or rtpvrawdepay for the samplings it doesn't reassemble
+        BST_ENFORCE(bisect::rtp::register_elements(), "Failed registering the ST 2110-20 elements");
+        const auto* depay_factory = bisect::rtp::raw_video_depay_factory(f_.chroma_sub_sampling, 10);
+        auto* depay               = gst_element_factory_make(depay_factory, NULL);
+        BST_ENFORCE(depay != nullptr, "Failed creating GStreamer element {}", depay_factory);
         BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), depay), "Failed adding depay to the pipeline");
 
         // Add pipeline queue2
@@ -88,23 +86,40 @@ struct gst_st2110_20_receiver_impl : gst_receiver_plugin_t
         g_object_set(G_OBJECT(queue2), "max-size-time", queue_max_size_time, "max-size-buffers", queue_max_size_buffers,
                      "max-size-bytes", queue_max_size_bytes, NULL);
 
+        // Link all elements together
+        BST_ENFORCE(gst_element_link_many(source, jitter_buffer, queue1, depay, queue2, NULL),
+                    "Failed linking GStreamer video pipeline");
+
+        // Add pipeline sink: appsink handing the depayloaded frames over as they are, or a display
+        BST_CHECK(add_sink(GST_BIN(pipeline), queue2));
+
+        // Setup runner
+        pipeline_.run_loop();
+
+        return {};
+    }
+
+    maybe_ok add_sink(GstBin* bin, GstElement* upstream)
+    {
+        if(s_.app_sink.has_value())
+        {
+            BST_CHECK_ASSIGN(app_sink_, app_sink_t::create(bin, *s_.app_sink));
+            BST_ENFORCE(gst_element_link(upstream, app_sink_->element()), "Failed linking GStreamer video pipeline");
+            return {};
+        }
+
         // Add pipeline videoconvert
         auto* videoconvert = gst_element_factory_make("videoconvert", NULL);
         BST_ENFORCE(videoconvert != nullptr, "Failed creating GStreamer element converter");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), videoconvert), "Failed adding converter to the pipeline");
+        BST_ENFORCE(gst_bin_add(bin, videoconvert), "Failed adding converter to the pipeline");
 
         // Add pipeline video sink
         auto* sink = gst_element_factory_make("autovideosink", NULL);
         BST_ENFORCE(sink != nullptr, "Failed creating GStreamer element sink");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), sink), "Failed adding sink to the pipeline");
+        BST_ENFORCE(gst_bin_add(bin, sink), "Failed adding sink to the pipeline");
 
-        // Link all elements together
-        BST_ENFORCE(gst_element_link_many(source, jitter_buffer, queue1, depay, queue2, videoconvert, sink, NULL),
+        BST_ENFORCE(gst_element_link_many(upstream, videoconvert, sink, NULL),
                     "Failed linking GStreamer video pipeline");
-
-        // Setup runner
-        pipeline_.run_loop();
-
         return {};
     }
 
@@ -112,6 +127,18 @@ struct gst_st2110_20_receiver_impl : gst_receiver_plugin_t
     {
         pipeline_.stop();
         pipeline_ = {};
+        app_sink_.reset();
+    }
+
+    void on_frame(std::function<void(received_frame_t)> callback) noexcept override
+    {
+        if(app_sink_) app_sink_->on_frame(std::move(callback));
+    }
+
+    expected<std::optional<received_frame_t>> pull_frame(std::chrono::nanoseconds timeout) noexcept override
+    {
+        BST_ENFORCE(app_sink_.has_value(), "This receiver has no app sink");
+        return app_sink_->pull(timeout);
     }
 };
 
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "st2110_30_receiver_plugin.h"
+#include "udp_source.h"
+#include "app_sink.h"
 #include "bisect/expected/macros.h"
 #include "bisect/pipeline.h"
 #include <gst/gst.h>
@@ -33,6 +35,7 @@ struct gst_st2110_30_receiver_impl : gst_receiver_plugin_t
     receiver_settings s_;
     audio_info_t f_;
     gst::pipeline pipeline_;
+    std::optional<app_sink_t> app_sink_;
 
     gst_st2110_30_receiver_impl(receiver_settings settings, audio_info_t format) : s_(settings), f_(format) {}
 
@@ -44,22 +47,14 @@ struct gst_st2110_30_receiver_impl : gst_receiver_plugin_t
         BST_CHECK_ASSIGN(pipeline_, bisect::gst::pipeline::create(NULL));
         auto* pipeline = pipeline_.get();
 
-        // Add pipeline udp source
-        auto* source = gst_element_factory_make("udpsrc", NULL);
-        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element udpsrc");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), source), "Failed adding udpsrc to the pipeline");
-
-        // Set udp source params
-        g_object_set(G_OBJECT(source), "address", s_.primary.source_ip_address.c_str(), NULL);
-        g_object_set(G_OBJECT(source), "auto-multicast", TRUE, NULL);
-        g_object_set(G_OBJECT(source), "port", s_.primary.source_port, NULL);
-        g_object_set(G_OBJECT(source), "multicast-iface", s_.primary.interface_name.c_str(), NULL);
-
-        // Create and set caps for udp source
+        // Create caps for udp source
         constexpr auto t = R"(application/x-rtp, clock-rate={rate}, channels={channels})";
         GstCaps* caps    = gst_caps_from_string(
             fmt::format(t, fmt::arg("rate", f_.sampling_rate), fmt::arg("channels", f_.number_of_channels)).c_str());
-        g_object_set(G_OBJECT(source), "caps", caps, NULL);
+
+        // Add pipeline udp source, one per network leg
+        BST_ASSIGN(source, add_udp_sources(GST_BIN(pipeline), s_, caps));
+        gst_caps_unref(caps);
 
         // Add pipeline rtpjitterbuffer
         auto* jitter_buffer = gst_element_factory_make("rtpjitterbuffer", NULL);
@@ -78,10 +73,8 @@ struct gst_st2110_30_receiver_impl : gst_receiver_plugin_t
         BST_ENFORCE(depay != nullptr, "Failed creating GStreamer element depay");
         BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), depay), "Failed adding depay to the pipeline");
 
-        // Add pipeline video sink
-        auto* sink = gst_element_factory_make("pulsesink", NULL);
-        BST_ENFORCE(sink != nullptr, "Failed creating GStreamer element sink");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), sink), "Failed adding sink to the pipeline");
+        // Add pipeline sink: appsink handing the depayloaded samples over as they are, or pulsesink
+        BST_ASSIGN(sink, add_sink(GST_BIN(pipeline)));
 
         // Link all elements together
         BST_ENFORCE(gst_element_link_many(source, jitter_buffer, queue1, depay, sink, NULL),
@@ -93,10 +86,36 @@ struct gst_st2110_30_receiver_impl : gst_receiver_plugin_t
         return {};
     }
 
+    expected<GstElement*> add_sink(GstBin* bin)
+    {
+        if(s_.app_sink.has_value())
+        {
+            BST_CHECK_ASSIGN(app_sink_, app_sink_t::create(bin, *s_.app_sink));
+            return app_sink_->element();
+        }
+
+        auto* sink = gst_element_factory_make("pulsesink", NULL);
+        BST_ENFORCE(sink != nullptr, "Failed creating GStreamer element sink");
+        BST_ENFORCE(gst_bin_add(bin, sink), "Failed adding sink to the pipeline");
+        return sink;
+    }
+
     void stop() noexcept override
     {
         pipeline_.stop();
         pipeline_ = {};
+        app_sink_.reset();
+    }
+
+    void on_frame(std::function<void(received_frame_t)> callback) noexcept override
+    {
+        if(app_sink_) app_sink_->on_frame(std::move(callback));
+    }
+
+    expected<std::optional<received_frame_t>> pull_frame(std::chrono::nanoseconds timeout) noexcept override
+    {
+        BST_ENFORCE(app_sink_.has_value(), "This receiver has no app sink");
+        return app_sink_->pull(timeout);
     }
 };
 
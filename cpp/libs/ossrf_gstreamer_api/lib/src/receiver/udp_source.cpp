@@ -0,0 +1,72 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "udp_source.h"
+#include "bisect/expected/macros.h"
+#include "bisect/rtp/elements.h"
+
+using namespace bisect;
+using namespace ossrf::gst::receiver;
+using namespace ossrf::gst::plugins;
+
+expected<GstElement*> ossrf::gst::plugins::create_udp_source(const network_settings_t& network) noexcept
+{
+    GstElement* source = nullptr;
+
+    if(network.batching.has_value())
+    {
+        BST_ENFORCE(bisect::rtp::register_elements(), "Failed registering the ST 2110 elements");
+        source = gst_element_factory_make(bisect::rtp::udp_batch_src_factory, NULL);
+        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element {}", bisect::rtp::udp_batch_src_factory);
+        g_object_set(G_OBJECT(source), "batch-size", network.batching->batch_size, NULL);
+        g_object_set(G_OBJECT(source), "buffer-size", network.batching->buffer_size, NULL);
+    }
+    else
+    {
+        source = gst_element_factory_make("udpsrc", NULL);
+        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element udpsrc");
+        g_object_set(G_OBJECT(source), "auto-multicast", TRUE, NULL);
+    }
+
+    // Set udp source params
+    g_object_set(G_OBJECT(source), "address", network.source_ip_address.c_str(), NULL);
+    g_object_set(G_OBJECT(source), "port", static_cast<gint>(network.source_port), NULL);
+    g_object_set(G_OBJECT(source), "multicast-iface", network.interface_name.c_str(), NULL);
+
+    return source;
+}
+
+expected<GstElement*> ossrf::gst::plugins::add_udp_sources(GstBin* bin, const receiver_settings& settings,
+                                                           GstCaps* caps) noexcept
+{
+    BST_ASSIGN(primary, create_udp_source(settings.primary));
+    g_object_set(G_OBJECT(primary), "caps", caps, NULL);
+    BST_ENFORCE(gst_bin_add(bin, primary), "Failed adding udp source to the pipeline");
+
+    if(!settings.secondary.has_value()) return primary;
+
+    BST_ASSIGN(secondary, create_udp_source(settings.secondary.value()));
+    g_object_set(G_OBJECT(secondary), "caps", caps, NULL);
+    BST_ENFORCE(gst_bin_add(bin, secondary), "Failed adding secondary udp source to the pipeline");
+
+    BST_ENFORCE(bisect::rtp::register_elements(), "Failed registering the ST 2110 elements");
+    auto* merge = gst_element_factory_make(bisect::rtp::st2022_7_merge_factory, NULL);
+    BST_ENFORCE(merge != nullptr, "Failed creating GStreamer element {}", bisect::rtp::st2022_7_merge_factory);
+    BST_ENFORCE(gst_bin_add(bin, merge), "Failed adding merge to the pipeline");
+
+    BST_ENFORCE(gst_element_link_pads(primary, "src", merge, "sink_0"), "Failed linking the primary leg");
+    BST_ENFORCE(gst_element_link_pads(secondary, "src", merge, "sink_1"), "Failed linking the secondary leg");
+
+    return merge;
+}
@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "bisect/expected.h"
+#include "ossrf/gstreamer/api/receiver/receiver_configuration.h"
+#include <gst/gst.h>
+
+namespace ossrf::gst::plugins
+{
+    // Creates the source receiving from `network`: udpsrc, or st2110udpsrc when batching is configured.
+    bisect::expected<GstElement*> create_udp_source(const ossrf::gst::receiver::network_settings_t& network) noexcept;
+
+    // Adds to `bin` one source per network leg, each producing `caps`. Returns the element to link downstream: the
+    // primary source or, with a SMPTE 2022-7 secondary leg, a merge that keeps the first copy of each packet.
+    bisect::expected<GstElement*> add_udp_sources(GstBin* bin, const ossrf::gst::receiver::receiver_settings& settings,
+                                                  GstCaps* caps) noexcept;
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "app_source.h"
+#include "bisect/expected/macros.h"
+#include <gst/app/gstappsrc.h>
+#include <gst/audio/audio.h>
+#include <gst/video/video.h>
+#include <mutex>
+
+using namespace bisect;
+using namespace ossrf::gst::sender;
+using namespace ossrf::gst::plugins;
+
+struct app_source_t::window_t
+{
+    explicit window_t(uint32_t c) : capacity(c) {}
+
+    const uint32_t capacity;
+    std::mutex mutex;
+    uint32_t in_flight = 0;
+    std::function<void()> on_available;
+};
+
+namespace
+{
+    // Owned by a pushed buffer and destroyed with it.
+    struct pending_frame_t
+    {
+        std::shared_ptr<app_source_t::window_t> window;
+        std::function<void()> release;
+    };
+
+    void release_frame(gpointer data)
+    {
+        auto* frame = static_cast<pending_frame_t*>(data);
+        if(frame->release) frame->release();
+
+        std::function<void()> notify;
+        {
+            std::unique_lock lock(frame->window->mutex);
+            if(frame->window->in_flight-- == frame->window->capacity) notify = frame->window->on_available;
+        }
+        if(notify) notify();
+
+        delete frame;
+    }
+} // namespace
+
+expected<app_source_t> app_source_t::create(GstBin* bin, GstCaps* caps, const app_source_settings_t& settings) noexcept
+{
+    BST_ENFORCE(settings.max_frames_in_flight > 0, "max_frames_in_flight must be greater than 0");
+
+    size_t frame_size  = 0;
+    size_t sample_size = 1;
+    GstVideoInfo video_info;
+    GstAudioInfo audio_info;
+    if(gst_video_info_from_caps(&video_info, caps))
+    {
+        frame_size = GST_VIDEO_INFO_SIZE(&video_info);
+    }
+    else if(gst_audio_info_from_caps(&audio_info, caps))
+    {
+        sample_size = static_cast<size_t>(GST_AUDIO_INFO_BPF(&audio_info));
+    }
+    else
+    {
+        BST_FAIL("app source caps are neither raw video nor raw audio");
+    }
+
+    auto* element = gst_element_factory_make("appsrc", NULL);
+    BST_ENFORCE(element != nullptr, "Failed creating GStreamer element appsrc");
+    // The in-flight window is the only bound on queued frames.
+    g_object_set(G_OBJECT(element), "caps", caps, "format", GST_FORMAT_TIME, "is-live", TRUE, "block", FALSE,
+                 "max-bytes", guint64{0}, NULL);
+    BST_ENFORCE(gst_bin_add(bin, element), "Failed adding appsrc to the pipeline");
+
+    return app_source_t(element, std::make_shared<window_t>(settings.max_frames_in_flight), frame_size, sample_size);
+}
+
+app_source_t::app_source_t(GstElement* element, std::shared_ptr<window_t> window, size_t frame_size,
+                           size_t sample_size)
+    : element_(element), window_(std::move(window)), frame_size_(frame_size), sample_size_(sample_size)
+{
+}
+
+expected<push_result_t> app_source_t::push(frame_t frame) noexcept
+{
+    BST_ENFORCE(frame.data != nullptr && frame.size > 0, "Frame has no data");
+    BST_ENFORCE(frame_size_ == 0 || frame.size == frame_size_, "Frame has {} bytes, expected {}", frame.size,
+                frame_size_);
+    BST_ENFORCE(frame.size % sample_size_ == 0, "Frame has {} bytes, not a whole number of {} byte samples",
+                frame.size, sample_size_);
+
+    {
+        std::unique_lock lock(window_->mutex);
+        if(window_->in_flight == window_->capacity) return push_result_t::window_full;
+        ++window_->in_flight;
+    }
+
+    // From here on the buffer owns the frame: release_frame runs when it is freed, whether sent or dropped.
+    auto* pending = new pending_frame_t{window_, std::move(frame.release)};
+    auto* buffer  = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, const_cast<void*>(frame.data), frame.size,
+                                                0, frame.size, pending, &release_frame);
+
+    if(frame.pts.has_value())
+    {
+        GST_BUFFER_PTS(buffer) = *frame.pts;
+    }
+    else if(auto* clock = gst_element_get_clock(element_); clock != nullptr)
+    {
+        GST_BUFFER_PTS(buffer) = gst_clock_get_time(clock) - gst_element_get_base_time(element_);
+        gst_object_unref(clock);
+    }
+
+    const auto flow = gst_app_src_push_buffer(GST_APP_SRC(element_), buffer);
+    BST_ENFORCE(flow == GST_FLOW_OK, "Failed pushing frame: {}", gst_flow_get_name(flow));
+    return push_result_t::pushed;
+}
+
+size_t app_source_t::in_flight() const noexcept
+{
+    std::unique_lock lock(window_->mutex);
+    return window_->in_flight;
+}
+
+void app_source_t::on_window_available(std::function<void()> callback) noexcept
+{
+    std::unique_lock lock(window_->mutex);
+    window_->on_available = std::move(callback);
+}
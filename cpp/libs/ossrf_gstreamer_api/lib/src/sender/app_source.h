@@ -0,0 +1,52 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "bisect/expected.h"
+#include "ossrf/gstreamer/api/sender/sender_configuration.h"
+#include "ossrf/gstreamer/api/sender/sender_plugin.h"
+#include <gst/gst.h>
+#include <functional>
+#include <memory>
+
+namespace ossrf::gst::plugins
+{
+    // An appsrc fed with application frames. Each frame is wrapped into a buffer without copying, and at most
+    // `max_frames_in_flight` frames may be pushed and not yet released.
+    class app_source_t
+    {
+      public:
+        struct window_t;
+
+        // Adds to `bin` an appsrc producing raw video or audio `caps`.
+        static bisect::expected<app_source_t> create(GstBin* bin, GstCaps* caps,
+                                                     const ossrf::gst::sender::app_source_settings_t& settings) noexcept;
+
+        GstElement* element() const noexcept { return element_; }
+
+        bisect::expected<push_result_t> push(frame_t frame) noexcept;
+        size_t in_flight() const noexcept;
+        void on_window_available(std::function<void()> callback) noexcept;
+
+      private:
+        app_source_t(GstElement* element, std::shared_ptr<window_t> window, size_t frame_size, size_t sample_size);
+
+        GstElement* element_;
+        // Shared with the buffers in flight, which may be released after the source is gone.
+        std::shared_ptr<window_t> window_;
+        // Video frames have exactly frame_size bytes; audio frames any whole number of samples.
+        size_t frame_size_;
+        size_t sample_size_;
+    };
+} // namespace ossrf::gst::plugins
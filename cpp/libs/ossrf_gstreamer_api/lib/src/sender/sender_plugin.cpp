@@ -45,10 +45,19 @@ namespace
         BST_FAIL("invalid frame structure '{}'", s);
     }
 
+    expected<pacing_t> to_pacing(const std::string& s)
+    {
+        if(s == "none") return pacing_t::none;
+        if(s == "narrow") return pacing_t::narrow;
+        if(s == "narrow_linear") return pacing_t::narrow_linear;
+        if(s == "wide") return pacing_t::wide;
+        BST_FAIL("invalid pacing '{}'", s);
+    }
+
     expected<video_info_t> video_sender_info_from_json(const json& media)
     {
         video_info_t info;
-        BST_ASSIGN(frame_rate, find<json>(media, "frame_rate"));
+        BST_ASSIGN(frame_rate, find<json_ref>(media, "frame_rate"));
         BST_CHECK_ASSIGN(info.exact_framerate, framerate_from_json(frame_rate));
         BST_CHECK_ASSIGN(info.chroma_sub_sampling, find<std::string>(media, "sampling"));
         BST_CHECK_ASSIGN(info.width, find<int>(media, "width"));
@@ -56,6 +65,8 @@ namespace
         BST_ASSIGN(structure_s, find<std::string>(media, "structure"));
         BST_ASSIGN(structure, to_interlace_mode(structure_s));
         info.structure = structure;
+        BST_ASSIGN(pacing_s, find_or<std::string>(media, "pacing", std::string("none")));
+        BST_CHECK_ASSIGN(info.pacing, to_pacing(pacing_s));
 
         return info;
     }
@@ -70,27 +81,62 @@ namespace
         return info;
     }
 
-    expected<network_settings_t> network_from_json(const json& config)
+    expected<udp_batching_t> batching_from_json(const json& config)
+    {
+        udp_batching_t batching;
+        BST_CHECK_ASSIGN(batching.batch_size, find_or<uint32_t>(config, "batch_size", uint32_t{batching.batch_size}));
+        BST_CHECK_ASSIGN(batching.gso, find_or<bool>(config, "gso", false));
+        BST_ENFORCE(batching.batch_size > 0, "batch_size must be greater than 0");
+        return batching;
+    }
+
+    expected<network_settings_t> network_leg_from_json(const json& leg)
     {
         network_settings_t net;
-        BST_ASSIGN(primary, find<json>(config, "primary"));
-        assign_if<std::string>(primary, "destination_address", net, &network_settings_t::destination_ip_address);
-        assign_if<uint16_t>(primary, "destination_port", net, &network_settings_t::destination_port);
-        assign_if<std::string>(primary, "source_address", net, &network_settings_t::source_ip_address);
-        assign_if<std::string>(primary, "interface_name", net, &network_settings_t::interface_name);
+        assign_if<std::string>(leg, "destination_address", net, &network_settings_t::destination_ip_address);
+        assign_if<uint16_t>(leg, "destination_port", net, &network_settings_t::destination_port);
+        assign_if<std::string>(leg, "source_address", net, &network_settings_t::source_ip_address);
+        assign_if<std::string>(leg, "interface_name", net, &network_settings_t::interface_name);
+
+        if(const auto it = leg.find("batching"); it != leg.end())
+        {
+            BST_CHECK_ASSIGN(net.batching, batching_from_json(*it));
+        }
 
         return net;
     }
 
+    expected<app_source_settings_t> app_source_from_json(const json& config)
+    {
+        app_source_settings_t app_source;
+        BST_CHECK_ASSIGN(app_source.max_frames_in_flight,
+                         find_or<uint32_t>(config, "max_frames_in_flight", uint32_t{app_source.max_frames_in_flight}));
+        BST_ENFORCE(app_source.max_frames_in_flight > 0, "max_frames_in_flight must be greater than 0");
+        return app_source;
+    }
+
     expected<sender_settings> translate_json(const json& config)
     {
         sender_settings s;
-        BST_ASSIGN(network, find<json>(config, "network"));
-        BST_CHECK_ASSIGN(s.primary, network_from_json(network));
+        BST_ASSIGN(network, find<json_ref>(config, "network"));
+        BST_ASSIGN(primary, find<json_ref>(network, "primary"));
+        BST_CHECK_ASSIGN(s.primary, network_leg_from_json(primary));
+
+        // SMPTE 2022-7: the same packets are also sent on the secondary leg.
+        if(const auto secondary = network.get().find("secondary"); secondary != network.get().end())
+        {
+            BST_CHECK_ASSIGN(s.secondary, network_leg_from_json(*secondary));
+        }
+
+        // Frames come from push_frame instead of a test pattern.
+        if(const auto app_source = config.find("app_source"); app_source != config.end())
+        {
+            BST_CHECK_ASSIGN(s.app_source, app_source_from_json(*app_source));
+        }
 
         BST_ASSIGN(media_type, find<std::string>(config, "media_type"));
 
-        BST_ASSIGN(media, find<json>(config, "media"));
+        BST_ASSIGN(media, find<json_ref>(config, "media"));
 
         if(media_type == "video/raw")
         {
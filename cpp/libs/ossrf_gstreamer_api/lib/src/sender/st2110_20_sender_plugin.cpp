@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "st2110_20_sender_plugin.h"
+#include "udp_sink.h"
+#include "app_source.h"
 #include "bisect/expected/macros.h"
 #include "bisect/pipeline.h"
+#include "bisect/rtp/elements.h"
 #include <gst/gst.h>
 
 using namespace bisect;
@@ -33,6 +36,7 @@ struct gst_st2110_20_sender_impl : gst_sender_plugin_t
     sender_settings s_;
     video_info_t f_;
     gst::pipeline pipeline_;
+    std::optional<app_source_t> app_source_;
 
     gst_st2110_20_sender_impl(sender_settings settings, video_info_t format) : s_(settings), f_(format) {}
 
@@ -44,11 +48,8 @@ struct gst_st2110_20_sender_impl : gst_sender_plugin_t
         BST_CHECK_ASSIGN(pipeline_, bisect::gst::pipeline::create(NULL));
         auto* pipeline = pipeline_.get();
 
-        // Add pipeline videotestsrc
-        auto* source = gst_element_factory_make("videotestsrc", NULL);
-        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element videotestsrc");
-        g_object_set(G_OBJECT(source), "pattern", pattern, NULL);
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), source), "Failed adding videotestsrc to the pipeline");
+        // Add pipeline source: appsrc fed by push_frame, or videotestsrc
+        BST_ASSIGN(source, add_source(GST_BIN(pipeline), pattern));
 
         // Add pipeline capsfilter
         auto* capsfilter = gst_element_factory_make("capsfilter", NULL);
@@ -69,20 +70,16 @@ struct gst_st2110_20_sender_impl : gst_sender_plugin_t
                      "max-size-bytes", queue_max_size_bytes, NULL);
         BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), queue1), "Failed adding queue to the pipeline");
 
-        // Add pipeline rtpvrawpay
-        auto* rtpvrawpay = gst_element_factory_make("rtpvrawpay", NULL);
-        BST_ENFORCE(rtpvrawpay != nullptr, "Failed creating GStreamer element rtpvrawpay");
+        // Add pipeline ST 2110-20 payloader
+        BST_ENFORCE(bisect::rtp::register_elements(), "Failed registering the ST 2110-20 elements");
+        auto* rtpvrawpay = gst_element_factory_make(bisect::rtp::st2110_20_pay_factory, NULL);
+        BST_ENFORCE(rtpvrawpay != nullptr, "Failed creating GStreamer element {}", bisect::rtp::st2110_20_pay_factory);
         BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), rtpvrawpay), "Failed adding rtpvrawpay to the pipeline");
 
-        // Add pipeline udpsink
-        auto* udpsink = gst_element_factory_make("udpsink", NULL);
-        BST_ENFORCE(udpsink != nullptr, "Failed creating GStreamer element udpsink");
-        // Set properties
-        g_object_set(G_OBJECT(udpsink), "host", s_.primary.destination_ip_address.c_str(), NULL);
-        g_object_set(G_OBJECT(udpsink), "port", s_.primary.destination_port, NULL);
-        g_object_set(G_OBJECT(udpsink), "auto-multicast", TRUE, NULL);
-        g_object_set(G_OBJECT(udpsink), "multicast-iface", s_.primary.interface_name.c_str(), NULL);
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), udpsink), "Failed adding udpsink to the pipeline");
+        // Add pipeline udpsink, one per network leg
+        BST_ASSIGN(udpsink, add_udp_sinks(GST_BIN(pipeline), s_, [this](const network_settings_t& network) {
+                       return create_paced_udp_sink(network, f_);
+                   }));
 
         // Link elements
         BST_ENFORCE(gst_element_link_many(source, capsfilter, queue1, rtpvrawpay, udpsink, NULL),
@@ -94,10 +91,46 @@ struct gst_st2110_20_sender_impl : gst_sender_plugin_t
         return {};
     }
 
+    expected<GstElement*> add_source(GstBin* bin, int pattern)
+    {
+        if(s_.app_source.has_value())
+        {
+            auto* caps = gst_caps_new_simple("video/x-raw", "format", G_TYPE_STRING, "UYVP", "width", G_TYPE_INT,
+                                             f_.width, "height", G_TYPE_INT, f_.height, "framerate", GST_TYPE_FRACTION,
+                                             static_cast<int>(f_.exact_framerate.num),
+                                             static_cast<int>(f_.exact_framerate.den), NULL);
+            BST_ENFORCE(caps != nullptr, "Failed creating GStreamer video caps");
+            auto app_source = app_source_t::create(bin, caps, *s_.app_source);
+            gst_caps_unref(caps);
+            BST_CHECK_ASSIGN(app_source_, std::move(app_source));
+            return app_source_->element();
+        }
+
+        auto* source = gst_element_factory_make("videotestsrc", NULL);
+        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element videotestsrc");
+        g_object_set(G_OBJECT(source), "pattern", pattern, NULL);
+        BST_ENFORCE(gst_bin_add(bin, source), "Failed adding videotestsrc to the pipeline");
+        return source;
+    }
+
     void stop() noexcept override
     {
         pipeline_.stop();
         pipeline_ = {};
+        app_source_.reset();
+    }
+
+    expected<push_result_t> push_frame(frame_t frame) noexcept override
+    {
+        BST_ENFORCE(app_source_.has_value(), "This sender has no app source");
+        return app_source_->push(std::move(frame));
+    }
+
+    size_t frames_in_flight() const noexcept override { return app_source_ ? app_source_->in_flight() : 0; }
+
+    void on_window_available(std::function<void()> callback) noexcept override
+    {
+        if(app_source_) app_source_->on_window_available(std::move(callback));
     }
 };
 
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "st2110_30_sender_plugin.h"
+#include "udp_sink.h"
+#include "app_source.h"
 #include "bisect/expected/macros.h"
 #include "bisect/pipeline.h"
 #include <gst/gst.h>
@@ -33,6 +35,7 @@ struct gst_st2110_30_sender_impl : gst_sender_plugin_t
     sender_settings s_;
     audio_info_t f_;
     gst::pipeline pipeline_;
+    std::optional<app_source_t> app_source_;
 
     gst_st2110_30_sender_impl(sender_settings settings, audio_info_t format) : s_(settings), f_(format) {}
 
@@ -44,10 +47,8 @@ struct gst_st2110_30_sender_impl : gst_sender_plugin_t
         BST_CHECK_ASSIGN(pipeline_, bisect::gst::pipeline::create(NULL));
         auto* pipeline = pipeline_.get();
 
-        // Add pipeline audiotestsrc (audio source)
-        auto* source = gst_element_factory_make("audiotestsrc", NULL);
-        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element audiotestsrc");
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), source), "Failed adding audiotestsrc to the pipeline");
+        // Add pipeline source: appsrc fed by push_frame, or audiotestsrc
+        BST_ASSIGN(source, add_source(GST_BIN(pipeline)));
 
         // Add pipeline queue1
         auto* queue1 = gst_element_factory_make("queue", NULL);
@@ -97,15 +98,8 @@ struct gst_st2110_30_sender_impl : gst_sender_plugin_t
         BST_ENFORCE(rtpL24pay != nullptr, "Failed creating GStreamer element rtpL24pay");
         BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), rtpL24pay), "Failed adding rtpL24pay to the pipeline");
 
-        // Add pipeline udpsink
-        auto* udpsink = gst_element_factory_make("udpsink", NULL);
-        BST_ENFORCE(udpsink != nullptr, "Failed creating GStreamer element udpsink");
-        // Set properties
-        g_object_set(G_OBJECT(udpsink), "host", s_.primary.destination_ip_address.c_str(), NULL);
-        g_object_set(G_OBJECT(udpsink), "port", s_.primary.destination_port, NULL);
-        g_object_set(G_OBJECT(udpsink), "auto-multicast", TRUE, NULL);
-        g_object_set(G_OBJECT(udpsink), "multicast-iface", s_.primary.interface_name.c_str(), NULL);
-        BST_ENFORCE(gst_bin_add(GST_BIN(pipeline), udpsink), "Failed adding udpsink to the pipeline");
+        // Add pipeline udpsink, one per network leg
+        BST_ASSIGN(udpsink, add_udp_sinks(GST_BIN(pipeline), s_, create_udp_sink));
 
         // Link elements
         BST_ENFORCE(gst_element_link_many(source, queue1, audioconvert, queue2, audioresample, capsfilter, queue3,
@@ -118,10 +112,44 @@ struct gst_st2110_30_sender_impl : gst_sender_plugin_t
         return {};
     }
 
+    expected<GstElement*> add_source(GstBin* bin)
+    {
+        if(s_.app_source.has_value())
+        {
+            auto* caps = gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, "S24BE", "layout", G_TYPE_STRING,
+                                             "interleaved", "channels", G_TYPE_INT, f_.number_of_channels, "rate",
+                                             G_TYPE_INT, f_.sampling_rate, NULL);
+            BST_ENFORCE(caps != nullptr, "Failed creating GStreamer audio caps");
+            auto app_source = app_source_t::create(bin, caps, *s_.app_source);
+            gst_caps_unref(caps);
+            BST_CHECK_ASSIGN(app_source_, std::move(app_source));
+            return app_source_->element();
+        }
+
+        auto* source = gst_element_factory_make("audiotestsrc", NULL);
+        BST_ENFORCE(source != nullptr, "Failed creating GStreamer element audiotestsrc");
+        BST_ENFORCE(gst_bin_add(bin, source), "Failed adding audiotestsrc to the pipeline");
+        return source;
+    }
+
     void stop() noexcept override
     {
         pipeline_.stop();
         pipeline_ = {};
+        app_source_.reset();
+    }
+
+    expected<push_result_t> push_frame(frame_t frame) noexcept override
+    {
+        BST_ENFORCE(app_source_.has_value(), "This sender has no app source");
+        return app_source_->push(std::move(frame));
+    }
+
+    size_t frames_in_flight() const noexcept override { return app_source_ ? app_source_->in_flight() : 0; }
+
+    void on_window_available(std::function<void()> callback) noexcept override
+    {
+        if(app_source_) app_source_->on_window_available(std::move(callback));
     }
 };
 
@@ -0,0 +1,120 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "udp_sink.h"
+#include "bisect/expected/macros.h"
+#include "bisect/rtp/elements.h"
+
+using namespace bisect;
+using namespace ossrf::gst::sender;
+using namespace ossrf::gst::plugins;
+
+namespace
+{
+    expected<GstElement*> make_batch_sink(const network_settings_t& network)
+    {
+        BST_ENFORCE(bisect::rtp::register_elements(), "Failed registering the ST 2110 elements");
+        auto* udpsink = gst_element_factory_make(bisect::rtp::udp_batch_sink_factory, NULL);
+        BST_ENFORCE(udpsink != nullptr, "Failed creating GStreamer element {}", bisect::rtp::udp_batch_sink_factory);
+
+        const auto batching = network.batching.value_or(udp_batching_t{});
+        g_object_set(G_OBJECT(udpsink), "batch-size", batching.batch_size, NULL);
+        g_object_set(G_OBJECT(udpsink), "gso", static_cast<gboolean>(batching.gso), NULL);
+        return udpsink;
+    }
+
+    const char* to_pacing_property(pacing_t pacing)
+    {
+        switch(pacing)
+        {
+        case pacing_t::narrow: return "narrow";
+        case pacing_t::narrow_linear: return "narrow-linear";
+        case pacing_t::wide: return "wide";
+        case pacing_t::none: break;
+        }
+        return "none";
+    }
+
+    void set_destination(GstElement* udpsink, const network_settings_t& network)
+    {
+        g_object_set(G_OBJECT(udpsink), "host", network.destination_ip_address.c_str(), NULL);
+        g_object_set(G_OBJECT(udpsink), "port", network.destination_port, NULL);
+        g_object_set(G_OBJECT(udpsink), "multicast-iface", network.interface_name.c_str(), NULL);
+    }
+} // namespace
+
+expected<GstElement*> ossrf::gst::plugins::create_udp_sink(const network_settings_t& network) noexcept
+{
+    GstElement* udpsink = nullptr;
+
+    if(network.batching.has_value())
+    {
+        BST_CHECK_ASSIGN(udpsink, make_batch_sink(network));
+    }
+    else
+    {
+        udpsink = gst_element_factory_make("udpsink", NULL);
+        BST_ENFORCE(udpsink != nullptr, "Failed creating GStreamer element udpsink");
+        g_object_set(G_OBJECT(udpsink), "auto-multicast", TRUE, NULL);
+    }
+
+    set_destination(udpsink, network);
+    return udpsink;
+}
+
+expected<GstElement*> ossrf::gst::plugins::create_paced_udp_sink(const network_settings_t& network,
+                                                                 const video_info_t& video) noexcept
+{
+    if(video.pacing == pacing_t::none) return create_udp_sink(network);
+
+    BST_ASSIGN(udpsink, make_batch_sink(network));
+    set_destination(udpsink, network);
+
+    // ST 2110-21 timing: TRS and TRO follow from the frame rate, height and scan.
+    const auto interlaced = video.structure != frame_structure_t::progressive;
+    g_object_set(G_OBJECT(udpsink), "pacing", to_pacing_property(video.pacing), NULL);
+    g_object_set(G_OBJECT(udpsink), "framerate", static_cast<gint>(video.exact_framerate.num),
+                 static_cast<gint>(video.exact_framerate.den), NULL);
+    g_object_set(G_OBJECT(udpsink), "height", static_cast<guint>(video.height), NULL);
+    g_object_set(G_OBJECT(udpsink), "interlaced", static_cast<gboolean>(interlaced), NULL);
+
+    return udpsink;
+}
+
+expected<GstElement*> ossrf::gst::plugins::add_udp_sinks(GstBin* bin, const sender_settings& settings,
+                                                         const udp_sink_factory_t& make_sink) noexcept
+{
+    BST_ASSIGN(primary, make_sink(settings.primary));
+    BST_ENFORCE(gst_bin_add(bin, primary), "Failed adding udpsink to the pipeline");
+
+    if(!settings.secondary.has_value()) return primary;
+
+    BST_ASSIGN(secondary, make_sink(settings.secondary.value()));
+    BST_ENFORCE(gst_bin_add(bin, secondary), "Failed adding secondary udpsink to the pipeline");
+
+    // The tee pushes a new reference to each buffer (or buffer list) on both legs, in the streaming thread of the
+    // payloader, so the second leg only costs its send calls. With no queue in between, one sink waiting for
+    // preroll would hold back the other, so neither may delay the state change.
+    g_object_set(G_OBJECT(primary), "async", FALSE, NULL);
+    g_object_set(G_OBJECT(secondary), "async", FALSE, NULL);
+
+    auto* tee = gst_element_factory_make("tee", NULL);
+    BST_ENFORCE(tee != nullptr, "Failed creating GStreamer element tee");
+    BST_ENFORCE(gst_bin_add(bin, tee), "Failed adding tee to the pipeline");
+
+    BST_ENFORCE(gst_element_link(tee, primary), "Failed linking the primary leg");
+    BST_ENFORCE(gst_element_link(tee, secondary), "Failed linking the secondary leg");
+
+    return tee;
+}
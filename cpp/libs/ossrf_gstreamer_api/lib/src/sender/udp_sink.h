@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "bisect/expected.h"
+#include "ossrf/gstreamer/api/sender/sender_configuration.h"
+#include <gst/gst.h>
+#include <functional>
+
+namespace ossrf::gst::plugins
+{
+    // Creates the sink sending to `network`: udpsink, or st2110udpsink when batching is configured.
+    bisect::expected<GstElement*> create_udp_sink(const ossrf::gst::sender::network_settings_t& network) noexcept;
+
+    // Creates st2110udpsink sending to `network`, pacing frames as configured in `video`.
+    bisect::expected<GstElement*> create_paced_udp_sink(const ossrf::gst::sender::network_settings_t& network,
+                                                        const ossrf::gst::sender::video_info_t& video) noexcept;
+
+    using udp_sink_factory_t =
+        std::function<bisect::expected<GstElement*>(const ossrf::gst::sender::network_settings_t&)>;
+
+    // Adds to `bin` one sink per network leg, made by `make_sink`. Returns the element the payloader links to: the
+    // primary sink or, with a SMPTE 2022-7 secondary leg, a tee that hands the same packet buffers to both sinks.
+    bisect::expected<GstElement*> add_udp_sinks(GstBin* bin, const ossrf::gst::sender::sender_settings& settings,
+                                                const udp_sink_factory_t& make_sink) noexcept;
+}
@@ -18,9 +18,20 @@
 #include "bisect/expected.h"
 #include <nmos/id.h>
 #include <nmos/type.h>
+#include <string>
+#include <vector>
 
 namespace ossrf
 {
+    // Senders and receivers to remove from and add to the lists of a device, in that order.
+    struct device_sub_resources_update_t
+    {
+        std::vector<std::string> removed_senders;
+        std::vector<std::string> added_senders;
+        std::vector<std::string> removed_receivers;
+        std::vector<std::string> added_receivers;
+    };
+
     class nmos_t
     {
       public:
@@ -39,9 +50,9 @@ namespace ossrf
 
         [[nodiscard]] virtual bisect::maybe_ok modify_device(const bisect::nmoscpp::nmos_device_t& device) = 0;
 
-        [[nodiscard]] virtual bisect::maybe_ok modify_device_sub_resources(const std::string& device_id,
-                                                                         const std::vector<std::string>& receivers,
-                                                                         const std::vector<std::string>& senders) = 0;
+        // Only touches the listed ids; the other senders and receivers of the device are left as they are.
+        [[nodiscard]] virtual bisect::maybe_ok
+        update_device_sub_resources(const std::string& device_id, const device_sub_resources_update_t& update) = 0;
 
         [[nodiscard]] virtual bisect::maybe_ok modify_receiver(const std::string& device_id,
                                                                const bisect::nmoscpp::nmos_receiver_t& config) = 0;
@@ -53,6 +64,13 @@ namespace ossrf
                                                                const nmos::type& type) = 0;
 
         [[nodiscard]] virtual bisect::maybe_ok update_clocks(const std::string& clocks) = 0;
+
+        // Between begin_batch and commit_batch, the devices, senders and receivers added and the devices modified are
+        // staged, and commit_batch writes them into the node model at once. Removals are not staged: remove_resource
+        // applies immediately, even with a batch open. abort_batch drops the staged changes and closes the batch.
+        [[nodiscard]] virtual bisect::maybe_ok begin_batch() = 0;
+        [[nodiscard]] virtual bisect::maybe_ok commit_batch() = 0;
+        virtual void abort_batch() noexcept = 0;
     };
 
     using nmos_uptr = std::unique_ptr<nmos_t>;
@@ -45,6 +45,13 @@ namespace ossrf
 
         bisect::maybe_ok remove_resource(const std::string& id, const nmos::type& type) noexcept;
 
+        // Senders and receivers added between begin_batch and commit_batch are registered together: their resources
+        // are written into the node model under a single lock, and each device is updated once, at commit.
+        // Removals are not atomic with the batch: the resources of a removed sender or receiver are erased right away
+        // and only the update of its device's lists waits for the commit. A failed commit closes the batch.
+        bisect::maybe_ok begin_batch() noexcept;
+        bisect::maybe_ok commit_batch() noexcept;
+
       private:
         struct impl;
         std::unique_ptr<impl> impl_;
@@ -41,8 +41,8 @@ namespace ossrf
         [[nodiscard]] bisect::maybe_ok modify_device(const bisect::nmoscpp::nmos_device_t& config) noexcept override;
 
         [[nodiscard]] bisect::maybe_ok
-        modify_device_sub_resources(const std::string& device_id, const std::vector<std::string>& receivers,
-                                    const std::vector<std::string>& senders) noexcept override;
+        update_device_sub_resources(const std::string& device_id,
+                                    const device_sub_resources_update_t& update) noexcept override;
 
         [[nodiscard]] bisect::maybe_ok
         modify_receiver(const std::string& device_id, const bisect::nmoscpp::nmos_receiver_t& config) noexcept override;
@@ -55,6 +55,10 @@ namespace ossrf
 
         [[nodiscard]] bisect::maybe_ok update_clocks(const std::string& clocks) noexcept override;
 
+        [[nodiscard]] bisect::maybe_ok begin_batch() noexcept override;
+        [[nodiscard]] bisect::maybe_ok commit_batch() noexcept override;
+        void abort_batch() noexcept override;
+
       private:
         struct impl;
         std::unique_ptr<impl> impl_;
@@ -15,6 +15,7 @@
 #include "nmos_event_handler.h"
 #include "bisect/expected.h"
 #include "bisect/expected/macros.h"
+#include "bisect/nmoscpp/json.h"
 #include <nlohmann/json.hpp>
 
 using namespace ossrf;
@@ -27,33 +28,33 @@ nmos_event_handler::nmos_event_handler(nmos_context_ptr context) : context_(cont
 {
 }
 
-expected<std::string> nmos_event_handler::handle_active_state_changed(const nmos::resource& resource,
-                                                                      const nmos::resource& connection_resource,
-                                                                      const std::string& transport_params)
+maybe_ok nmos_event_handler::handle_active_state_changed(const nmos::resource& resource,
+                                                         const nmos::resource& connection_resource,
+                                                         const web::json::value& transport_params)
 {
     const auto master_enable =
         connection_resource.data.at(nmos::fields::endpoint_staged).at(nmos::fields::master_enable).as_bool();
 
     BST_ASSIGN(r, context_->resources().find_resource(resource.id));
-    auto tp = json::parse(transport_params);
+    auto tp = from_web_json(transport_params);
     // TODO: Check if there are any auto params and return the resolved params
     BST_CHECK(r->handle_activation(master_enable, tp));
 
-    return transport_params;
+    return {};
 }
 
 maybe_ok nmos_event_handler::handle_patch_request(const nmos::resource& resource,
                                                   const nmos::resource& connection_resource,
-                                                  const std::string& endpoint_staged)
+                                                  const web::json::value& endpoint_staged)
 {
     fmt::print("handle_patch_request: {} {} {}", utility::us2s(resource.id), utility::us2s(connection_resource.id),
-               endpoint_staged);
+               utility::us2s(endpoint_staged.serialize()));
 
     const auto master_enable =
         connection_resource.data.at(nmos::fields::endpoint_staged).at(nmos::fields::master_enable).as_bool();
 
     BST_ASSIGN(r, context_->resources().find_resource(resource.id));
-    BST_CHECK(r->handle_patch(master_enable, json::parse(endpoint_staged)));
+    BST_CHECK(r->handle_patch(master_enable, from_web_json(endpoint_staged)));
     return {};
 }
 
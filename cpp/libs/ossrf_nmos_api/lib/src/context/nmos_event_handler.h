@@ -23,13 +23,13 @@ namespace ossrf
       public:
         nmos_event_handler(nmos_context_ptr context_);
 
-        [[nodiscard]] bisect::expected<std::string>
-        handle_active_state_changed(const nmos::resource& resource, const nmos::resource& connection_resource,
-                                    const std::string& transport_params) override;
+        [[nodiscard]] bisect::maybe_ok handle_active_state_changed(const nmos::resource& resource,
+                                                                   const nmos::resource& connection_resource,
+                                                                   const web::json::value& transport_params) override;
 
         [[nodiscard]] bisect::maybe_ok handle_patch_request(const nmos::resource& resource,
                                                             const nmos::resource& connection_resource,
-                                                            const std::string& endpoint_staged) override;
+                                                            const web::json::value& endpoint_staged) override;
 
         [[nodiscard]] bisect::expected<bisect::nmoscpp::sdp_info_t>
         handle_sdp_info_request(const nmos::id& resource_id) override;
@@ -19,88 +19,74 @@
 using namespace ossrf;
 using namespace bisect;
 
-void resource_map_t::insert(std::string id, nmos_resource_ptr&& entry)
+resource_map_t::id_set_t* resource_map_t::ids_of_type(const nmos::type& type)
 {
-    lock_t lock(mutex_);
-    auto iter = map_.find(id);
-    if(iter != map_.end())
+    if(type == nmos::types::sender) return &sender_ids_;
+    if(type == nmos::types::receiver) return &receiver_ids_;
+    return nullptr;
+}
+
+void resource_map_t::erase_resource(const std::string& id)
+{
+    const auto it = resources_.find(id);
+    if(it == resources_.end()) return;
+
+    if(auto* ids = ids_of_type(it->second.resource->get_resource_type()); ids != nullptr)
     {
-        iter->second.push_back(entry);
+        ids->erase(id);
     }
-    else
+    if(const auto device = devices_.find(it->second.device_id); device != devices_.end())
     {
-        map_.insert({id, {entry}});
+        device->second.erase(id);
     }
+    resources_.erase(it);
 }
 
-void resource_map_t::erase(std::string id)
+void resource_map_t::insert(std::string device_id, nmos_resource_ptr&& entry)
 {
     lock_t lock(mutex_);
-    // Check if id is a device and removes it
-    auto it = map_.find(id);
-    if(it != map_.end())
-    {
-        map_.erase(it);
-    }
-    // Check if id is a receiver/sender and removes it
-    for(auto& [device_id, entry] : map_)
+    auto id = entry->get_id();
+    erase_resource(id);
+
+    if(auto* ids = ids_of_type(entry->get_resource_type()); ids != nullptr)
     {
-        entry.erase(
-            std::remove_if(entry.begin(), entry.end(), [id](const nmos_resource_ptr& r) { return r->get_id() == id; }),
-            entry.end());
+        ids->insert(id);
     }
+    devices_[device_id].insert(id);
+    resources_.emplace(std::move(id), entry_t{std::move(entry), std::move(device_id)});
 }
 
-expected<nmos_resource_ptr> resource_map_t::find_resource(const std::string& resource_id)
+void resource_map_t::erase(std::string id)
 {
     lock_t lock(mutex_);
-    for(auto& [device_id, entry] : map_)
+    // Check if id is a device and removes it, with its resources
+    if(auto device = devices_.extract(id); !device.empty())
     {
-        for(auto& r : entry)
+        for(const auto& resource_id : device.mapped())
         {
-            if(r->get_id() == resource_id)
-            {
-                return r;
-            }
+            erase_resource(resource_id);
         }
     }
+    // Check if id is a receiver/sender and removes it
+    erase_resource(id);
+}
 
-    BST_FAIL("didn't find any resource with ID {}", resource_id);
-    return {};
+expected<nmos_resource_ptr> resource_map_t::find_resource(const std::string& resource_id) const
+{
+    shared_lock_t lock(mutex_);
+    const auto it = resources_.find(resource_id);
+    BST_ENFORCE(it != resources_.end(), "didn't find any resource with ID {}", resource_id);
+    return it->second.resource;
 }
 
 std::vector<std::string> resource_map_t::get_sender_ids() const
 {
-    std::vector<std::string> ids;
-    lock_t lock(mutex_);
-    for(const auto& [id, resources] : map_)
-    {
-        for(const auto& resource : resources)
-        {
-            if(resource->get_resource_type() == nmos::types::sender)
-            {
-                ids.push_back(resource->get_id());
-            }
-        }
-    }
-
-    return ids;
+    shared_lock_t lock(mutex_);
+    return {sender_ids_.begin(), sender_ids_.end()};
 }
 
 std::vector<std::string> resource_map_t::get_receiver_ids() const
 {
-    std::vector<std::string> ids;
-    lock_t lock(mutex_);
-    for(const auto& [id, resources] : map_)
-    {
-        for(const auto& resource : resources)
-        {
-            if(resource->get_resource_type() == nmos::types::receiver)
-            {
-                ids.push_back(resource->get_id());
-            }
-        }
-    }
-
-    return ids;
+    shared_lock_t lock(mutex_);
+    return {receiver_ids_.begin(), receiver_ids_.end()};
 }
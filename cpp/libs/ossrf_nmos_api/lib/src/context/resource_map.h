@@ -18,22 +18,44 @@
 #include "resources/nmos_resource.h"
 #include <nmos/id.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace ossrf
 {
     class resource_map_t
     {
-        mutable std::mutex mutex_;
-        std::unordered_map<std::string, std::vector<nmos_resource_ptr>> map_;
-        using lock_t = std::unique_lock<std::mutex>;
+        struct entry_t
+        {
+            nmos_resource_ptr resource;
+            std::string device_id;
+        };
+        using id_set_t = std::unordered_set<std::string>;
+
+        // Lookups, which every IS-05 activation and PATCH does, share the lock; only inserts and erases take it
+        // exclusively.
+        mutable std::shared_mutex mutex_;
+        // Resources by id, with the ids of each device's resources and of all senders and receivers alongside, so
+        // that no operation has to scan every resource.
+        std::unordered_map<std::string, entry_t> resources_;
+        std::unordered_map<std::string, id_set_t> devices_;
+        id_set_t sender_ids_;
+        id_set_t receiver_ids_;
+        using lock_t        = std::unique_lock<std::shared_mutex>;
+        using shared_lock_t = std::shared_lock<std::shared_mutex>;
+
+        id_set_t* ids_of_type(const nmos::type& type);
+        void erase_resource(const std::string& id);
 
       public:
-        void insert(std::string, nmos_resource_ptr&&);
-        void replace(std::string, nmos_resource_ptr&&);
+        // Adds a resource of `device_id`, replacing any resource with the same id.
+        void insert(std::string device_id, nmos_resource_ptr&&);
+        // Erases the resource with this id or, for a device id, all the resources of that device.
         void erase(std::string);
 
-        bisect::expected<nmos_resource_ptr> find_resource(const std::string& resource_id);
+        bisect::expected<nmos_resource_ptr> find_resource(const std::string& resource_id) const;
         std::vector<std::string> get_sender_ids() const;
         std::vector<std::string> get_receiver_ids() const;
     };
@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "device_sub_resources.h"
+#include <nmos/json_fields.h>
+#include <cstddef>
+
+using namespace ossrf;
+
+namespace
+{
+    using id_index_t = std::unordered_map<utility::string_t, size_t>;
+
+    void index_ids(const web::json::array& array, id_index_t& index)
+    {
+        index.clear();
+        for(size_t i = 0; i < array.size(); ++i)
+        {
+            if(array.at(i).is_string()) index.emplace(array.at(i).as_string(), i);
+        }
+    }
+
+    void update_ids(web::json::value& ids, id_index_t& index, bool build_index, const std::vector<std::string>& removed,
+                    const std::vector<std::string>& added)
+    {
+        if(!ids.is_array()) ids = web::json::value::array();
+
+        auto& array = ids.as_array();
+        if(build_index) index_ids(array, index);
+
+        for(const auto& id : removed)
+        {
+            const auto it = index.find(utility::s2us(id));
+            if(it == index.end()) continue;
+
+            const auto position = it->second;
+            const auto last     = array.size() - 1;
+            index.erase(it);
+
+            // The last id takes the place of the removed one, so no other id moves.
+            if(position != last)
+            {
+                array.at(position) = array.at(last);
+                if(array.at(position).is_string()) index[array.at(position).as_string()] = position;
+            }
+            array.erase(array.begin() + static_cast<std::ptrdiff_t>(last));
+        }
+
+        // A removal and a re-add in the same batch cancel out, leaving the id listed and only the add pending.
+        for(const auto& id : added)
+        {
+            const auto [it, inserted] = index.emplace(utility::s2us(id), array.size());
+            if(inserted) web::json::push_back(ids, web::json::value::string(it->first));
+        }
+    }
+} // namespace
+
+void ossrf::apply_sub_resources_update(web::json::value& device, const device_sub_resources_update_t& update,
+                                       device_sub_resources_index_t& index)
+{
+    const auto build_index = !index.built;
+    update_ids(device[nmos::fields::senders], index.senders, build_index, update.removed_senders, update.added_senders);
+    update_ids(device[nmos::fields::receivers], index.receivers, build_index, update.removed_receivers,
+               update.added_receivers);
+    index.built = true;
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include "ossrf/nmos/api/nmos.h"
+#include <cpprest/json.h>
+#include <unordered_map>
+
+namespace ossrf
+{
+    // Where each id sits in the "senders" and "receivers" of one device. It is built from the device on first use and
+    // must be reset whenever anything else replaces those lists.
+    struct device_sub_resources_index_t
+    {
+        std::unordered_map<utility::string_t, size_t> senders;
+        std::unordered_map<utility::string_t, size_t> receivers;
+        bool built = false;
+    };
+
+    // Applies `update` to the "senders" and "receivers" of an IS-04 device, at constant cost per id. Removals are
+    // applied first, and an id is only added if the device doesn't list it already, so each id appears at most once.
+    // A removed id is replaced by the last one in its list, so the order of the list is not kept.
+    void apply_sub_resources_update(web::json::value& device, const device_sub_resources_update_t& update,
+                                    device_sub_resources_index_t& index);
+} // namespace ossrf
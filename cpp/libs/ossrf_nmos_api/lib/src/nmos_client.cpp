@@ -23,27 +23,47 @@
 #include "resources/nmos_resource_sender.h"
 #include "bisect/expected/macros.h"
 #include <nlohmann/json.hpp>
+#include <map>
+#include <vector>
+#include <utility>
 
 using namespace bisect;
 using namespace ossrf;
 using json = nlohmann::json;
 
-namespace
-{
-    maybe_ok update_device_sub_resources(nmos_context_ptr context, const std::string& device_id)
-    {
-        const auto senders_ids  = context->resources().get_sender_ids();
-        const auto receiver_ids = context->resources().get_receiver_ids();
-        BST_CHECK(context->nmos().modify_device_sub_resources(utility::s2us(device_id), receiver_ids, senders_ids));
-        return {};
-    }
-} // namespace
-
 struct nmos_client_t::impl
 {
     std::string node_id_;
     nmos_context_ptr context_;
     nmos_event_handler event_handler_;
+    bool batch_open_ = false;
+    // Changes to the sender and receiver lists of each device, pending until the open batch is committed.
+    std::map<std::string, device_sub_resources_update_t> batch_devices_;
+
+    // Adds `id` to, or removes it from, the lists of its device, without touching the device's other ids.
+    maybe_ok device_changed(const std::string& device_id, const nmos::type& type, const std::string& id, bool added)
+    {
+        device_sub_resources_update_t update;
+        auto& pending = batch_open_ ? batch_devices_[device_id] : update;
+
+        const auto is_sender = type == nmos::types::sender;
+        auto& removed_ids    = is_sender ? pending.removed_senders : pending.removed_receivers;
+        auto& added_ids      = is_sender ? pending.added_senders : pending.added_receivers;
+        // A change cancels an opposite one to the same id still pending in the batch.
+        if(added)
+        {
+            std::erase(removed_ids, id);
+            added_ids.push_back(id);
+        }
+        else
+        {
+            std::erase(added_ids, id);
+            removed_ids.push_back(id);
+        }
+
+        if(batch_open_) return {};
+        return context_->nmos().update_device_sub_resources(device_id, update);
+    }
 };
 
 expected<nmos_client_uptr> nmos_client_t::create(const std::string& node_id,
@@ -86,7 +106,7 @@ maybe_ok nmos_client_t::add_receiver(const std::string& device_id, const std::st
     impl_->context_->resources().insert(device_id, std::move(r));
     BST_CHECK(impl_->context_->nmos().add_receiver(device_id, receiver_config));
 
-    BST_CHECK(update_device_sub_resources(impl_->context_, device_id));
+    BST_CHECK(impl_->device_changed(device_id, nmos::types::receiver, receiver_config.id, true));
 
     return {};
 }
@@ -102,7 +122,7 @@ maybe_ok nmos_client_t::add_sender(const std::string& device_id, const std::stri
     impl_->context_->resources().insert(device_id, std::move(s));
     BST_CHECK(impl_->context_->nmos().add_sender(device_id, sender_config));
 
-    BST_CHECK(update_device_sub_resources(impl_->context_, device_id));
+    BST_CHECK(impl_->device_changed(device_id, nmos::types::sender, sender_config.id, true));
 
     return {};
 }
@@ -112,7 +132,7 @@ maybe_ok nmos_client_t::remove_receiver(const std::string& device_id, const std:
     BST_ASSIGN_MUT(receiver_config, nmos_receiver_from_json(json::parse(config)));
 
     BST_CHECK(remove_resource(receiver_config.id, nmos::types::receiver));
-    BST_CHECK(update_device_sub_resources(impl_->context_, device_id));
+    BST_CHECK(impl_->device_changed(device_id, nmos::types::receiver, receiver_config.id, false));
 
     return {};
 }
@@ -124,7 +144,7 @@ maybe_ok nmos_client_t::remove_sender(const std::string& device_id, const std::s
     BST_CHECK(remove_resource(sender_config.id, nmos::types::sender));
     BST_CHECK(remove_resource(sender_config.source.id, nmos::types::source));
     BST_CHECK(remove_resource(sender_config.flow.id, nmos::types::flow));
-    BST_CHECK(update_device_sub_resources(impl_->context_, device_id));
+    BST_CHECK(impl_->device_changed(device_id, nmos::types::sender, sender_config.id, false));
 
     return {};
 }
@@ -136,3 +156,39 @@ maybe_ok nmos_client_t::remove_resource(const std::string& id, const nmos::type&
 
     return {};
 }
+
+maybe_ok nmos_client_t::begin_batch() noexcept
+{
+    BST_CHECK(impl_->context_->nmos().begin_batch());
+    impl_->batch_open_ = true;
+    return {};
+}
+
+maybe_ok nmos_client_t::commit_batch() noexcept
+{
+    BST_ENFORCE(impl_->batch_open_, "No batch is open");
+    impl_->batch_open_ = false;
+    const auto devices = std::exchange(impl_->batch_devices_, {});
+
+    // Left open after a failure, the batch would keep staging every later change without ever applying it.
+    struct abort_guard_t
+    {
+        nmos_t& nmos;
+        bool armed = true;
+        ~abort_guard_t()
+        {
+            if(armed) nmos.abort_batch();
+        }
+    } guard{impl_->context_->nmos()};
+
+    // Staged with the rest of the batch, so each device is updated once.
+    for(const auto& [device_id, update] : devices)
+    {
+        BST_CHECK(impl_->context_->nmos().update_device_sub_resources(device_id, update));
+    }
+
+    // commit_batch closes the batch whether it succeeds or not.
+    guard.armed = false;
+    BST_CHECK(impl_->context_->nmos().commit_batch());
+    return {};
+}
@@ -16,8 +16,14 @@
 #include "bisect/nmoscpp/nmos_controller.h"
 #include "bisect/nmoscpp/logger.h"
 #include "utils.h"
+#include "device_sub_resources.h"
+#include "bisect/nmoscpp/json.h"
 #include <nlohmann/json_fwd.hpp>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 using namespace bisect;
 using namespace bisect::nmoscpp;
@@ -29,6 +35,46 @@ struct nmos_impl::impl
     nmos::id node_id_;
     nmos_controller_uptr controller_;
     logger_t log_;
+    // Set between begin_batch and commit_batch.
+    std::optional<nmos_controller_t::batch_t> batch_;
+    // The sender and receiver ids of each device, kept in step by update_device_sub_resources.
+    std::mutex device_indexes_mutex_;
+    std::unordered_map<nmos::id, device_sub_resources_index_t> device_indexes_;
+
+    maybe_ok insert_resource(nmos::resource&& resource)
+    {
+        if(!batch_.has_value()) return controller_->insert_resource(std::move(resource));
+        batch_->resources.push_back(std::move(resource));
+        return {};
+    }
+
+    maybe_ok insert_connection_resource(nmos::resource&& resource)
+    {
+        if(!batch_.has_value()) return controller_->insert_connection_resource(std::move(resource));
+        batch_->connection_resources.push_back(std::move(resource));
+        return {};
+    }
+
+    maybe_ok modify_resource(const nmos::id& id, std::function<void(nmos::resource&)> modifier)
+    {
+        if(!batch_.has_value()) return controller_->modify_resource(id, std::move(modifier));
+        batch_->modifications.emplace_back(id, std::move(modifier));
+        return {};
+    }
+
+    void update_device_index(const nmos::id& device_id, web::json::value& device,
+                             const device_sub_resources_update_t& update)
+    {
+        std::lock_guard lock(device_indexes_mutex_);
+        apply_sub_resources_update(device, update, device_indexes_[device_id]);
+    }
+
+    // Called whenever a device's lists are replaced wholesale, so that the next update rebuilds its index.
+    void forget_device_index(const nmos::id& device_id)
+    {
+        std::lock_guard lock(device_indexes_mutex_);
+        device_indexes_.erase(device_id);
+    }
 };
 
 nmos_uptr nmos_impl::create(const std::string& node_id)
@@ -75,16 +121,17 @@ maybe_ok nmos_impl::add_device(const nmos_device_t& config) noexcept
     std::vector<std::string> sender_ids;
 
     auto device = impl_->controller_->make_device(config, receiver_ids, sender_ids);
-    return impl_->controller_->insert_resource(std::move(device));
+    impl_->forget_device_index(device.id);
+    return impl_->insert_resource(std::move(device));
 }
 
 maybe_ok nmos_impl::add_receiver(const std::string& device_id, const nmos_receiver_t& config) noexcept
 {
     auto receiver = impl_->controller_->make_receiver(utility::s2us(device_id), config);
-    BST_CHECK(impl_->controller_->insert_resource(std::move(receiver)));
+    BST_CHECK(impl_->insert_resource(std::move(receiver)));
 
     auto connection_receiver = impl_->controller_->make_connection_receiver(utility::s2us(device_id), config);
-    BST_CHECK(impl_->controller_->insert_connection_resource(std::move(connection_receiver)));
+    BST_CHECK(impl_->insert_connection_resource(std::move(connection_receiver)));
 
     return {};
 }
@@ -93,7 +140,7 @@ maybe_ok nmos_impl::add_sender(const std::string& device_id, const nmos_sender_t
 {
 
     BST_ASSIGN_MUT(source, impl_->controller_->make_source(utility::s2us(device_id), config));
-    BST_CHECK(impl_->controller_->insert_resource(std::move(source)));
+    BST_CHECK(impl_->insert_resource(std::move(source)));
 
     if(std::holds_alternative<video_sender_info_t>(config.media))
     {
@@ -101,21 +148,21 @@ maybe_ok nmos_impl::add_sender(const std::string& device_id, const nmos_sender_t
         BST_ASSIGN_MUT(flow,
                        impl_->controller_->make_video_flow(utility::s2us(device_id), utility::s2us(config.source.id),
                                                            config.flow, config.media_type, video));
-        BST_CHECK(impl_->controller_->insert_resource(std::move(flow)));
+        BST_CHECK(impl_->insert_resource(std::move(flow)));
     }
     else if(std::holds_alternative<audio_sender_info_t>(config.media))
     {
         const auto& audio = std::get<audio_sender_info_t>(config.media);
         BST_ASSIGN_MUT(flow, impl_->controller_->make_audio_flow(utility::s2us(device_id),
                                                                  utility::s2us(config.source.id), config.flow, audio));
-        BST_CHECK(impl_->controller_->insert_resource(std::move(flow)));
+        BST_CHECK(impl_->insert_resource(std::move(flow)));
     }
 
     auto sender = impl_->controller_->make_sender(utility::s2us(device_id), config);
-    BST_CHECK(impl_->controller_->insert_resource(std::move(sender)));
+    BST_CHECK(impl_->insert_resource(std::move(sender)));
 
     auto connection_sender = impl_->controller_->make_connection_sender(utility::s2us(device_id), config);
-    BST_CHECK(impl_->controller_->insert_connection_resource(std::move(connection_sender)));
+    BST_CHECK(impl_->insert_connection_resource(std::move(connection_sender)));
 
     return {};
 }
@@ -126,16 +173,18 @@ maybe_ok nmos_impl::modify_device(const nmos_device_t& config) noexcept
     std::vector<std::string> sender_ids;
 
     auto device_resource = impl_->controller_->make_device(config, receiver_ids, sender_ids);
-    return impl_->controller_->modify_resource(utility::s2us(config.id),
-                                               [&](nmos::resource& resource) { resource = device_resource; });
+    return impl_->modify_resource(utility::s2us(config.id),
+                                  [impl = impl_.get(), device_resource](nmos::resource& resource) {
+                                      resource = device_resource;
+                                      impl->forget_device_index(resource.id);
+                                  });
 }
 
-maybe_ok nmos_impl::modify_device_sub_resources(const std::string& device_id, const std::vector<std::string>& receivers,
-                                                const std::vector<std::string>& senders) noexcept
+maybe_ok nmos_impl::update_device_sub_resources(const std::string& device_id,
+                                                const device_sub_resources_update_t& update) noexcept
 {
-    return impl_->controller_->modify_resource(device_id, [&](nmos::resource& resource) {
-        resource.data[nmos::fields::receivers] = web::json::value_from_elements(receivers);
-        resource.data[nmos::fields::senders]   = web::json::value_from_elements(senders);
+    return impl_->modify_resource(device_id, [impl = impl_.get(), update](nmos::resource& resource) {
+        impl->update_device_index(resource.id, resource.data, update);
     });
 }
 
@@ -192,6 +241,7 @@ maybe_ok nmos_impl::remove_resource(const std::string& resource_id, const nmos::
 
     if(type == nmos::types::device)
     {
+        impl_->forget_device_index(utility::s2us(resource_id));
         return impl_->controller_->erase_device(utility::s2us(resource_id));
     }
 
@@ -209,7 +259,7 @@ maybe_ok nmos_impl::update_clocks(const std::string& clocks) noexcept
     auto j_clocks = json::parse(clocks);
 
     impl_->controller_->modify_resource(impl_->node_id_, [&](nmos::resource& resource) {
-        resource.data[utility::conversions::to_string_t("clocks")] = web::json::value::parse(j_clocks.dump());
+        resource.data[utility::conversions::to_string_t("clocks")] = to_web_json(j_clocks);
     });
 
     BST_CHECK(impl_->controller_->call_senders_with(impl_->node_id_, [&](nmos::resource& resource) -> maybe_ok {
@@ -218,3 +268,23 @@ maybe_ok nmos_impl::update_clocks(const std::string& clocks) noexcept
 
     return {};
 }
+
+maybe_ok nmos_impl::begin_batch() noexcept
+{
+    BST_ENFORCE(!impl_->batch_.has_value(), "A batch is already open");
+    impl_->batch_.emplace();
+    return {};
+}
+
+maybe_ok nmos_impl::commit_batch() noexcept
+{
+    BST_ENFORCE(impl_->batch_.has_value(), "No batch is open");
+    auto batch = std::move(*impl_->batch_);
+    impl_->batch_.reset();
+    return impl_->controller_->commit(std::move(batch));
+}
+
+void nmos_impl::abort_batch() noexcept
+{
+    impl_->batch_.reset();
+}
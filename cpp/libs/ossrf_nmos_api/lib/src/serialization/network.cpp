@@ -24,7 +24,7 @@ using json = nlohmann::json;
 expected<network_t> ossrf::network_from_json(const json& config, bool is_receiver)
 {
     network_t net;
-    BST_ASSIGN(primary, find<json>(config, "primary"));
+    BST_ASSIGN(primary, find<json_ref>(config, "primary"));
     BST_CHECK_ASSIGN(net.primary, network_leg_from_json(primary, is_receiver));
 
     auto secondary = config.find("secondary");
@@ -29,10 +29,10 @@ namespace
 {
     maybe_ok format_specific(const json& config, nmos_receiver_t& receiver)
     {
-        BST_ASSIGN(capabilities, find<json>(config, "capabilities"));
+        BST_ASSIGN(capabilities, find<json_ref>(config, "capabilities"));
 
-        BST_ENFORCE(capabilities.is_array(), "Receiver capabilities is not an array");
-        auto c = capabilities.get<std::vector<std::string>>();
+        BST_ENFORCE(capabilities.get().is_array(), "Receiver capabilities is not an array");
+        auto c = capabilities.get().get<std::vector<std::string>>();
         BST_ENFORCE(c.size() == 1, "Only support one receiver capabilitiy");
 
         auto media_type = c[0];
@@ -78,7 +78,7 @@ expected<nmos_receiver_t> ossrf::nmos_receiver_from_json(const json& config)
     assign_if_or_value<std::string>(config, "protocol", receiver, &nmos_receiver_t::protocol,
                                     "urn:x-nmos:transport:rtp.mcast");
 
-    BST_ASSIGN(network, find<json>(config, "network"));
+    BST_ASSIGN(network, find<json_ref>(config, "network"));
     BST_CHECK_ASSIGN(receiver.network, network_from_json(network, true));
     BST_CHECK(format_specific(config, receiver));
 
@@ -19,6 +19,7 @@
 #include "serialization/media_types.h"
 #include "utils.h"
 #include "bisect/expected/macros.h"
+#include "bisect/nmoscpp/json.h"
 #include "bisect/sdp/builder.h"
 #include <nmos/id.h>
 
@@ -43,7 +44,7 @@ namespace
     expected<video_sender_info_t> video_sender_info_from_json(const json& media)
     {
         video_sender_info_t info;
-        BST_ASSIGN(frame_rate, find<json>(media, "frame_rate"));
+        BST_ASSIGN(frame_rate, find<json_ref>(media, "frame_rate"));
         BST_CHECK_ASSIGN(info.exact_framerate, framerate_from_json(frame_rate));
         BST_CHECK_ASSIGN(info.chroma_sub_sampling, find<std::string>(media, "sampling"));
         BST_CHECK_ASSIGN(info.width, find<int>(media, "width"));
@@ -89,7 +90,7 @@ namespace
         const auto it = j.find(name);
         if(it != j.end())
         {
-            target = web::json::value::parse(utility::s2us(it->dump()));
+            target = to_web_json(*it);
         }
     }
 
@@ -108,7 +109,7 @@ expected<nmos_sender_t> ossrf::nmos_sender_from_json(const json& config)
 
     assign_if_or_value<bool>(config, "master_enable", sender, &nmos_sender_t::master_enable, true);
 
-    BST_ASSIGN(network, find<json>(config, "network"));
+    BST_ASSIGN(network, find<json_ref>(config, "network"));
     BST_CHECK_ASSIGN(sender.network, network_from_json(network, false));
     BST_CHECK_ASSIGN(sender.media_type, find<std::string>(config, "media_type"));
     sender.source.id          = source_id;
@@ -119,7 +120,7 @@ expected<nmos_sender_t> ossrf::nmos_sender_from_json(const json& config)
     sender.flow.description   = sender.description;
     BST_CHECK_ASSIGN(sender.payload_type, maybe_find<uint8_t>(config, "payload_type"));
 
-    BST_ASSIGN(media, find<json>(config, "media"));
+    BST_ASSIGN(media, find<json_ref>(config, "media"));
 
     if(sender.media_type == media_types::VIDEO_RAW)
     {
@@ -0,0 +1,170 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "context/resource_map.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ossrf;
+
+namespace
+{
+    class fake_resource_t : public nmos_resource_t
+    {
+      public:
+        fake_resource_t(std::string id, std::string device_id, nmos::type type)
+            : id_(std::move(id)), device_id_(std::move(device_id)), type_(std::move(type))
+        {
+        }
+
+        bisect::maybe_ok handle_patch(bool, const nlohmann::json&) override { return {}; }
+        bisect::maybe_ok handle_activation(bool, nlohmann::json&) override { return {}; }
+        bisect::expected<bisect::nmoscpp::sdp_info_t> handle_sdp_info_request() override
+        {
+            return bisect::nmoscpp::sdp_info_t{};
+        }
+
+        const std::string& get_id() const override { return id_; }
+        const std::string& get_device_id() const override { return device_id_; }
+        nmos::type get_resource_type() const override { return type_; }
+
+      private:
+        std::string id_;
+        std::string device_id_;
+        nmos::type type_;
+    };
+
+    void insert(resource_map_t& map, const std::string& device_id, const std::string& id, const nmos::type& type)
+    {
+        map.insert(device_id, std::make_shared<fake_resource_t>(id, device_id, type));
+    }
+
+    std::vector<std::string> sorted(std::vector<std::string> ids)
+    {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+} // namespace
+
+TEST(ossrf_nmos_api, resource_map_find_and_erase)
+{
+    resource_map_t map;
+    insert(map, "device-a", "sender-1", nmos::types::sender);
+    insert(map, "device-a", "receiver-1", nmos::types::receiver);
+    insert(map, "device-b", "sender-2", nmos::types::sender);
+
+    ASSERT_EQ(map.find_resource("receiver-1").value()->get_id(), "receiver-1");
+    ASSERT_FALSE(map.find_resource("unknown").has_value());
+    ASSERT_EQ(sorted(map.get_sender_ids()), (std::vector<std::string>{"sender-1", "sender-2"}));
+    ASSERT_EQ(map.get_receiver_ids(), std::vector<std::string>{"receiver-1"});
+
+    map.erase("sender-1");
+    ASSERT_FALSE(map.find_resource("sender-1").has_value());
+    ASSERT_EQ(map.get_sender_ids(), std::vector<std::string>{"sender-2"});
+
+    // Erasing a device erases its resources.
+    map.erase("device-a");
+    ASSERT_FALSE(map.find_resource("receiver-1").has_value());
+    ASSERT_TRUE(map.get_receiver_ids().empty());
+    ASSERT_TRUE(map.find_resource("sender-2").has_value());
+}
+
+TEST(ossrf_nmos_api, resource_map_insert_replaces_same_id)
+{
+    resource_map_t map;
+    insert(map, "device-a", "sender-1", nmos::types::sender);
+    insert(map, "device-b", "sender-1", nmos::types::sender);
+
+    ASSERT_EQ(map.get_sender_ids(), std::vector<std::string>{"sender-1"});
+    ASSERT_EQ(map.find_resource("sender-1").value()->get_device_id(), "device-b");
+
+    // The resource moved to device-b, so device-a no longer owns it.
+    map.erase("device-a");
+    ASSERT_TRUE(map.find_resource("sender-1").has_value());
+}
+
+TEST(ossrf_nmos_api, resource_map_finds_every_resource_of_a_large_map)
+{
+    // Senders and receivers spread over 10 devices.
+    constexpr size_t count = 10000;
+    resource_map_t map;
+    for(size_t i = 0; i < count; ++i)
+    {
+        insert(map, "device-" + std::to_string(i % 10), "resource-" + std::to_string(i),
+               i % 2 == 0 ? nmos::types::sender : nmos::types::receiver);
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto id       = "resource-" + std::to_string(i);
+        const auto resource = map.find_resource(id);
+        ASSERT_TRUE(resource.has_value());
+        ASSERT_EQ(resource.value()->get_id(), id);
+        ASSERT_EQ(resource.value()->get_device_id(), "device-" + std::to_string(i % 10));
+    }
+    ASSERT_EQ(map.get_sender_ids().size(), count / 2);
+    ASSERT_EQ(map.get_receiver_ids().size(), count / 2);
+}
+
+TEST(ossrf_nmos_api, resource_map_concurrent_activations)
+{
+    // Activation lookups from several HTTP threads while resources are being added and removed.
+    constexpr size_t receivers         = 1000;
+    constexpr size_t threads           = 4;
+    constexpr size_t lookups_by_thread = 20000;
+
+    resource_map_t map;
+    std::vector<std::string> ids;
+    for(size_t i = 0; i < receivers; ++i)
+    {
+        ids.push_back("receiver-" + std::to_string(i));
+        insert(map, "device-a", ids.back(), nmos::types::receiver);
+    }
+
+    std::atomic<bool> done = false;
+    std::thread writer([&]() {
+        for(size_t i = 0; !done; ++i)
+        {
+            const auto id = "sender-" + std::to_string(i % 100);
+            insert(map, "device-b", id, nmos::types::sender);
+            map.erase(id);
+        }
+    });
+
+    std::atomic<size_t> found = 0;
+    std::vector<std::thread> readers;
+    for(size_t t = 0; t < threads; ++t)
+    {
+        readers.emplace_back([&, t]() {
+            size_t n = 0;
+            for(size_t i = 0; i < lookups_by_thread; ++i)
+            {
+                if(map.find_resource(ids[(i * 31 + t) % receivers]).has_value()) ++n;
+            }
+            found += n;
+        });
+    }
+    for(auto& reader : readers)
+    {
+        reader.join();
+    }
+    done = true;
+    writer.join();
+
+    ASSERT_EQ(found, threads * lookups_by_thread);
+}
@@ -0,0 +1,93 @@
+// Copyright (C) 2024 Advanced Media Workflow Association
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "device_sub_resources.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace ossrf;
+
+namespace
+{
+    std::vector<std::string> ids(const web::json::value& device, const char* field)
+    {
+        std::vector<std::string> result;
+        for(const auto& id : device.at(utility::s2us(field)).as_array())
+        {
+            result.push_back(utility::us2s(id.as_string()));
+        }
+        return result;
+    }
+} // namespace
+
+TEST(ossrf_nmos_api, device_sub_resources_add_and_remove)
+{
+    auto device = web::json::value::object();
+    device_sub_resources_index_t index;
+
+    device_sub_resources_update_t add;
+    add.added_senders   = {"sender-1", "sender-2"};
+    add.added_receivers = {"receiver-1"};
+    apply_sub_resources_update(device, add, index);
+    ASSERT_EQ(ids(device, "senders"), (std::vector<std::string>{"sender-1", "sender-2"}));
+    ASSERT_EQ(ids(device, "receivers"), std::vector<std::string>{"receiver-1"});
+
+    device_sub_resources_update_t remove;
+    remove.removed_senders   = {"sender-1"};
+    remove.removed_receivers = {"receiver-1"};
+    apply_sub_resources_update(device, remove, index);
+    ASSERT_EQ(ids(device, "senders"), std::vector<std::string>{"sender-2"});
+    ASSERT_TRUE(ids(device, "receivers").empty());
+}
+
+TEST(ossrf_nmos_api, device_sub_resources_remove_and_re_add_in_a_batch)
+{
+    device_sub_resources_update_t add;
+    add.added_senders   = {"sender-1"};
+    add.added_receivers = {"receiver-1"};
+
+    auto device = web::json::value::object();
+    device_sub_resources_index_t index;
+    apply_sub_resources_update(device, add, index);
+
+    // nmos_client_t cancels a removal with the re-add that follows it in the same batch, leaving only the add.
+    apply_sub_resources_update(device, add, index);
+    ASSERT_EQ(ids(device, "senders"), std::vector<std::string>{"sender-1"});
+    ASSERT_EQ(ids(device, "receivers"), std::vector<std::string>{"receiver-1"});
+}
+
+TEST(ossrf_nmos_api, device_sub_resources_index_follows_removals)
+{
+    auto device   = web::json::value::object();
+    auto& senders = device[utility::s2us("senders")];
+    senders       = web::json::value::array();
+    for(const auto* id : {"sender-1", "sender-2", "sender-3"})
+    {
+        web::json::push_back(senders, web::json::value::string(utility::s2us(id)));
+    }
+    device_sub_resources_index_t index;
+
+    // The index is built from the ids the device already lists, and the last id fills the removed one's place.
+    device_sub_resources_update_t remove;
+    remove.removed_senders = {"sender-1"};
+    apply_sub_resources_update(device, remove, index);
+    ASSERT_EQ(ids(device, "senders"), (std::vector<std::string>{"sender-3", "sender-2"}));
+
+    device_sub_resources_update_t update;
+    update.removed_senders = {"sender-3"};
+    update.added_senders   = {"sender-2", "sender-4"};
+    apply_sub_resources_update(device, update, index);
+    ASSERT_EQ(ids(device, "senders"), (std::vector<std::string>{"sender-2", "sender-4"}));
+}